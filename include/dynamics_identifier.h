@@ -0,0 +1,619 @@
+/**
+* @file     dynamics_identifier.h
+* @brief    ロボットの動特性（速度指令→オドメトリ速度の応答）の計測・推定クラスの定義ヘッダファイル
+* @author   S.Kumada
+* @date     2026/10/18
+* @note     並進・旋回それぞれにステップ指令（正負の往復）とチャープ指令を順に与え、応答を確保済みの領域に記録する。
+*           記録からむだ時間・時定数・定常ゲイン・最大加速度を推定し、制御パラメータのYAMLを作成する。
+*           ROSに依存しないため、運動学モデルを相手にした動作確認（dynamics_characterization_sim）にも用いる
+*/
+
+#ifndef DYNAMICS_IDENTIFIER_H
+#define DYNAMICS_IDENTIFIER_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// 軸
+#define DYNAMICS_AXIS_LINEAR        0   // 並進
+#define DYNAMICS_AXIS_ANGULAR       1   // 旋回
+// 指令の区間の種類
+#define DYNAMICS_SEGMENT_REST       0   // 停止
+#define DYNAMICS_SEGMENT_STEP       1   // ステップ
+#define DYNAMICS_SEGMENT_CHIRP      2   // チャープ（周波数を線形に上げる正弦波）
+
+#define DYNAMICS_MAX_SAMPLES        30000   // 記録するサンプル数の上限（100Hzで300秒分）
+#define DYNAMICS_STEADY_RATIO       0.3     // ステップ区間の末尾のうち定常値の算出に用いる割合
+#define DYNAMICS_ACCEL_WINDOW       0.2     // 加速度の算出に用いる時間幅[s]（幅内の最小二乗の傾きとする）
+#define DYNAMICS_MAX_LAG            1.0     // チャープの追従遅れの探索範囲[s]
+#define DYNAMICS_LAG_STEP           0.005   // チャープの追従遅れの探索刻み[s]
+#define DYNAMICS_FIT_MAX_TAU        1.0     // ステップ応答の当てはめの時定数の探索範囲[s]
+#define DYNAMICS_FIT_COARSE_STEP    0.01    // ステップ応答の当てはめの粗い探索刻み[s]
+#define DYNAMICS_FIT_FINE_STEP      0.001   // ステップ応答の当てはめの細かい探索刻み[s]（粗い探索の最良点の前後）
+
+#ifndef M_PI
+#define M_PI 3.14159265358979
+#endif
+
+typedef struct DynamicsConfig
+{
+    std::vector<double> linear_levels;  // 並進のステップ指令の大きさ[m/s]（正負の往復で与える）
+    std::vector<double> angular_levels; // 旋回のステップ指令の大きさ[rad/s]（正負の往復で与える）
+    double step_time;                   // ステップ指令の時間[s]
+    double rest_time;                   // 指令間の停止時間[s]
+    double chirp_time;                  // チャープ指令の時間[s]
+    double chirp_start_freq;            // チャープ指令の開始周波数[Hz]
+    double chirp_end_freq;              // チャープ指令の終了周波数[Hz]
+    double linear_chirp_amplitude;      // 並進のチャープ指令の振幅[m/s]
+    double angular_chirp_amplitude;     // 旋回のチャープ指令の振幅[rad/s]
+    double gain_tolerance;              // 指令に追従できたとみなす定常ゲインの誤差（全ステップの中央値に対する比）
+    double accel_margin;                // 制御パラメータに用いる加速度の割合（計測した最大加速度に対する）
+
+    DynamicsConfig()
+        : step_time(2.0)
+        , rest_time(1.0)
+        , chirp_time(10.0)
+        , chirp_start_freq(0.1)
+        , chirp_end_freq(1.5)
+        , linear_chirp_amplitude(0.1)
+        , angular_chirp_amplitude(0.4)
+        , gain_tolerance(0.1)
+        , accel_margin(0.8)
+    {
+        const double linear[]  = {0.1, 0.2, 0.3};
+        const double angular[] = {0.2, 0.4, 0.6, 0.8};
+        linear_levels.assign(linear, linear + sizeof(linear) / sizeof(linear[0]));
+        angular_levels.assign(angular, angular + sizeof(angular) / sizeof(angular[0]));
+    }
+
+}stDynamicsConfig;
+
+// 指令の区間
+typedef struct DynamicsSegment
+{
+    int axis;           // 軸（DYNAMICS_AXIS_*）
+    int type;           // 種類（DYNAMICS_SEGMENT_*）
+    double level;       // ステップの大きさ・チャープの振幅
+    double duration;    // 区間の時間[s]
+
+}stDynamicsSegment;
+
+// 記録1サンプル
+typedef struct DynamicsSample
+{
+    double time;        // 区間の開始からの時間[s]
+    int segment;        // 区間の番号
+    double command;     // 区間の軸の速度指令
+    double response;    // 区間の軸のオドメトリ速度
+
+}stDynamicsSample;
+
+// 1軸の推定結果
+typedef struct DynamicsEstimate
+{
+    bool valid;             // 推定できたか
+    int steps;              // 推定に用いたステップ区間の数
+    double latency;         // むだ時間[s]
+    double time_constant;   // 時定数[s]
+    double gain;            // 定常ゲイン（応答/指令）
+    double max_accel;       // 最大加速度[/s]
+    double tracking_lag;    // チャープ指令への追従遅れ[s]
+    double max_tracked;     // 定常ゲインが許容範囲内だった最大のステップ指令
+
+    DynamicsEstimate()
+        : valid(false)
+        , steps(0)
+        , latency(0.0)
+        , time_constant(0.0)
+        , gain(0.0)
+        , max_accel(0.0)
+        , tracking_lag(0.0)
+        , max_tracked(0.0) {}
+
+}stDynamicsEstimate;
+
+/**
+ * @brief 動特性の計測・推定クラス
+ * @details configure()で指令の台本（区間の並び）を作り、応答を受け取る毎にupdate()を呼び出して次の指令を得る。
+ *          記録はconfigure()で確保した領域に行い、計測中はメモリ確保を行わない（上限を超えた分は捨てて数える）。
+ *          推定はステップ区間の応答を「むだ時間＋加速度制限付きの一次遅れ」とみなし、計測した最大加速度を与えて
+ *          むだ時間と時定数を最小二乗で当てはめる（加速度制限で頭打ちになる立ち上がりを時定数に含めない）
+ */
+class DynamicsIdentifier
+{
+private:
+    stDynamicsConfig _config;                   // 計測パラメータ
+    std::vector<stDynamicsSegment> _segments;   // 指令の台本
+    std::vector<stDynamicsSample> _samples;     // 記録
+    size_t _dropped;                            // 上限を超えて捨てたサンプル数
+    int _segment;                               // 実行中の区間
+    double _segment_start;                      // 実行中の区間の開始時刻[s]
+    bool _started;                              // 開始時刻を設定済みか
+
+public:
+    /**
+    * @brief        DynamicsIdentifierクラスのコンストラクタ
+    */
+    DynamicsIdentifier()
+        : _dropped(0)
+        , _segment(0)
+        , _segment_start(0.0)
+        , _started(false) {}
+
+    /**
+    * @brief        計測パラメータの設定と指令の台本の作成
+    * @param[in]    const stDynamicsConfig& config 計測パラメータ
+    * @return       void
+    */
+    void configure(const stDynamicsConfig& config)
+    {
+        _config = config;
+        _segments.clear();
+        addAxis(DYNAMICS_AXIS_LINEAR,  _config.linear_levels,  _config.linear_chirp_amplitude);
+        addAxis(DYNAMICS_AXIS_ANGULAR, _config.angular_levels, _config.angular_chirp_amplitude);
+
+        _samples.clear();
+        _samples.reserve(DYNAMICS_MAX_SAMPLES);
+        reset();
+    }
+
+    /**
+    * @brief        計測のやり直し（記録を破棄し、台本の先頭から始める）
+    * @return       void
+    */
+    void reset()
+    {
+        _samples.clear();
+        _dropped = 0;
+        _segment = 0;
+        _segment_start = 0.0;
+        _started = false;
+    }
+
+    /**
+    * @brief        応答の記録と次の指令の取得
+    * @param[in]    double now 現在時刻[s]（オドメトリの計測時刻）
+    * @param[in]    double linear 並進速度[m/s]（オドメトリ）
+    * @param[in]    double angular 旋回速度[rad/s]（オドメトリ）
+    * @param[out]   double& linear_cmd 並進速度指令[m/s]
+    * @param[out]   double& angular_cmd 旋回速度指令[rad/s]
+    * @return       bool true:計測中, false:台本を終えた（指令は0）
+    */
+    bool update(double now, double linear, double angular, double& linear_cmd, double& angular_cmd)
+    {
+        linear_cmd = angular_cmd = 0.0;
+        if(!_started)
+        {
+            _segment_start = now;
+            _started = true;
+        }
+        while(_segment < (int)_segments.size() && now - _segment_start >= _segments[_segment].duration)
+        {
+            _segment_start += _segments[_segment].duration;
+            _segment++;
+        }
+        if(isFinished())
+        {
+            return false;
+        }
+
+        const stDynamicsSegment& segment = _segments[_segment];
+        double elapsed = now - _segment_start;
+        double command = commandAt(segment, elapsed);
+
+        if(_samples.size() < _samples.capacity())
+        {
+            stDynamicsSample sample;
+            sample.time     = elapsed;
+            sample.segment  = _segment;
+            sample.command  = command;
+            sample.response = (segment.axis == DYNAMICS_AXIS_LINEAR) ? linear : angular;
+            _samples.push_back(sample);
+        }
+        else
+        {
+            _dropped++;
+        }
+
+        if(segment.axis == DYNAMICS_AXIS_LINEAR)
+        {
+            linear_cmd = command;
+        }
+        else
+        {
+            angular_cmd = command;
+        }
+        return true;
+    }
+
+    bool isFinished() const { return _segment >= (int)_segments.size(); }
+    size_t samples() const { return _samples.size(); }
+    size_t dropped() const { return _dropped; }
+    const stDynamicsConfig& config() const { return _config; }
+
+    /**
+    * @brief        台本の全体の時間
+    * @return       double 時間[s]
+    */
+    double duration() const
+    {
+        double total = 0.0;
+        for(size_t i = 0; i < _segments.size(); i++)
+        {
+            total += _segments[i].duration;
+        }
+        return total;
+    }
+
+    /**
+    * @brief        1軸の動特性の推定
+    * @param[in]    int axis 軸（DYNAMICS_AXIS_*）
+    * @return       stDynamicsEstimate 推定結果
+    */
+    stDynamicsEstimate estimate(int axis) const
+    {
+        stDynamicsEstimate result;
+        std::vector<double> gains, levels;
+        double latency_sum = 0.0, tau_sum = 0.0;
+        int rise_count = 0;
+
+        // 最大加速度（ステップ応答の当てはめの加速度制限に用いるため先に求める）
+        for(int s = 0; s < (int)_segments.size(); s++)
+        {
+            size_t begin, end;
+            if(_segments[s].axis == axis && segmentRange(s, begin, end))
+            {
+                result.max_accel = std::max(result.max_accel, maxSlope(begin, end));
+            }
+        }
+
+        for(int s = 0; s < (int)_segments.size(); s++)
+        {
+            const stDynamicsSegment& segment = _segments[s];
+            if(segment.axis != axis)
+            {
+                continue;
+            }
+            size_t begin, end;
+            if(!segmentRange(s, begin, end))
+            {
+                continue;
+            }
+
+            if(segment.type == DYNAMICS_SEGMENT_CHIRP)
+            {
+                result.tracking_lag = chirpLag(segment, begin, end);
+                continue;
+            }
+            if(segment.type != DYNAMICS_SEGMENT_STEP)
+            {
+                continue;
+            }
+
+            // 定常値とゲイン（区間の末尾の平均）
+            double steady = 0.0;
+            int steady_count = 0;
+            double steady_from = segment.duration * (1.0 - DYNAMICS_STEADY_RATIO);
+            for(size_t i = begin; i < end; i++)
+            {
+                if(_samples[i].time >= steady_from)
+                {
+                    steady += _samples[i].response;
+                    steady_count++;
+                }
+            }
+            if(steady_count == 0)
+            {
+                continue;
+            }
+            steady /= steady_count;
+            gains.push_back(steady / segment.level);
+            levels.push_back(std::fabs(segment.level));
+
+            // むだ時間と時定数（加速度制限付きの一次遅れ＋むだ時間の当てはめ）
+            double latency, tau;
+            if(fitStep(begin, end, steady, result.max_accel, latency, tau))
+            {
+                latency_sum += latency;
+                tau_sum += tau;
+                rise_count++;
+            }
+        }
+
+        result.steps = (int)gains.size();
+        if(result.steps > 0 && rise_count > 0)
+        {
+            // 定常ゲインは速度の飽和したステップの影響を受けないよう中央値とし、
+            // 中央値から許容範囲内のステップを指令に追従できたとみなす
+            std::vector<double> sorted(gains);
+            std::sort(sorted.begin(), sorted.end());
+            result.gain = sorted[sorted.size() / 2];
+            if(sorted.size() % 2 == 0)
+            {
+                result.gain = 0.5 * (result.gain + sorted[sorted.size() / 2 - 1]);
+            }
+            for(size_t i = 0; i < gains.size(); i++)
+            {
+                if(result.gain != 0 && std::fabs(gains[i] / result.gain - 1.0) <= _config.gain_tolerance)
+                {
+                    result.max_tracked = std::max(result.max_tracked, levels[i]);
+                }
+            }
+            result.valid         = true;
+            result.latency       = latency_sum / rise_count;
+            result.time_constant = tau_sum / rise_count;
+        }
+        return result;
+    }
+
+    /**
+    * @brief        推定結果と制御パラメータのYAMLの作成
+    * @param[in]    const std::string& name ロボットの識別子（コメントに記載）
+    * @param[in]    const stDynamicsEstimate& linear 並進の推定結果
+    * @param[in]    const stDynamicsEstimate& angular 旋回の推定結果
+    * @return       std::string YAML
+    * @details      制御パラメータは推定できた軸のみ出力する。速度は定常ゲインが許容範囲内だった最大の指令、
+    *               加速度は計測した最大加速度に余裕率を掛けたものとする
+    */
+    std::string toYaml(const std::string& name, const stDynamicsEstimate& linear, const stDynamicsEstimate& angular) const
+    {
+        std::string yaml = "# ロボットの動特性の計測結果（" + name + "、characterize_dynamicsにより自動作成）\n";
+        yaml += "# 個別パラメータのYAMLの後に読み込むと、以下の制御パラメータを上書きする\n";
+        yaml += estimateYaml("linear", linear);
+        yaml += estimateYaml("angular", angular);
+
+        if(linear.valid && linear.max_tracked > 0)
+        {
+            yaml += "\n# 並進（RobotDriverの速度プロファイル・経路追従）\n";
+            yaml += line("driver_max_velocity", linear.max_tracked);
+            yaml += line("driver_max_accel", linear.max_accel * _config.accel_margin);
+            yaml += line("follower_desired_linear_vel", linear.max_tracked);
+        }
+        if(angular.valid && angular.max_tracked > 0)
+        {
+            yaml += "\n# 旋回（目的地・初期位置推定の旋回）\n";
+            yaml += line("navigation_turn_speed", angular.max_tracked);
+            yaml += line("initial_turn_speed", angular.max_tracked);
+            yaml += line("turn_max_angular_accel", angular.max_accel * _config.accel_margin);
+        }
+        return yaml;
+    }
+
+private:
+    /**
+    * @brief        1軸分の台本の追加（ステップの正負の往復の後にチャープ）
+    */
+    void addAxis(int axis, const std::vector<double>& levels, double chirp_amplitude)
+    {
+        for(size_t i = 0; i < levels.size(); i++)
+        {
+            if(levels[i] == 0)
+            {
+                continue;
+            }
+            addSegment(axis, DYNAMICS_SEGMENT_STEP,  std::fabs(levels[i]),  _config.step_time);
+            addSegment(axis, DYNAMICS_SEGMENT_REST,  0.0,                   _config.rest_time);
+            addSegment(axis, DYNAMICS_SEGMENT_STEP,  -std::fabs(levels[i]), _config.step_time);
+            addSegment(axis, DYNAMICS_SEGMENT_REST,  0.0,                   _config.rest_time);
+        }
+        if(chirp_amplitude > 0 && _config.chirp_time > 0)
+        {
+            addSegment(axis, DYNAMICS_SEGMENT_CHIRP, chirp_amplitude, _config.chirp_time);
+            addSegment(axis, DYNAMICS_SEGMENT_REST,  0.0,             _config.rest_time);
+        }
+    }
+
+    void addSegment(int axis, int type, double level, double duration)
+    {
+        stDynamicsSegment segment;
+        segment.axis     = axis;
+        segment.type     = type;
+        segment.level    = level;
+        segment.duration = duration;
+        _segments.push_back(segment);
+    }
+
+    /**
+    * @brief        区間内の指令
+    */
+    double commandAt(const stDynamicsSegment& segment, double elapsed) const
+    {
+        switch(segment.type)
+        {
+            case DYNAMICS_SEGMENT_STEP:
+                return segment.level;
+            case DYNAMICS_SEGMENT_CHIRP:
+            {
+                if(elapsed < 0)
+                {
+                    return 0.0;
+                }
+                double rate = (_config.chirp_end_freq - _config.chirp_start_freq) / segment.duration;
+                double phase = 2.0 * M_PI * (_config.chirp_start_freq * elapsed + 0.5 * rate * elapsed * elapsed);
+                return segment.level * std::sin(phase);
+            }
+            default:
+                return 0.0;
+        }
+    }
+
+    /**
+    * @brief        区間の記録の範囲
+    */
+    bool segmentRange(int segment, size_t& begin, size_t& end) const
+    {
+        begin = 0;
+        while(begin < _samples.size() && _samples[begin].segment < segment)
+        {
+            begin++;
+        }
+        end = begin;
+        while(end < _samples.size() && _samples[end].segment == segment)
+        {
+            end++;
+        }
+        return (end - begin) >= 2;
+    }
+
+    /**
+    * @brief        ステップ応答へのむだ時間・時定数の当てはめ
+    * @param[in]    size_t begin, end 区間の記録の範囲
+    * @param[in]    double steady 定常値
+    * @param[in]    double max_accel 加速度制限（0以下は制限なし）
+    * @param[out]   double& latency むだ時間[s]（区間の最初の指令からの時間）
+    * @param[out]   double& tau 時定数[s]
+    * @return       bool true:当てはめ成功, false:応答が変化していない
+    * @details      粗い刻みで全範囲を探索した後、最良点の前後を細かい刻みで探索する
+    */
+    bool fitStep(size_t begin, size_t end, double steady, double max_accel, double& latency, double& tau) const
+    {
+        double initial = _samples[begin].response;
+        if(std::fabs(steady - initial) < 1e-6 || end - begin < 3)
+        {
+            return false;
+        }
+
+        double best_error = 1e300;
+        latency = tau = 0.0;
+        for(double l = 0.0; l <= DYNAMICS_MAX_LAG; l += DYNAMICS_FIT_COARSE_STEP)
+        {
+            for(double t = DYNAMICS_FIT_COARSE_STEP; t <= DYNAMICS_FIT_MAX_TAU; t += DYNAMICS_FIT_COARSE_STEP)
+            {
+                double error = stepError(begin, end, initial, steady, max_accel, l, t, best_error);
+                if(error < best_error)
+                {
+                    best_error = error;
+                    latency = l;
+                    tau = t;
+                }
+            }
+        }
+        double coarse_latency = latency, coarse_tau = tau;
+        for(double l = std::max(0.0, coarse_latency - DYNAMICS_FIT_COARSE_STEP); l <= coarse_latency + DYNAMICS_FIT_COARSE_STEP; l += DYNAMICS_FIT_FINE_STEP)
+        {
+            for(double t = std::max(DYNAMICS_FIT_FINE_STEP, coarse_tau - DYNAMICS_FIT_COARSE_STEP); t <= coarse_tau + DYNAMICS_FIT_COARSE_STEP; t += DYNAMICS_FIT_FINE_STEP)
+            {
+                double error = stepError(begin, end, initial, steady, max_accel, l, t, best_error);
+                if(error < best_error)
+                {
+                    best_error = error;
+                    latency = l;
+                    tau = t;
+                }
+            }
+        }
+        return true;
+    }
+
+    /**
+    * @brief        むだ時間・時定数を与えたステップ応答のモデルと記録の二乗誤差
+    * @details      最初の指令からむだ時間後に目標が定常値に切り替わり、周期毎に一次遅れの厳密解で進めて
+    *               変化量を加速度制限で抑える。途中でlimitを超えた時点で打ち切る
+    */
+    double stepError(size_t begin, size_t end, double initial, double steady, double max_accel,
+                     double latency, double tau, double limit) const
+    {
+        double start = _samples[begin].time + latency;
+        double model = initial;
+        double error = 0.0;
+        for(size_t i = begin + 1; i < end && error < limit; i++)
+        {
+            double from = std::max(_samples[i - 1].time, start);
+            double dt = _samples[i].time - from;
+            if(dt > 0)
+            {
+                double change = (steady - model) * (1.0 - std::exp(-dt / tau));
+                if(max_accel > 0)
+                {
+                    change = std::max(-max_accel * dt, std::min(max_accel * dt, change));
+                }
+                model += change;
+            }
+            double diff = _samples[i].response - model;
+            error += diff * diff;
+        }
+        return error;
+    }
+
+    /**
+    * @brief        区間内の応答の変化率の最大値（一定の時間幅の最小二乗の傾きとし、ノイズの影響を抑える）
+    */
+    double maxSlope(size_t begin, size_t end) const
+    {
+        double max_slope = 0.0;
+        size_t j = begin;
+        for(size_t i = begin; i < end; i++)
+        {
+            while(j < end && _samples[j].time - _samples[i].time < DYNAMICS_ACCEL_WINDOW)
+            {
+                j++;
+            }
+            if(j >= end)
+            {
+                break;
+            }
+            double st = 0.0, sv = 0.0, stt = 0.0, stv = 0.0;
+            double n = (double)(j - i + 1);
+            for(size_t k = i; k <= j; k++)
+            {
+                double t = _samples[k].time - _samples[i].time;
+                st  += t;
+                sv  += _samples[k].response;
+                stt += t * t;
+                stv += t * _samples[k].response;
+            }
+            double denominator = n * stt - st * st;
+            if(denominator > 0)
+            {
+                max_slope = std::max(max_slope, std::fabs((n * stv - st * sv) / denominator));
+            }
+        }
+        return max_slope;
+    }
+
+    /**
+    * @brief        チャープ指令への追従遅れ（指令と応答の相互相関が最大となる遅れ）
+    */
+    double chirpLag(const stDynamicsSegment& segment, size_t begin, size_t end) const
+    {
+        double best_lag = 0.0;
+        double best_corr = -1e300;
+        for(double lag = 0.0; lag <= DYNAMICS_MAX_LAG; lag += DYNAMICS_LAG_STEP)
+        {
+            double corr = 0.0;
+            for(size_t i = begin; i < end; i++)
+            {
+                corr += _samples[i].response * commandAt(segment, _samples[i].time - lag);
+            }
+            if(corr > best_corr)
+            {
+                best_corr = corr;
+                best_lag = lag;
+            }
+        }
+        return best_lag;
+    }
+
+    std::string estimateYaml(const std::string& axis, const stDynamicsEstimate& estimate) const
+    {
+        std::string yaml = "\n# " + axis + (estimate.valid ? "" : "（推定できず）") + "\n";
+        yaml += line("dynamics_" + axis + "_latency",       estimate.latency);
+        yaml += line("dynamics_" + axis + "_time_constant", estimate.time_constant);
+        yaml += line("dynamics_" + axis + "_gain",          estimate.gain);
+        yaml += line("dynamics_" + axis + "_max_accel",     estimate.max_accel);
+        yaml += line("dynamics_" + axis + "_tracking_lag",  estimate.tracking_lag);
+        return yaml;
+    }
+
+    static std::string line(const std::string& key, double value)
+    {
+        char buf[128];
+        snprintf(buf, sizeof(buf), "%s: %.3f\n", key.c_str(), value);
+        return buf;
+    }
+};
+
+#endif
@@ -0,0 +1,296 @@
+/**
+* @file     footprint_stencil.h
+* @brief    ロボットのfootprintの回転済みマスクによるその場旋回の衝突判定クラスの定義ヘッダファイル
+* @author   S.Kumada
+* @date     2026/10/18
+* @note     footprintを一定角度毎に回転させて地図の解像度でラスタ化したビットマスクを事前に作成し、
+*           旋回時に通過する角度のマスクを地図と照合する
+*/
+
+#ifndef FOOTPRINT_STENCIL_H
+#define FOOTPRINT_STENCIL_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "utilities.h"
+
+/**
+ * @brief footprintの回転済みマスクによる衝突判定クラス
+ * @details マスクは行毎の64bit単位のビット列で保持する。隣接する角度の間を通過する領域も含むよう、
+ *          角度刻みの弦長とセルの対角長の分だけ外側に広げてラスタ化する
+ */
+class FootprintStencil
+{
+private:
+    struct Stencil
+    {
+        int min_x;                      // マスクの左端（ロボットのセルからの相対セル）
+        int min_y;                      // マスクの下端（ロボットのセルからの相対セル）
+        int width;                      // マスクの幅[セル]
+        int height;                     // マスクの高さ[セル]
+        int words;                      // 1行あたりの64bitワード数
+        std::vector<uint64_t> bits;     // マスク（行優先）
+    };
+
+    std::vector<Vector2d> _footprint;   // footprint（ロボット座標系）
+    std::vector<Stencil> _stencils;     // 角度毎のマスク
+    int _heading_count;                 // 角度の分割数
+    double _resolution;                 // マスクの解像度[m]
+
+    std::vector<uint8_t> _grid;         // 障害物グリッド（1:障害物）
+    int _width;                         // 地図の幅
+    int _height;                        // 地図の高さ
+    double _origin_x;                   // 地図の原点のx座標
+    double _origin_y;                   // 地図の原点のy座標
+
+public:
+    /**
+    * @brief        FootprintStencilクラスのコンストラクタ
+    */
+    FootprintStencil()
+        : _heading_count(0)
+        , _resolution(0.0)
+        , _width(0)
+        , _height(0)
+        , _origin_x(0.0)
+        , _origin_y(0.0) {}
+
+    /**
+    * @brief        マスク・地図がともに準備済みか
+    * @return       bool true:判定可能
+    */
+    bool isReady() const
+    {
+        return !_stencils.empty() && _width > 0 && _height > 0;
+    }
+
+    /**
+    * @brief        マスクの作成
+    * @param[in]    const std::vector<Vector2d>& footprint footprintの頂点（ロボット座標系）
+    * @param[in]    double resolution 解像度[m]（地図の解像度と合わせる）
+    * @param[in]    int heading_count 角度の分割数
+    * @return       void
+    */
+    void build(const std::vector<Vector2d>& footprint, double resolution, int heading_count)
+    {
+        _stencils.clear();
+        _footprint = footprint;
+        _resolution = resolution;
+        _heading_count = std::max(4, heading_count);
+
+        if(footprint.size() < 3 || resolution <= 0)
+        {
+            return;
+        }
+
+        double radius = 0.0;
+        for(size_t i = 0; i < footprint.size(); i++)
+        {
+            radius = std::max(radius, footprint[i].length());
+        }
+
+        // 隣接角度の間の通過領域（弦長の半分）とセル中心判定・ロボットのセル内位置の誤差分を広げる
+        double padding = radius * std::sin(M_PI / _heading_count) + resolution * M_SQRT2;
+        int reach = (int)std::ceil((radius + padding) / resolution) + 1;
+
+        _stencils.resize(_heading_count);
+        for(int k = 0; k < _heading_count; k++)
+        {
+            double angle = 2.0 * M_PI * k / _heading_count;
+            double c = std::cos(angle);
+            double s = std::sin(angle);
+            std::vector<Vector2d> polygon(footprint.size());
+            for(size_t i = 0; i < footprint.size(); i++)
+            {
+                polygon[i] = Vector2d(footprint[i].x * c - footprint[i].y * s, footprint[i].x * s + footprint[i].y * c);
+            }
+
+            Stencil& stencil = _stencils[k];
+            stencil.min_x  = -reach;
+            stencil.min_y  = -reach;
+            stencil.width  = 2 * reach + 1;
+            stencil.height = 2 * reach + 1;
+            stencil.words  = (stencil.width + 63) / 64;
+            stencil.bits.assign((size_t)stencil.words * stencil.height, 0);
+
+            for(int y = 0; y < stencil.height; y++)
+            {
+                for(int x = 0; x < stencil.width; x++)
+                {
+                    Vector2d p((x + stencil.min_x) * resolution, (y + stencil.min_y) * resolution);
+                    if(contains(polygon, p) || distanceToPolygon(polygon, p) <= padding)
+                    {
+                        stencil.bits[(size_t)y * stencil.words + x / 64] |= (uint64_t)1 << (x % 64);
+                    }
+                }
+            }
+        }
+    }
+
+    /**
+    * @brief        地図の設定
+    * @param[in]    int width, height 地図の幅・高さ
+    * @param[in]    double resolution 地図の解像度[m]
+    * @param[in]    double origin_x, origin_y 地図の原点座標
+    * @param[in]    const std::vector<int8_t>& data 地図の占有値（-1:未知, 0~100）
+    * @param[in]    int occupied_threshold 障害物とみなす占有値（未知領域は障害物とみなさない）
+    * @return       void
+    */
+    void setMap(int width, int height, double resolution, double origin_x, double origin_y,
+                const std::vector<int8_t>& data, int occupied_threshold)
+    {
+        if(width <= 0 || height <= 0 || data.size() < (size_t)width * height)
+        {
+            _width = _height = 0;
+            return;
+        }
+
+        _width    = width;
+        _height   = height;
+        _origin_x = origin_x;
+        _origin_y = origin_y;
+        _grid.resize((size_t)width * height);
+        for(size_t i = 0; i < _grid.size(); i++)
+        {
+            _grid[i] = (data[i] >= occupied_threshold) ? 1 : 0;
+        }
+
+        // 解像度が異なる場合はマスクを作り直す
+        if(std::fabs(resolution - _resolution) > 1e-6 && _footprint.size() >= 3)
+        {
+            build(_footprint, resolution, _heading_count);
+        }
+    }
+
+    /**
+    * @brief        指定姿勢で障害物と重なるか
+    * @param[in]    double x, y 位置
+    * @param[in]    double yaw 向き
+    * @return       bool true:重ならない
+    */
+    bool isPoseFree(double x, double y, double yaw) const
+    {
+        return checkStencil(x, y, headingIndex(yaw));
+    }
+
+    /**
+    * @brief        その場旋回の通過領域が障害物と重なるか
+    * @param[in]    double x, y 位置
+    * @param[in]    double yaw_from 旋回前の向き
+    * @param[in]    double yaw_to 旋回後の向き（短い方向へ旋回する）
+    * @return       bool true:安全に旋回できる
+    */
+    bool isTurnFree(double x, double y, double yaw_from, double yaw_to) const
+    {
+        if(!isReady())
+        {
+            return false;
+        }
+
+        double diff = std::atan2(std::sin(yaw_to - yaw_from), std::cos(yaw_to - yaw_from));
+        int from = headingIndex(yaw_from);
+        int steps = (int)std::ceil(std::fabs(diff) / (2.0 * M_PI / _heading_count));
+        int dir = (diff >= 0) ? 1 : -1;
+
+        for(int i = 0; i <= steps; i++)
+        {
+            int k = ((from + dir * i) % _heading_count + _heading_count) % _heading_count;
+            if(!checkStencil(x, y, k))
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+private:
+    /**
+    * @brief        向き→マスクの番号
+    */
+    int headingIndex(double yaw) const
+    {
+        double step = 2.0 * M_PI / _heading_count;
+        int k = (int)std::floor(yaw / step + 0.5);
+        return (k % _heading_count + _heading_count) % _heading_count;
+    }
+
+    /**
+    * @brief        マスクと地図の照合
+    * @return       bool true:重ならない（地図外は障害物とみなす）
+    */
+    bool checkStencil(double x, double y, int k) const
+    {
+        if(!isReady())
+        {
+            return false;
+        }
+
+        const Stencil& stencil = _stencils[k];
+        int cx = (int)std::floor((x - _origin_x) / _resolution);
+        int cy = (int)std::floor((y - _origin_y) / _resolution);
+
+        for(int sy = 0; sy < stencil.height; sy++)
+        {
+            int my = cy + stencil.min_y + sy;
+            for(int w = 0; w < stencil.words; w++)
+            {
+                uint64_t bits = stencil.bits[(size_t)sy * stencil.words + w];
+                while(bits != 0)
+                {
+                    int sx = w * 64 + __builtin_ctzll(bits);
+                    bits &= bits - 1;
+                    int mx = cx + stencil.min_x + sx;
+                    if(mx < 0 || my < 0 || mx >= _width || my >= _height)
+                    {
+                        return false;
+                    }
+                    if(_grid[(size_t)my * _width + mx] != 0)
+                    {
+                        return false;
+                    }
+                }
+            }
+        }
+
+        return true;
+    }
+
+    /**
+    * @brief        点が多角形の内部か（交差数判定）
+    */
+    static bool contains(const std::vector<Vector2d>& polygon, const Vector2d& p)
+    {
+        bool inside = false;
+        for(size_t i = 0, j = polygon.size() - 1; i < polygon.size(); j = i++)
+        {
+            if(((polygon[i].y > p.y) != (polygon[j].y > p.y)) &&
+               (p.x < (polygon[j].x - polygon[i].x) * (p.y - polygon[i].y) / (polygon[j].y - polygon[i].y) + polygon[i].x))
+            {
+                inside = !inside;
+            }
+        }
+        return inside;
+    }
+
+    /**
+    * @brief        点と多角形の辺との最短距離
+    */
+    static double distanceToPolygon(const std::vector<Vector2d>& polygon, const Vector2d& p)
+    {
+        double best = 1e9;
+        for(size_t i = 0, j = polygon.size() - 1; i < polygon.size(); j = i++)
+        {
+            Vector2d edge = polygon[i] - polygon[j];
+            double len2 = edge.lengthSquare();
+            double t = (len2 > 0) ? std::max(0.0, std::min(1.0, (p - polygon[j]).dot(edge) / len2)) : 0.0;
+            best = std::min(best, (polygon[j] + edge * t).distanceFrom(p));
+        }
+        return best;
+    }
+};
+
+#endif
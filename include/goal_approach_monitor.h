@@ -0,0 +1,219 @@
+/**
+* @file     goal_approach_monitor.h
+* @brief    目的地への接近の打ち切り判定クラスの定義ヘッダファイル
+* @author   S.Kumada
+* @date     2026/10/18
+* @note     接近速度と残り距離から到達見込み時刻を求め、最長時間内に到達できない場合や
+*           距離が縮まらなくなった場合は接近を終える。その場旋回（ゴールの向きへの合わせ込み）の間は距離の収束を判定しない
+*/
+
+#ifndef GOAL_APPROACH_MONITOR_H
+#define GOAL_APPROACH_MONITOR_H
+
+#include <algorithm>
+#include <cmath>
+
+// 判定結果
+#define GOAL_APPROACH_CONTINUE      0   // 接近を継続
+#define GOAL_APPROACH_REACHED       1   // 許容範囲に到達
+#define GOAL_APPROACH_CONVERGED     2   // 距離が縮まらなくなった
+#define GOAL_APPROACH_TIMEOUT       3   // 最長時間内に到達できない見込み
+
+typedef struct GoalApproachConfig
+{
+    double tolerance;           // 到達とみなす距離[m]
+    double min_timeout;         // 打ち切りまでの最短時間[s]（監視開始から）
+    double max_timeout;         // 打ち切りまでの最長時間[s]（監視開始から）
+    double margin;              // 見込み時間の余裕率（見込み時間/余裕率が最長時間を超える場合に打ち切る）
+    double min_speed;           // 見込み時間の算出に用いる最低接近速度[m/s]
+    double converge_time;       // 距離の縮小を確認する時間[s]
+    double converge_distance;   // 縮小とみなす最小の距離[m]
+    double rotate_yaw_rate;     // 旋回中とみなす旋回速度[rad/s]（旋回中は距離の縮小を確認する時間に含めない）
+
+    GoalApproachConfig()
+        : tolerance(0.05)
+        , min_timeout(1.0)
+        , max_timeout(8.0)
+        , margin(1.5)
+        , min_speed(0.02)
+        , converge_time(1.0)
+        , converge_distance(0.01)
+        , rotate_yaw_rate(0.1) {}
+
+}stGoalApproachConfig;
+
+/**
+ * @brief 目的地への接近の打ち切り判定クラス
+ * @details 監視開始後、周期毎に目的地までの距離を与える。接近速度は距離の減少量から指数移動平均で求め、
+ *          到達見込み時刻は「現在 + 残り距離 / 接近速度」とする。見込み時間を余裕率で割っても最長時間を超える場合は
+ *          待っても到達しないとみなして終える。直近の一定時間で最短距離が縮まっていない場合は、
+ *          それ以上精度が上がらないとみなして終える。旋回速度が一定以上の周期（ゴールの向きへのその場旋回など、
+ *          距離が縮まらない動作中）はこの確認時間を進めず、到達見込みによる打ち切りも行わない（最長時間は適用する）
+ */
+class GoalApproachMonitor
+{
+private:
+    stGoalApproachConfig _config;   // 判定パラメータ
+    bool _active;                   // 監視中か
+    double _start_time;             // 監視開始時刻[s]
+    double _expected_arrival;       // 到達見込み時刻[s]
+    double _last_time;              // 前回の時刻[s]
+    double _last_distance;          // 前回の距離[m]
+    double _last_yaw;               // 前回の向き[rad]
+    bool _rotating;                 // 旋回中か（前回の周期の旋回速度で判定）
+    double _speed;                  // 接近速度[m/s]
+    double _best_distance;          // 最短距離[m]
+    double _best_time;              // 最短距離を更新した時刻[s]
+
+public:
+    /**
+    * @brief        GoalApproachMonitorクラスのコンストラクタ
+    */
+    GoalApproachMonitor()
+        : _active(false)
+        , _start_time(0.0)
+        , _expected_arrival(0.0)
+        , _last_time(0.0)
+        , _last_distance(0.0)
+        , _last_yaw(0.0)
+        , _rotating(false)
+        , _speed(0.0)
+        , _best_distance(0.0)
+        , _best_time(0.0) {}
+
+    /**
+    * @brief        判定パラメータの設定
+    * @param[in]    const stGoalApproachConfig& config 判定パラメータ
+    * @return       void
+    */
+    void configure(const stGoalApproachConfig& config)
+    {
+        _config = config;
+    }
+
+    const stGoalApproachConfig& config() const { return _config; }
+
+    /**
+    * @brief        監視の開始
+    * @param[in]    double now 現在時刻[s]
+    * @param[in]    double distance 目的地までの距離[m]
+    * @param[in]    double yaw 現在の向き[rad]
+    * @param[in]    double speed 開始時の接近速度[m/s]（不明な場合は0）
+    * @return       void
+    */
+    void start(double now, double distance, double yaw, double speed)
+    {
+        _active        = true;
+        _start_time    = now;
+        _last_time     = now;
+        _last_distance = distance;
+        _last_yaw      = yaw;
+        _rotating      = false;
+        _speed         = std::max(0.0, speed);
+        _best_distance = distance;
+        _best_time     = now;
+        updateExpectedArrival(now, distance);
+    }
+
+    /**
+    * @brief        監視の終了
+    * @return       void
+    */
+    void reset()
+    {
+        _active = false;
+    }
+
+    bool isActive() const { return _active; }
+
+    /**
+    * @brief        接近の判定
+    * @param[in]    double now 現在時刻[s]
+    * @param[in]    double distance 目的地までの距離[m]
+    * @param[in]    double yaw 現在の向き[rad]
+    * @return       int 判定結果（GOAL_APPROACH_*）
+    */
+    int update(double now, double distance, double yaw)
+    {
+        if(!_active)
+        {
+            return GOAL_APPROACH_CONTINUE;
+        }
+
+        double dt = now - _last_time;
+        if(dt > 0)
+        {
+            double speed = (_last_distance - distance) / dt;
+            _speed = 0.7 * _speed + 0.3 * std::max(0.0, speed);
+            double yaw_rate = std::fabs(std::atan2(std::sin(yaw - _last_yaw), std::cos(yaw - _last_yaw))) / dt;
+            _rotating = (yaw_rate >= _config.rotate_yaw_rate);
+            if(_rotating)
+            { // 旋回中は距離の縮小を確認する時間を進めない
+                _best_time += dt;
+            }
+            _last_time = now;
+            _last_distance = distance;
+            _last_yaw = yaw;
+        }
+
+        if(distance < _best_distance - _config.converge_distance)
+        {
+            _best_distance = distance;
+            _best_time = now;
+        }
+
+        if(distance <= _config.tolerance)
+        {
+            return GOAL_APPROACH_REACHED;
+        }
+
+        double elapsed = now - _start_time;
+        if(elapsed >= _config.min_timeout && now - _best_time >= _config.converge_time)
+        {
+            return GOAL_APPROACH_CONVERGED;
+        }
+
+        updateExpectedArrival(now, distance);
+        if(elapsed >= _config.max_timeout ||
+           (!_rotating && elapsed >= _config.min_timeout && elapsed + (_expected_arrival - now) / _config.margin > _config.max_timeout))
+        {
+            return GOAL_APPROACH_TIMEOUT;
+        }
+
+        return GOAL_APPROACH_CONTINUE;
+    }
+
+    double elapsed(double now) const { return now - _start_time; }
+    double expectedArrival() const { return _expected_arrival - _start_time; }
+    double speed() const { return _speed; }
+    double bestDistance() const { return _best_distance; }
+    bool isRotating() const { return _rotating; }
+
+    /**
+    * @brief        判定結果の文字列
+    * @param[in]    int result 判定結果
+    * @return       const char* 判定結果の文字列
+    */
+    static const char* resultName(int result)
+    {
+        switch(result)
+        {
+            case GOAL_APPROACH_REACHED:   return "reached";
+            case GOAL_APPROACH_CONVERGED: return "converged";
+            case GOAL_APPROACH_TIMEOUT:   return "timeout";
+            default:                      return "continue";
+        }
+    }
+
+private:
+    /**
+    * @brief        到達見込み時刻の更新
+    */
+    void updateExpectedArrival(double now, double distance)
+    {
+        double remain = std::max(0.0, distance - _config.tolerance);
+        _expected_arrival = now + remain / std::max(_speed, _config.min_speed);
+    }
+};
+
+#endif
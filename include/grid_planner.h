@@ -0,0 +1,918 @@
+/**
+* @file     grid_planner.h
+* @brief    グリッド地図上の経路探索（A* / Jump Point Search）クラスの定義ヘッダファイル
+* @author   S.Kumada
+* @date     2026/10/18
+* @note     ソシオ地図を探索用の解像度に縮小・膨張した障害物グリッドを保持し、
+*           移動指示のコストマップを重ねた上で到達可否の判定と経路長の算出を行う
+*/
+
+#ifndef GRID_PLANNER_H
+#define GRID_PLANNER_H
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <vector>
+
+#include "utilities.h"
+
+// 探索結果
+#define     PLAN_SUCCEEDED          0   // 経路あり
+#define     PLAN_NO_MAP             1   // 地図未受信
+#define     PLAN_START_BLOCKED      2   // 開始地点が障害物内・地図外
+#define     PLAN_GOAL_BLOCKED       3   // 目的地が障害物内・地図外
+#define     PLAN_UNREACHABLE        4   // 到達不可（連結していない）
+#define     PLAN_TIMEOUT            5   // 到達可能だが探索が制限時間内に終わらない（経路長は直線距離の下限値）
+
+// 障害物グリッドのセル状態
+#define     GRID_CELL_FREE          0
+#define     GRID_CELL_STATIC        1   // 地図上の障害物（膨張済み）
+#define     GRID_CELL_OVERLAY       2   // 移動指示のコストマップ上の障害物
+
+/**
+ * @brief グリッド経路探索クラス
+ * @details 到達可否は連結成分で判定し、到達可能な場合のみA*またはJPSで経路を探索する。
+ *          連結成分は行毎の空きセルの連続区間をUnion-Findでまとめて求める（セル毎のラベル付けより高速）。
+ *          重ね合わせたコストマップは保持し、次の重ね合わせでは変化した行のみ障害物グリッドと空き区間を求め直す。
+ *          探索グリッドは外周1セルを障害物とした余白付きで保持し、隣接セル参照時の範囲チェックを省く。
+ *          探索用の配列は地図設定時に確保し、探索毎の初期化は世代番号で省略する。
+ *          到達可否は連結成分で確定するため、探索が制限時間を超えた場合は経路長の下限値を返す
+ */
+class GridPlanner
+{
+private:
+    struct OpenNode
+    {
+        float f;        // 評価値
+        float g;        // 開始地点からのコスト
+        int32_t idx;    // セル番号
+
+        // f値が小さい順、同値の場合はg値が大きい（目的地に近い）順
+        bool operator >(const OpenNode& other) const
+        {
+            return f > other.f || (f == other.f && g < other.g);
+        }
+    };
+
+    struct Run
+    {
+        int32_t begin;  // 区間の開始x
+        int32_t end;    // 区間の終了x（含む）
+    };
+
+    int _width;                         // 探索グリッドの幅（余白なし）
+    int _height;                        // 探索グリッドの高さ（余白なし）
+    int _stride;                        // 余白付きグリッドの幅
+    int _factor;                        // 元地図からの縮小倍率
+    int _map_width;                     // 元地図の幅
+    int _map_height;                    // 元地図の高さ
+    double _cell_size;                  // 探索グリッドの解像度[m]
+    double _origin_x;                   // 地図の原点のx座標
+    double _origin_y;                   // 地図の原点のy座標
+    int _snap_cells;                    // 開始・目的地が障害物内の場合に空きセルを探す半径[セル]
+    float _heuristic_weight;            // ヒューリスティックの重み（1.0で最短経路）
+    double _time_budget;                // 探索の制限時間[sec]（0以下で制限なし）
+
+    std::vector<uint8_t> _static_grid;  // 地図の障害物グリッド（膨張済み、余白付き）
+    std::vector<uint8_t> _grid;         // 地図＋コストマップの障害物グリッド（余白付き）
+    std::vector<uint8_t> _overlay_cost; // 重ね合わせ中のコストマップ（変化した行の検出用）
+    uint8_t _overlay_lethal;            // 重ね合わせ中のコストマップの障害物とみなすコスト値
+    bool _overlay_clear;                // 重ね合わせなし（_overlay_costはすべて0）
+    std::vector<uint8_t> _row_scratch;  // 行の更新前の障害物グリッド（作業用）
+
+    std::vector<std::vector<Run> > _row_run_cache; // 行毎の空き区間（変化した行のみ求め直す）
+    std::vector<uint8_t> _row_dirty;    // 空き区間を求め直す行
+    std::vector<Run> _runs;             // 行毎の空きセルの連続区間
+    std::vector<int32_t> _row_runs;     // 行毎の区間の開始位置（_height + 1個）
+    std::vector<int32_t> _run_parent;   // 区間のUnion-Find
+    bool _labels_valid;                 // 連結成分が最新か
+
+    std::vector<float> _g;              // 開始地点からのコスト
+    std::vector<int32_t> _parent;       // 親セル
+    std::vector<uint32_t> _visit_gen;   // 訪問済みの世代番号（_gen:オープン, _gen + 1:クローズ）
+    uint32_t _gen;                      // 探索の世代番号（2ずつ進める）
+    std::vector<OpenNode> _open_storage; // オープンリストの格納領域（二分ヒープ）
+    size_t _expanded;                   // 直近の探索の展開セル数
+
+public:
+    /**
+    * @brief        GridPlannerクラスのコンストラクタ
+    */
+    GridPlanner()
+        : _width(0)
+        , _height(0)
+        , _stride(0)
+        , _factor(1)
+        , _map_width(0)
+        , _map_height(0)
+        , _cell_size(0.0)
+        , _origin_x(0.0)
+        , _origin_y(0.0)
+        , _snap_cells(0)
+        , _heuristic_weight(1.0f)
+        , _time_budget(0.0)
+        , _overlay_lethal(0)
+        , _overlay_clear(true)
+        , _labels_valid(false)
+        , _gen(0)
+        , _expanded(0) {}
+
+    /**
+    * @brief        地図が設定済みか
+    * @return       bool true:設定済み, false:未設定
+    */
+    bool isReady() const { return _width > 0 && _height > 0; }
+
+    /**
+    * @brief        探索グリッドの解像度の取得
+    * @return       double 解像度[m]
+    */
+    double cellSize() const { return _cell_size; }
+
+    /**
+    * @brief        直近の探索の展開セル数の取得
+    * @return       size_t 展開セル数
+    */
+    size_t expandedCount() const { return _expanded; }
+
+    /**
+    * @brief        ヒューリスティックの重みの設定
+    * @param[in]    double weight 重み（1.0より大きいと探索は速くなるが経路長は最大weight倍まで長くなる）
+    * @return       void
+    */
+    void setHeuristicWeight(double weight)
+    {
+        _heuristic_weight = (float)std::max(1.0, weight);
+    }
+
+    /**
+    * @brief        探索の制限時間の設定
+    * @param[in]    double time_budget 制限時間[sec]（0以下で制限なし）
+    * @return       void
+    */
+    void setTimeBudget(double time_budget)
+    {
+        _time_budget = time_budget;
+    }
+
+    /**
+    * @brief        地図の設定
+    * @param[in]    int width, height 地図の幅・高さ
+    * @param[in]    double resolution 地図の解像度[m]
+    * @param[in]    double origin_x, origin_y 地図の原点座標
+    * @param[in]    const std::vector<int8_t>& data 地図の占有値（-1:未知, 0~100）
+    * @param[in]    double planning_resolution 探索グリッドの解像度[m]
+    * @param[in]    double inflation_radius 障害物の膨張半径[m]
+    * @param[in]    int occupied_threshold 障害物とみなす占有値
+    * @param[in]    bool unknown_is_obstacle 未知領域を障害物とみなすか
+    * @return       void
+    */
+    void setStaticMap(int width, int height, double resolution, double origin_x, double origin_y,
+                      const std::vector<int8_t>& data, double planning_resolution, double inflation_radius,
+                      int occupied_threshold, bool unknown_is_obstacle)
+    {
+        if(width <= 0 || height <= 0 || resolution <= 0 || data.size() < (size_t)width * height)
+        {
+            _width = _height = 0;
+            return;
+        }
+
+        _map_width  = width;
+        _map_height = height;
+        _factor     = std::max(1, (int)std::floor(planning_resolution / resolution + 0.5));
+        _cell_size  = resolution * _factor;
+        _origin_x   = origin_x;
+        _origin_y   = origin_y;
+        _width      = (width + _factor - 1) / _factor;
+        _height     = (height + _factor - 1) / _factor;
+        _stride     = _width + 2;
+
+        size_t size = (size_t)_stride * (_height + 2);
+        _static_grid.assign(size, GRID_CELL_STATIC); // 余白は障害物
+        for(int y = 0; y < _height; y++)
+        {
+            std::fill(&_static_grid[cellIndex(0, y)], &_static_grid[cellIndex(0, y)] + _width, GRID_CELL_FREE);
+        }
+
+        // 縮小（セル内に1つでも障害物があれば障害物）
+        for(int y = 0; y < height; y++)
+        {
+            const int8_t* row = &data[(size_t)y * width];
+            uint8_t* grid_row = &_static_grid[cellIndex(0, y / _factor)];
+            for(int x = 0; x < width; x++)
+            {
+                if(row[x] >= occupied_threshold || (unknown_is_obstacle && row[x] < 0))
+                {
+                    grid_row[x / _factor] = GRID_CELL_STATIC;
+                }
+            }
+        }
+
+        inflate((int)std::ceil(inflation_radius / _cell_size));
+        _snap_cells = std::max(1, (int)std::ceil(inflation_radius / _cell_size));
+
+        _grid = _static_grid;
+        _overlay_cost.assign((size_t)_map_width * _map_height, 0);
+        _overlay_clear = true;
+        _row_scratch.resize(_width);
+        _row_run_cache.assign(_height, std::vector<Run>());
+        _row_dirty.assign(_height, 1);
+        _g.assign(size, 0.0f);
+        _parent.assign(size, -1);
+        _visit_gen.assign(size, 0);
+        _gen = 0;
+        _open_storage.reserve(size / 16);
+
+        updateLabels();
+    }
+
+    /**
+    * @brief        移動指示のコストマップの重ね合わせ
+    * @param[in]    const std::vector<uint8_t>& cost_value コスト値（地図と同じサイズ）
+    * @param[in]    uint8_t lethal_cost 障害物とみなすコスト値
+    * @return       bool true:設定成功, false:サイズ不一致
+    * @details      前回重ね合わせたコストマップと行単位で比較し、変化した行のみ障害物グリッドを更新する。
+    *               障害物グリッドが変化した行のみ連結成分の求め直しの対象とする
+    */
+    bool setOverlay(const std::vector<uint8_t>& cost_value, uint8_t lethal_cost)
+    {
+        if(!isReady() || cost_value.size() != (size_t)_map_width * _map_height)
+        {
+            return false;
+        }
+
+        // 障害物とみなすコスト値が変わった場合はすべての行を作り直す（重ね合わせなしからの場合は0以外なら不要）
+        bool full = (lethal_cost != _overlay_lethal && !(_overlay_clear && lethal_cost != 0));
+
+        for(int gy = 0; gy < _height; gy++)
+        {
+            int y0 = gy * _factor;
+            int y1 = std::min(y0 + _factor, _map_height);
+            size_t begin = (size_t)y0 * _map_width;
+            size_t count = (size_t)(y1 - y0) * _map_width;
+            if(!full && memcmp(&cost_value[begin], &_overlay_cost[begin], count) == 0)
+            {
+                continue;
+            }
+            memcpy(&_overlay_cost[begin], &cost_value[begin], count);
+
+            // 探索グリッドの行を地図の障害物から作り直す
+            uint8_t* grid_row = &_grid[cellIndex(0, gy)];
+            memcpy(&_row_scratch[0], grid_row, _width);
+            memcpy(grid_row, &_static_grid[cellIndex(0, gy)], _width);
+            for(int y = y0; y < y1; y++)
+            {
+                const uint8_t* row = &cost_value[(size_t)y * _map_width];
+                for(int x = 0; x < _map_width; x++)
+                {
+                    if(row[x] == lethal_cost && grid_row[x / _factor] == GRID_CELL_FREE)
+                    {
+                        grid_row[x / _factor] = GRID_CELL_OVERLAY;
+                    }
+                }
+            }
+            if(memcmp(&_row_scratch[0], grid_row, _width) != 0)
+            {
+                _row_dirty[gy] = 1;
+                _labels_valid = false;
+            }
+        }
+        _overlay_lethal = lethal_cost;
+        _overlay_clear  = false;
+
+        return true;
+    }
+
+    /**
+    * @brief        コストマップの重ね合わせの解除
+    * @return       void
+    */
+    void clearOverlay()
+    {
+        if(!isReady())
+        {
+            return;
+        }
+        for(int y = 0; y < _height; y++)
+        {
+            uint8_t* grid_row = &_grid[cellIndex(0, y)];
+            const uint8_t* static_row = &_static_grid[cellIndex(0, y)];
+            if(memcmp(grid_row, static_row, _width) != 0)
+            {
+                memcpy(grid_row, static_row, _width);
+                _row_dirty[y] = 1;
+                _labels_valid = false;
+            }
+        }
+        std::fill(_overlay_cost.begin(), _overlay_cost.end(), 0);
+        _overlay_clear = true;
+    }
+
+    /**
+    * @brief        経路探索
+    * @param[in]    double sx, sy 開始地点の座標
+    * @param[in]    double gx, gy 目的地の座標
+    * @param[in]    bool use_jps true:Jump Point Search, false:A*
+    * @param[out]   std::vector<Vector2d>& path 経路（開始地点→目的地、JPSの場合は折れ点のみ）
+    * @param[out]   double& length 経路長[m]
+    * @return       int 探索結果（PLAN_*）
+    */
+    int plan(double sx, double sy, double gx, double gy, bool use_jps, std::vector<Vector2d>& path, double& length)
+    {
+        path.clear();
+        length = 0.0;
+        _expanded = 0;
+
+        if(!isReady())
+        {
+            return PLAN_NO_MAP;
+        }
+
+        int32_t start = snapToFree(sx, sy);
+        if(start < 0)
+        {
+            return PLAN_START_BLOCKED;
+        }
+        int32_t goal = snapToFree(gx, gy);
+        if(goal < 0)
+        {
+            return PLAN_GOAL_BLOCKED;
+        }
+
+        // 連結成分による到達可否判定（探索せずに判定できる）
+        if(!_labels_valid)
+        {
+            updateLabels();
+        }
+        if(label(start) != label(goal))
+        {
+            return PLAN_UNREACHABLE;
+        }
+
+        int result = search(start, goal, use_jps);
+        if(result == PLAN_TIMEOUT)
+        { // 到達可能は確定済みのため、経路長は下限値とする
+            path.push_back(Vector2d(sx, sy));
+            path.push_back(Vector2d(gx, gy));
+            length = std::max((double)octile(start, goal) * _cell_size, path[0].distanceFrom(path[1]));
+            return PLAN_TIMEOUT;
+        }
+        if(result != PLAN_SUCCEEDED)
+        {
+            return result;
+        }
+
+        // 経路の復元
+        std::vector<int32_t> cells;
+        for(int32_t idx = goal; idx >= 0; idx = _parent[idx])
+        {
+            cells.push_back(idx);
+            if(idx == start)
+            {
+                break;
+            }
+        }
+        std::reverse(cells.begin(), cells.end());
+
+        path.reserve(cells.size() + 2);
+        path.push_back(Vector2d(sx, sy));
+        for(size_t i = 0; i < cells.size(); i++)
+        {
+            path.push_back(cellToWorld(cells[i]));
+        }
+        path.push_back(Vector2d(gx, gy));
+
+        for(size_t i = 1; i < path.size(); i++)
+        {
+            length += path[i - 1].distanceFrom(path[i]);
+        }
+
+        return PLAN_SUCCEEDED;
+    }
+
+private:
+    /**
+    * @brief        余白付きグリッドのセル番号
+    */
+    size_t cellIndex(int x, int y) const
+    {
+        return (size_t)(y + 1) * _stride + (x + 1);
+    }
+
+    /**
+    * @brief        セル→座標変換（セル中心）
+    */
+    Vector2d cellToWorld(int32_t idx) const
+    {
+        return Vector2d(_origin_x + (idx % _stride - 1 + 0.5) * _cell_size,
+                        _origin_y + (idx / _stride - 1 + 0.5) * _cell_size);
+    }
+
+    /**
+    * @brief        空きセルか（余白は障害物のため範囲チェック不要）
+    */
+    bool isFree(int32_t idx) const
+    {
+        return _grid[idx] == GRID_CELL_FREE;
+    }
+
+    /**
+    * @brief        障害物の膨張（障害物の境界セルを中心に円形に塗る）
+    * @param[in]    int radius 膨張半径[セル]
+    * @details      円は行毎の半幅で表し、塗る範囲を座標で地図内に切り詰める
+    *               （セル番号の差分で塗ると左右端で隣の行に回り込むため）
+    */
+    void inflate(int radius)
+    {
+        if(radius <= 0)
+        {
+            return;
+        }
+
+        std::vector<int> half_width(radius + 1);
+        for(int dy = 0; dy <= radius; dy++)
+        {
+            half_width[dy] = (int)std::floor(std::sqrt((double)(radius * radius - dy * dy)));
+        }
+
+        std::vector<uint8_t> src = _static_grid;
+        for(int y = 0; y < _height; y++)
+        {
+            for(int x = 0; x < _width; x++)
+            {
+                int32_t idx = (int32_t)cellIndex(x, y);
+                if(src[idx] == GRID_CELL_FREE)
+                {
+                    continue;
+                }
+                // 空きセルに接していない障害物は塗る必要なし
+                if(src[idx - 1] != GRID_CELL_FREE && src[idx + 1] != GRID_CELL_FREE &&
+                   src[idx - _stride] != GRID_CELL_FREE && src[idx + _stride] != GRID_CELL_FREE)
+                {
+                    continue;
+                }
+                for(int dy = -radius; dy <= radius; dy++)
+                {
+                    int ny = y + dy;
+                    if(ny < 0 || ny >= _height)
+                    {
+                        continue;
+                    }
+                    int x0 = std::max(0, x - half_width[std::abs(dy)]);
+                    int x1 = std::min(_width - 1, x + half_width[std::abs(dy)]);
+                    std::fill(&_static_grid[cellIndex(x0, ny)], &_static_grid[cellIndex(x1, ny)] + 1, (uint8_t)GRID_CELL_STATIC);
+                }
+            }
+        }
+    }
+
+    /**
+    * @brief        指定座標の最寄りの空きセルの取得
+    * @param[in]    double wx, wy 座標
+    * @return       int32_t セル番号（見つからない場合は-1）
+    */
+    int32_t snapToFree(double wx, double wy) const
+    {
+        int cx = (int)std::floor((wx - _origin_x) / _cell_size);
+        int cy = (int)std::floor((wy - _origin_y) / _cell_size);
+        if(cx < 0 || cy < 0 || cx >= _width || cy >= _height)
+        {
+            return -1;
+        }
+        if(isFree(cellIndex(cx, cy)))
+        {
+            return (int32_t)cellIndex(cx, cy);
+        }
+
+        int32_t best = -1;
+        int best_dist = INT_MAX;
+        for(int dy = -_snap_cells; dy <= _snap_cells; dy++)
+        {
+            for(int dx = -_snap_cells; dx <= _snap_cells; dx++)
+            {
+                int x = cx + dx;
+                int y = cy + dy;
+                int dist = dx * dx + dy * dy;
+                if(x < 0 || y < 0 || x >= _width || y >= _height || dist >= best_dist || dist > _snap_cells * _snap_cells)
+                {
+                    continue;
+                }
+                if(isFree(cellIndex(x, y)))
+                {
+                    best_dist = dist;
+                    best = (int32_t)cellIndex(x, y);
+                }
+            }
+        }
+
+        return best;
+    }
+
+    /**
+    * @brief        Union-Findの根の取得（経路圧縮あり）
+    */
+    int32_t findRoot(int32_t run)
+    {
+        while(_run_parent[run] != run)
+        {
+            _run_parent[run] = _run_parent[_run_parent[run]];
+            run = _run_parent[run];
+        }
+        return run;
+    }
+
+    /**
+    * @brief        連結成分の更新
+    * @details      斜め移動は両隣が空きの場合のみ許可するため、4近傍の連結と一致する。
+    *               行毎の空き区間を求め、上の行と重なる区間同士を結合する。
+    *               空き区間はグリッドが変化した行のみ求め直し、結合は区間単位で行う（セル数によらない）
+    */
+    void updateLabels()
+    {
+        for(int y = 0; y < _height; y++)
+        {
+            if(!_row_dirty[y])
+            {
+                continue;
+            }
+            std::vector<Run>& runs = _row_run_cache[y];
+            runs.clear();
+            const uint8_t* row = &_grid[cellIndex(0, y)];
+            int x = 0;
+            while(x < _width)
+            {
+                if(row[x] != GRID_CELL_FREE)
+                {
+                    x++;
+                    continue;
+                }
+                Run run;
+                run.begin = x;
+                while(x < _width && row[x] == GRID_CELL_FREE)
+                {
+                    x++;
+                }
+                run.end = x - 1;
+                runs.push_back(run);
+            }
+            _row_dirty[y] = 0;
+        }
+
+        _runs.clear();
+        _row_runs.assign(_height + 1, 0);
+        for(int y = 0; y < _height; y++)
+        {
+            _row_runs[y] = (int32_t)_runs.size();
+            _runs.insert(_runs.end(), _row_run_cache[y].begin(), _row_run_cache[y].end());
+        }
+        _row_runs[_height] = (int32_t)_runs.size();
+
+        _run_parent.resize(_runs.size());
+        for(size_t i = 0; i < _run_parent.size(); i++)
+        {
+            _run_parent[i] = (int32_t)i;
+        }
+
+        for(int y = 1; y < _height; y++)
+        {
+            int32_t a = _row_runs[y - 1];
+            int32_t b = _row_runs[y];
+            while(a < _row_runs[y] && b < _row_runs[y + 1])
+            {
+                if(_runs[a].begin <= _runs[b].end && _runs[b].begin <= _runs[a].end)
+                {
+                    int32_t ra = findRoot(a);
+                    int32_t rb = findRoot(b);
+                    if(ra != rb)
+                    {
+                        _run_parent[std::max(ra, rb)] = std::min(ra, rb);
+                    }
+                }
+                // 終端が手前の区間を進める
+                if(_runs[a].end < _runs[b].end)
+                {
+                    a++;
+                }
+                else
+                {
+                    b++;
+                }
+            }
+        }
+        _labels_valid = true;
+    }
+
+    /**
+    * @brief        セルの連結成分の取得
+    * @param[in]    int32_t idx 空きセルのセル番号
+    * @return       int32_t 連結成分の代表区間
+    */
+    int32_t label(int32_t idx)
+    {
+        int x = idx % _stride - 1;
+        int y = idx / _stride - 1;
+
+        // 行内の区間を二分探索
+        int32_t lo = _row_runs[y];
+        int32_t hi = _row_runs[y + 1] - 1;
+        while(lo < hi)
+        {
+            int32_t mid = (lo + hi + 1) / 2;
+            if(_runs[mid].begin <= x)
+            {
+                lo = mid;
+            }
+            else
+            {
+                hi = mid - 1;
+            }
+        }
+        return findRoot(lo);
+    }
+
+    /**
+    * @brief        オクタイル距離（8近傍移動の下限コスト）
+    */
+    static float octile(int ax, int ay, int bx, int by)
+    {
+        int dx = std::abs(ax - bx);
+        int dy = std::abs(ay - by);
+        return (float)(std::max(dx, dy) + (M_SQRT2 - 1.0) * std::min(dx, dy));
+    }
+
+    float octile(int32_t a, int32_t b) const
+    {
+        return octile(a % _stride, a / _stride, b % _stride, b / _stride);
+    }
+
+    /**
+    * @brief        セルの訪問（初回訪問時は世代番号で初期化、クローズ済みは更新しない）
+    * @return       bool true:コストが更新された
+    */
+    bool relax(int32_t idx, int32_t parent, float g)
+    {
+        if(_visit_gen[idx] == _gen + 1)
+        {
+            return false;
+        }
+        if(_visit_gen[idx] != _gen)
+        {
+            _visit_gen[idx] = _gen;
+            _g[idx] = g;
+            _parent[idx] = parent;
+            return true;
+        }
+        if(g < _g[idx])
+        {
+            _g[idx] = g;
+            _parent[idx] = parent;
+            return true;
+        }
+        return false;
+    }
+
+    /**
+    * @brief        JPSの跳躍（斜め移動は両隣が空きの場合のみ）
+    * @param[in]    int32_t idx 跳躍先のセル
+    * @param[in]    int dx, dy 移動方向
+    * @param[in]    int32_t goal 目的地のセル番号
+    * @return       int32_t 跳躍点のセル番号（なしの場合は-1）
+    */
+    int32_t jump(int32_t idx, int dx, int dy, int32_t goal) const
+    {
+        const int32_t step_x = dx;
+        const int32_t step_y = dy * _stride;
+
+        for(;;)
+        {
+            if(!isFree(idx))
+            {
+                return -1;
+            }
+            if(idx == goal)
+            {
+                return idx;
+            }
+            if(dx != 0 && dy != 0)
+            { // 斜め移動中は縦横方向に跳躍点があるか
+                if(jump(idx + step_x, dx, 0, goal) >= 0 || jump(idx + step_y, 0, dy, goal) >= 0)
+                {
+                    return idx;
+                }
+                if(!isFree(idx + step_x) || !isFree(idx + step_y))
+                {
+                    return -1;
+                }
+            }
+            else if(dx != 0)
+            { // 横移動中の強制隣接
+                if((isFree(idx - _stride) && !isFree(idx - _stride - step_x)) ||
+                   (isFree(idx + _stride) && !isFree(idx + _stride - step_x)))
+                {
+                    return idx;
+                }
+            }
+            else
+            { // 縦移動中の強制隣接
+                if((isFree(idx - 1) && !isFree(idx - 1 - step_y)) ||
+                   (isFree(idx + 1) && !isFree(idx + 1 - step_y)))
+                {
+                    return idx;
+                }
+            }
+            idx += step_x + step_y;
+        }
+    }
+
+    /**
+    * @brief        探索方向の候補の取得（JPSは親からの方向で枝刈り）
+    * @param[in]    int32_t idx 現在のセル
+    * @param[in]    bool use_jps JPSを使用するか
+    * @param[out]   int dirs[8][2] 方向
+    * @return       int 方向の数
+    */
+    int neighborDirections(int32_t idx, bool use_jps, int dirs[8][2]) const
+    {
+        int n = 0;
+        int32_t parent = _parent[idx];
+
+        if(!use_jps || parent < 0)
+        { // 全方向（斜めは両隣が空きの場合のみ）
+            for(int dy = -1; dy <= 1; dy++)
+            {
+                for(int dx = -1; dx <= 1; dx++)
+                {
+                    if((dx == 0 && dy == 0) || !isFree(idx + dy * _stride + dx))
+                    {
+                        continue;
+                    }
+                    if(dx != 0 && dy != 0 && (!isFree(idx + dx) || !isFree(idx + dy * _stride)))
+                    {
+                        continue;
+                    }
+                    dirs[n][0] = dx;
+                    dirs[n][1] = dy;
+                    n++;
+                }
+            }
+            return n;
+        }
+
+        int x = idx % _stride;
+        int y = idx / _stride;
+        int px = parent % _stride;
+        int py = parent / _stride;
+        int dx = (x > px) - (x < px);
+        int dy = (y > py) - (y < py);
+
+        if(dx != 0 && dy != 0)
+        {
+            bool free_y = isFree(idx + dy * _stride);
+            bool free_x = isFree(idx + dx);
+            if(free_y) { dirs[n][0] = 0;  dirs[n][1] = dy; n++; }
+            if(free_x) { dirs[n][0] = dx; dirs[n][1] = 0;  n++; }
+            if(free_x && free_y) { dirs[n][0] = dx; dirs[n][1] = dy; n++; }
+        }
+        else if(dx != 0)
+        {
+            bool free_next = isFree(idx + dx);
+            bool free_up   = isFree(idx + _stride);
+            bool free_down = isFree(idx - _stride);
+            if(free_next)
+            {
+                dirs[n][0] = dx; dirs[n][1] = 0; n++;
+                if(free_up)   { dirs[n][0] = dx; dirs[n][1] = 1;  n++; }
+                if(free_down) { dirs[n][0] = dx; dirs[n][1] = -1; n++; }
+            }
+            if(free_up)   { dirs[n][0] = 0; dirs[n][1] = 1;  n++; }
+            if(free_down) { dirs[n][0] = 0; dirs[n][1] = -1; n++; }
+        }
+        else
+        {
+            bool free_next  = isFree(idx + dy * _stride);
+            bool free_right = isFree(idx + 1);
+            bool free_left  = isFree(idx - 1);
+            if(free_next)
+            {
+                dirs[n][0] = 0; dirs[n][1] = dy; n++;
+                if(free_right) { dirs[n][0] = 1;  dirs[n][1] = dy; n++; }
+                if(free_left)  { dirs[n][0] = -1; dirs[n][1] = dy; n++; }
+            }
+            if(free_right) { dirs[n][0] = 1;  dirs[n][1] = 0; n++; }
+            if(free_left)  { dirs[n][0] = -1; dirs[n][1] = 0; n++; }
+        }
+
+        return n;
+    }
+
+    /**
+    * @brief        A* / JPS 探索
+    * @param[in]    int32_t start 開始セル
+    * @param[in]    int32_t goal 目的地セル
+    * @param[in]    bool use_jps JPSを使用するか
+    * @return       int PLAN_SUCCEEDED:経路あり, PLAN_UNREACHABLE:経路なし, PLAN_TIMEOUT:制限時間超過
+    */
+    int search(int32_t start, int32_t goal, bool use_jps)
+    {
+        // 世代番号の更新（一周した場合のみ訪問情報を初期化）
+        _gen += 2;
+        if(_gen < 2)
+        {
+            std::fill(_visit_gen.begin(), _visit_gen.end(), 0);
+            _gen = 2;
+        }
+
+        std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() +
+            std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(_time_budget));
+
+        const int goal_x = goal % _stride;
+        const int goal_y = goal / _stride;
+
+        // オープンリスト（確保済みの領域をヒープとして使う）
+        std::vector<OpenNode>& open = _open_storage;
+        std::greater<OpenNode> compare;
+        open.clear();
+
+        OpenNode node;
+        relax(start, -1, 0.0f);
+        node.f = _heuristic_weight * octile(start, goal);
+        node.g = 0.0f;
+        node.idx = start;
+        open.push_back(node);
+
+        int result = PLAN_UNREACHABLE;
+        int dirs[8][2];
+
+        while(!open.empty())
+        {
+            std::pop_heap(open.begin(), open.end(), compare);
+            node = open.back();
+            open.pop_back();
+            int32_t idx = node.idx;
+
+            // クローズ済み（より良いコストで展開済み）のエントリは読み飛ばす
+            if(_visit_gen[idx] == _gen + 1 || node.g > _g[idx])
+            {
+                continue;
+            }
+            if(idx == goal)
+            {
+                result = PLAN_SUCCEEDED;
+                break;
+            }
+            _visit_gen[idx] = _gen + 1;
+            _expanded++;
+
+            // 制限時間の確認（時刻取得の負荷を抑えるため一定回数毎）
+            if(_time_budget > 0 && (_expanded & 0x3ff) == 0 && std::chrono::steady_clock::now() > deadline)
+            {
+                result = PLAN_TIMEOUT;
+                break;
+            }
+
+            const int x = idx % _stride;
+            const int y = idx / _stride;
+            int n = neighborDirections(idx, use_jps, dirs);
+            for(int k = 0; k < n; k++)
+            {
+                int32_t next = idx + dirs[k][1] * _stride + dirs[k][0];
+                int nx = x + dirs[k][0];
+                int ny = y + dirs[k][1];
+                float g;
+                if(use_jps)
+                {
+                    next = jump(next, dirs[k][0], dirs[k][1], goal);
+                    if(next < 0)
+                    {
+                        continue;
+                    }
+                    nx = next % _stride;
+                    ny = next / _stride;
+                    g = _g[idx] + octile(x, y, nx, ny);
+                }
+                else
+                {
+                    g = _g[idx] + ((dirs[k][0] != 0 && dirs[k][1] != 0) ? (float)M_SQRT2 : 1.0f);
+                }
+                if(relax(next, idx, g))
+                {
+                    OpenNode next_node;
+                    next_node.f = g + _heuristic_weight * octile(nx, ny, goal_x, goal_y);
+                    next_node.g = g;
+                    next_node.idx = next;
+                    open.push_back(next_node);
+                    std::push_heap(open.begin(), open.end(), compare);
+                }
+            }
+        }
+
+        return result;
+    }
+};
+
+#endif
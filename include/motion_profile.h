@@ -0,0 +1,290 @@
+/**
+* @file     motion_profile.h
+* @brief    並進の速度プロファイル（台形・S字）生成クラスの定義ヘッダファイル
+* @author   S.Kumada
+* @date     2026/10/18
+* @note     速度・加速度・加加速度の制限内で加減速し、残り距離から求めた減速曲線で目標距離に止める
+*/
+
+#ifndef MOTION_PROFILE_H
+#define MOTION_PROFILE_H
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+// プロファイルの種類
+#define MOTION_PROFILE_TRAPEZOIDAL  0   // 台形（加速度の切り替えが不連続）
+#define MOTION_PROFILE_S_CURVE      1   // S字（加加速度制限で加速度を連続に変化させる）
+
+typedef struct MotionProfileConfig
+{
+    int type;               // プロファイルの種類（MOTION_PROFILE_*）
+    double max_velocity;    // 最大速度[m/s]
+    double max_accel;       // 最大加速度[m/s^2]
+    double max_jerk;        // 最大加加速度[m/s^3]（S字のみ）
+    double min_velocity;    // 最低速度[m/s]（目標手前で止まらないための速度）
+    double kp;              // 目標付近の比例ゲイン[1/s]（残り距離×ゲインを速度の上限とする）
+    double tolerance;       // 到達とみなす残り距離[m]
+
+    MotionProfileConfig()
+        : type(MOTION_PROFILE_S_CURVE)
+        , max_velocity(0.25)
+        , max_accel(0.5)
+        , max_jerk(2.0)
+        , min_velocity(0.02)
+        , kp(2.0)
+        , tolerance(0.005) {}
+
+}stMotionProfileConfig;
+
+/**
+ * @brief 並進の速度プロファイル生成クラス
+ * @details 距離指定（start）では、周期毎に開始位置からの進んだ距離（進行方向を正）を与えると速度指令を返す。
+ *          目標速度は min(最大速度, 残り距離からの減速曲線, 比例制御) とし、台形は加速度、S字は加えて加加速度で
+ *          速度の変化を制限する。S字の減速曲線は減速度の立ち上がり分を含めて求める。
+ *          速度指定（startVelocity）では、目標速度まで同じ制限で加減速する（逆方向への切り替えも含む）。
+ *          track()は周期毎に目標速度を与える速度指令の整形に使う。
+ *          後退は負の距離・速度で指定する
+ */
+class MotionProfile
+{
+private:
+    stMotionProfileConfig _config;  // プロファイルのパラメータ
+    bool _distance_mode;            // 距離指定か（false:速度指定）
+    double _direction;              // 進行方向（1:前進, -1:後退）
+    double _distance;               // 目標距離[m]（絶対値）
+    double _target_velocity;        // 速度指定時の目標速度[m/s]（進行方向基準）
+    double _remaining;              // 残り距離[m]
+    double _velocity;               // 指令速度[m/s]（進行方向基準、距離指定時は0以上）
+    double _accel;                  // 指令加速度[m/s^2]（進行方向基準）
+    double _elapsed;                // 開始からの経過時間[s]
+    bool _finished;                 // 完了したか
+
+public:
+    /**
+    * @brief        MotionProfileクラスのコンストラクタ
+    */
+    MotionProfile()
+        : _distance_mode(true)
+        , _direction(1.0)
+        , _distance(0.0)
+        , _target_velocity(0.0)
+        , _remaining(0.0)
+        , _velocity(0.0)
+        , _accel(0.0)
+        , _elapsed(0.0)
+        , _finished(true) {}
+
+    /**
+    * @brief        プロファイルのパラメータの設定
+    * @param[in]    const stMotionProfileConfig& config プロファイルのパラメータ
+    * @return       void
+    */
+    void configure(const stMotionProfileConfig& config)
+    {
+        _config = config;
+        _config.max_velocity = std::fabs(_config.max_velocity);
+        _config.max_accel    = std::max(1e-3, std::fabs(_config.max_accel));
+        _config.max_jerk     = std::max(1e-3, std::fabs(_config.max_jerk));
+        _config.min_velocity = std::min(std::fabs(_config.min_velocity), _config.max_velocity);
+    }
+
+    const stMotionProfileConfig& config() const { return _config; }
+
+    /**
+    * @brief        距離指定の移動開始
+    * @param[in]    double distance 移動距離[m]（負は後退）
+    * @param[in]    double velocity 開始時の速度[m/s]（前進を正）
+    * @return       void
+    */
+    void start(double distance, double velocity = 0.0)
+    {
+        _distance_mode = true;
+        _direction     = (distance < 0) ? -1.0 : 1.0;
+        _distance      = std::fabs(distance);
+        _remaining     = _distance;
+        _velocity      = std::max(0.0, velocity * _direction);
+        _accel         = 0.0;
+        _elapsed       = 0.0;
+        _finished      = (_distance <= _config.tolerance);
+    }
+
+    /**
+    * @brief        速度指定の加減速開始
+    * @param[in]    double velocity 開始時の速度[m/s]（前進を正）
+    * @param[in]    double target 目標速度[m/s]（前進を正）
+    * @return       void
+    */
+    void startVelocity(double velocity, double target)
+    {
+        target = std::max(-_config.max_velocity, std::min(_config.max_velocity, target));
+
+        _distance_mode = false;
+        _direction     = (target < 0 || (target == 0 && velocity < 0)) ? -1.0 : 1.0;
+        _target_velocity = target * _direction;
+        _velocity      = velocity * _direction;
+        _accel         = 0.0;
+        _elapsed       = 0.0;
+        _finished      = (std::fabs(_velocity - _target_velocity) < 1e-6);
+    }
+
+    /**
+    * @brief        速度指令の更新
+    * @param[in]    double travelled 開始位置から進んだ距離[m]（前進を正、速度指定時は無視）
+    * @param[in]    double dt 前回からの経過時間[s]
+    * @return       double 速度指令[m/s]（前進を正）
+    */
+    double update(double travelled, double dt)
+    {
+        if(_finished)
+        {
+            return velocity();
+        }
+        dt = std::max(0.0, dt);
+        _elapsed += dt;
+
+        double target;
+        if(_distance_mode)
+        {
+            _remaining = _distance - travelled * _direction;
+            if(_remaining <= _config.tolerance)
+            { // 到達（行き過ぎを含む）
+                _remaining = std::max(0.0, _remaining);
+                _velocity  = 0.0;
+                _accel     = 0.0;
+                _finished  = true;
+                return 0.0;
+            }
+            target = std::min(_config.max_velocity, brakingVelocity(_remaining));
+            target = std::min(target, _config.kp * _remaining);
+            target = std::max(target, _config.min_velocity);
+        }
+        else
+        {
+            target = _target_velocity;
+        }
+
+        step(target, dt);
+
+        if(!_distance_mode && std::fabs(_velocity - _target_velocity) < 1e-6)
+        {
+            _velocity = _target_velocity;
+            _accel    = 0.0;
+            _finished = true;
+        }
+
+        return velocity();
+    }
+
+    /**
+    * @brief        目標速度への追従（周期毎に目標速度が変わり得る速度指令の整形）
+    * @param[in]    double target 目標速度[m/s]（前進を正）
+    * @param[in]    double dt 前回からの経過時間[s]
+    * @return       double 速度指令[m/s]（前進を正）
+    * @details      startVelocityと異なり現在の加速度を保ったまま目標速度を差し替えるため、
+    *               加減速の途中で目標速度が変わっても加速度は加加速度制限内で連続に変化する
+    */
+    double track(double target, double dt)
+    {
+        if(_distance_mode || _direction < 0)
+        { // 速度・加速度を前進を正とする値に揃えて速度指定に切り替える
+            _velocity *= _direction;
+            _accel    *= _direction;
+            _direction = 1.0;
+            _distance_mode = false;
+        }
+        _target_velocity = std::max(-_config.max_velocity, std::min(_config.max_velocity, target));
+        _finished = false;
+        return update(0.0, dt);
+    }
+
+    bool isFinished() const { return _finished; }
+    double remaining() const { return _remaining * _direction; }
+    double velocity() const { return _velocity * _direction; }
+    double acceleration() const { return _accel * _direction; }
+    double elapsed() const { return _elapsed; }
+
+    /**
+    * @brief        プロファイルの種類の文字列→値
+    * @param[in]    const std::string& name プロファイルの種類（"trapezoidal"/"s_curve"）
+    * @return       int プロファイルの種類（不明な場合はS字）
+    */
+    static int typeFromName(const std::string& name)
+    {
+        return (name == "trapezoidal") ? MOTION_PROFILE_TRAPEZOIDAL : MOTION_PROFILE_S_CURVE;
+    }
+
+private:
+    /**
+    * @brief        残り距離で止まれる速度（減速曲線）
+    * @details      台形：d = v^2/(2A)。S字：減速度の立ち上がりを含め、v >= A^2/J では
+    *               d = v^2/(2A) + v*A/(2J)、それ未満では d = v*sqrt(v/J) を速度について解く
+    */
+    double brakingVelocity(double remaining) const
+    {
+        double a = _config.max_accel;
+        if(_config.type != MOTION_PROFILE_S_CURVE)
+        {
+            return std::sqrt(2.0 * a * remaining);
+        }
+
+        double j = _config.max_jerk;
+        double v_corner = a * a / j;
+        if(remaining < v_corner * std::sqrt(v_corner / j))
+        {
+            return std::cbrt(remaining * remaining * j);
+        }
+        double b = a / (2.0 * j);
+        return a * (-b + std::sqrt(b * b + 2.0 * remaining / a));
+    }
+
+    /**
+    * @brief        目標速度への加減速（1周期分）
+    */
+    void step(double target, double dt)
+    {
+        if(dt <= 0)
+        {
+            return;
+        }
+
+        double a_max = _config.max_accel;
+        double desired = std::max(-a_max, std::min(a_max, (target - _velocity) / dt));
+
+        if(_config.type == MOTION_PROFILE_S_CURVE)
+        {
+            double j_step = _config.max_jerk * dt;
+            // 加速度を戻すのに要する速度変化分を見込み、目標速度を越えないよう早めに加速度を緩める
+            double diff = target - _velocity;
+            double release = _accel * std::fabs(_accel) / (2.0 * _config.max_jerk);
+            if((diff > 0 && release >= diff) || (diff < 0 && release <= diff))
+            {
+                desired = 0.0;
+            }
+            _accel = std::max(_accel - j_step, std::min(_accel + j_step, desired));
+            // 減速中に目標速度を下回りそうな場合（減速曲線に達した後など）は台形と同じく直接合わせる。
+            // 加速度の向きは反転させない（途中で目標速度が変わった場合も加速度の制限を守る）
+            if(_accel < 0 && _velocity + _accel * dt < target)
+            {
+                _accel = std::min(0.0, (target - _velocity) / dt);
+            }
+            if(_accel > 0 && _velocity + _accel * dt > target)
+            {
+                _accel = std::max(0.0, (target - _velocity) / dt);
+            }
+        }
+        else
+        {
+            _accel = desired;
+        }
+
+        _velocity += _accel * dt;
+        if(_distance_mode)
+        { // 距離指定では逆方向へは動かさない
+            _velocity = std::max(0.0, _velocity);
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,101 @@
+/**
+* @file     node_metrics.h
+* @brief    ノードの計測値の集計クラスの定義ヘッダファイル
+* @author   S.Kumada
+* @date     2026/10/18
+* @note     計測値はdiagnostic_msgs/DiagnosticStatusのKeyValueとして配信する
+*/
+
+#ifndef NODE_METRICS_H
+#define NODE_METRICS_H
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <diagnostic_msgs/DiagnosticStatus.h>
+
+/**
+ * @brief 計測値集計クラス
+ * @details キー毎に数値を保持する。複数スレッドからの更新に対応する
+ */
+class NodeMetrics
+{
+private:
+    mutable std::mutex _mutex;              // 排他制御
+    std::map<std::string, double> _values; // キー毎の計測値
+
+public:
+    /**
+    * @brief        計測値の設定
+    * @param[in]    const std::string& key 計測値のキー
+    * @param[in]    double value 計測値
+    * @return       void
+    */
+    void set(const std::string& key, double value)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _values[key] = value;
+    }
+
+    /**
+    * @brief        計測値の加算（カウンタ）
+    * @param[in]    const std::string& key 計測値のキー
+    * @param[in]    double delta 加算値
+    * @return       void
+    */
+    void add(const std::string& key, double delta = 1.0)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _values[key] += delta;
+    }
+
+    /**
+    * @brief        最大値の更新
+    * @param[in]    const std::string& key 計測値のキー
+    * @param[in]    double value 計測値
+    * @return       void
+    */
+    void max(const std::string& key, double value)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        std::map<std::string, double>::iterator ite = _values.find(key);
+        if(ite == _values.end() || ite->second < value)
+        {
+            _values[key] = value;
+        }
+    }
+
+    /**
+    * @brief        計測値の取得
+    * @param[in]    const std::string& key 計測値のキー
+    * @return       double 計測値（未登録の場合は0）
+    */
+    double get(const std::string& key) const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        std::map<std::string, double>::const_iterator ite = _values.find(key);
+        return (ite == _values.end()) ? 0.0 : ite->second;
+    }
+
+    /**
+    * @brief        診断情報への変換
+    * @param[out]   diagnostic_msgs::DiagnosticStatus& status 格納先の診断情報
+    * @return       void
+    */
+    void toDiagnosticStatus(diagnostic_msgs::DiagnosticStatus& status) const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        diagnostic_msgs::KeyValue key_value;
+
+        status.values.clear();
+        status.values.reserve(_values.size());
+        for(std::map<std::string, double>::const_iterator ite = _values.begin(); ite != _values.end(); ite++)
+        {
+            key_value.key   = ite->first;
+            key_value.value = std::to_string(ite->second);
+            status.values.push_back(key_value);
+        }
+    }
+};
+
+#endif
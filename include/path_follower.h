@@ -0,0 +1,487 @@
+/**
+* @file     path_follower.h
+* @brief    経路追従制御（Regulated Pure Pursuit）クラスの定義ヘッダファイル
+* @author   S.Kumada
+* @date     2026/10/18
+* @note     与えられた経路を一定周期の専用スレッドで追従する。
+*           外部ナビゲーションノード（move_base）を使用しない場合の軽量な代替として利用する
+*/
+
+#ifndef PATH_FOLLOWER_H
+#define PATH_FOLLOWER_H
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <time.h>
+#include <vector>
+
+#include "realtime_thread.h"
+#include "utilities.h"
+
+// 追従状態（move_baseのステータス値に合わせる）
+#define     FOLLOWER_STATUS_IDLE        0   // PENDING
+#define     FOLLOWER_STATUS_ACTIVE      1   // ACTIVE
+#define     FOLLOWER_STATUS_SUCCEEDED   3   // SUCCEEDED
+#define     FOLLOWER_STATUS_ABORTED     4   // ABORTED
+
+// 自己位置が取得できない場合に追従を中止するまでの連続失敗回数
+#define     FOLLOWER_POSE_FAILURE_LIMIT 20
+
+// 最近傍点の探索範囲（前回の最近傍点から経路に沿った距離[m]）
+#define     FOLLOWER_CLOSEST_SEARCH_DIST    1.0
+
+/**
+ * @brief 経路追従制御パラメータ
+ */
+typedef struct PathFollowerConfig
+{
+    double control_rate;            // 制御周期[Hz]
+    double desired_linear_vel;      // 目標並進速度[m/s]
+    double lookahead_time;          // 前方注視時間[s]（速度×時間を注視距離とする）
+    double min_lookahead;           // 最小前方注視距離[m]
+    double max_lookahead;           // 最大前方注視距離[m]
+    double max_angular_vel;         // 最大旋回速度[rad/s]
+    double rotate_to_heading_angle; // その場旋回に切り替える注視点との角度差[rad]
+    double regulated_min_radius;    // 減速を開始する旋回半径[m]
+    double approach_dist;           // ゴール手前の減速開始距離[m]
+    double min_approach_vel;        // ゴール手前の最低速度[m/s]
+    double goal_tolerance;          // ゴール到達とみなす距離[m]
+    stRealtimeConfig realtime;      // 制御スレッドのリアルタイム実行設定
+
+    PathFollowerConfig()
+        : control_rate(20.0)
+        , desired_linear_vel(0.25)
+        , lookahead_time(1.5)
+        , min_lookahead(0.3)
+        , max_lookahead(0.9)
+        , max_angular_vel(0.8)
+        , rotate_to_heading_angle(0.785)
+        , regulated_min_radius(0.9)
+        , approach_dist(0.6)
+        , min_approach_vel(0.05)
+        , goal_tolerance(0.05) {}
+
+}stPathFollowerConfig;
+
+/**
+ * @brief 経路追従制御クラス
+ * @details 専用スレッドで一定周期ごとに自己位置を取得し、並進・旋回速度を出力する。
+ *          制御処理のCPU時間と経路からの追従誤差を計測する
+ */
+class PathFollower
+{
+public:
+    typedef std::function<bool(double&, double&, double&)> PoseProvider;    // 自己位置(x, y, yaw)の取得関数
+    typedef std::function<void(double, double)> VelocitySink;               // 速度指令(並進, 旋回)の出力関数
+
+private:
+    stPathFollowerConfig _config;       // 制御パラメータ
+    PoseProvider _pose_provider;        // 自己位置の取得関数
+    VelocitySink _velocity_sink;        // 速度指令の出力関数
+
+    std::thread _thread;                // 制御スレッド
+    mutable std::mutex _mutex;          // 経路・計測値の排他制御
+    std::condition_variable _cond;      // 経路設定通知
+    std::atomic<bool> _running;         // スレッド動作中フラグ
+    std::atomic<int> _status;           // 追従状態
+
+    std::vector<Vector2d> _path;        // 追従経路
+    size_t _closest_idx;                // 経路上の最近傍点のインデックス
+    unsigned long _path_seq;            // 経路の更新番号
+    double _last_linear_vel;            // 前回の並進速度指令
+
+    double _cpu_time_total;             // 制御処理のCPU時間の累計[s]
+    double _tracking_error_last;        // 直近の追従誤差[m]
+    double _tracking_error_max;         // 追従誤差の最大値[m]
+    double _tracking_error_sq_sum;      // 追従誤差の二乗和
+    unsigned long _cycle_count;         // 追従誤差を集計した制御回数
+
+public:
+    /**
+    * @brief        PathFollowerクラスのコンストラクタ
+    */
+    PathFollower()
+        : _running(false)
+        , _status(FOLLOWER_STATUS_IDLE)
+        , _closest_idx(0)
+        , _path_seq(0)
+        , _last_linear_vel(0.0)
+        , _cpu_time_total(0.0)
+        , _tracking_error_last(0.0)
+        , _tracking_error_max(0.0)
+        , _tracking_error_sq_sum(0.0)
+        , _cycle_count(0) {}
+
+    /**
+    * @brief        PathFollowerクラスのデストラクタ
+    */
+    ~PathFollower()
+    {
+        shutdown();
+    }
+
+    /**
+    * @brief        制御スレッドの開始
+    * @param[in]    const stPathFollowerConfig& config 制御パラメータ
+    * @param[in]    PoseProvider pose_provider 自己位置の取得関数
+    * @param[in]    VelocitySink velocity_sink 速度指令の出力関数
+    * @return       void
+    */
+    void start(const stPathFollowerConfig& config, PoseProvider pose_provider, VelocitySink velocity_sink)
+    {
+        if(_running)
+        {
+            return;
+        }
+        _config = config;
+        _pose_provider = pose_provider;
+        _velocity_sink = velocity_sink;
+        _running = true;
+        _thread = std::thread(&PathFollower::controlLoop, this);
+    }
+
+    /**
+    * @brief        制御スレッドの終了
+    * @return       void
+    */
+    void shutdown()
+    {
+        if(!_running)
+        {
+            return;
+        }
+        _running = false;
+        _cond.notify_all();
+        if(_thread.joinable())
+        {
+            _thread.join();
+        }
+    }
+
+    /**
+    * @brief        追従経路の設定（追従開始）
+    * @param[in]    const std::vector<Vector2d>& path 追従経路
+    * @return       void
+    */
+    void setPath(const std::vector<Vector2d>& path)
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _path = path;
+            _closest_idx = 0;
+            _path_seq++;
+            _status = path.empty() ? FOLLOWER_STATUS_IDLE : FOLLOWER_STATUS_ACTIVE;
+        }
+        _cond.notify_all();
+    }
+
+    /**
+    * @brief        追従の中止
+    * @return       void
+    */
+    void cancel()
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _path.clear();
+            _path_seq++;
+            _status = FOLLOWER_STATUS_IDLE;
+        }
+        _cond.notify_all();
+    }
+
+    /**
+    * @brief        追従状態の取得
+    * @return       int 追従状態（FOLLOWER_STATUS_*）
+    */
+    int status() const { return _status; }
+
+    /**
+    * @brief        計測値の取得
+    * @param[out]   double& cpu_time_total 制御処理のCPU時間の累計[s]
+    * @param[out]   double& tracking_error_last 直近の追従誤差[m]
+    * @param[out]   double& tracking_error_rms 追従誤差の二乗平均平方根[m]
+    * @param[out]   double& tracking_error_max 追従誤差の最大値[m]
+    * @return       void
+    */
+    void getStatistics(double& cpu_time_total, double& tracking_error_last, double& tracking_error_rms, double& tracking_error_max) const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        cpu_time_total      = _cpu_time_total;
+        tracking_error_last = _tracking_error_last;
+        tracking_error_rms  = (_cycle_count == 0) ? 0.0 : std::sqrt(_tracking_error_sq_sum / _cycle_count);
+        tracking_error_max  = _tracking_error_max;
+    }
+
+    /**
+    * @brief        速度指令の算出（Regulated Pure Pursuit）
+    * @param[in]    const std::vector<Vector2d>& path 追従経路
+    * @param[in,out] size_t& closest_idx 経路上の最近傍点のインデックス（前回値から前方の一定範囲のみ探索する）
+    * @param[in]    double x, y, yaw 現在の自己位置
+    * @param[in]    double current_vel 現在の並進速度
+    * @param[out]   double& linear_vel 並進速度指令
+    * @param[out]   double& angular_vel 旋回速度指令
+    * @param[out]   double& tracking_error 経路からの追従誤差[m]
+    * @return       bool true:追従中, false:ゴール到達
+    */
+    bool computeVelocity(const std::vector<Vector2d>& path, size_t& closest_idx,
+                         double x, double y, double yaw, double current_vel,
+                         double& linear_vel, double& angular_vel, double& tracking_error) const
+    {
+        Vector2d robot(x, y);
+
+        linear_vel = 0.0;
+        angular_vel = 0.0;
+        tracking_error = 0.0;
+
+        if(path.empty())
+        {
+            return false;
+        }
+
+        // 最近傍点の探索（前回の最近傍点から経路に沿ってFOLLOWER_CLOSEST_SEARCH_DIST[m]先まで）
+        closest_idx = std::min(closest_idx, path.size() - 1);
+        double min_dist = robot.distanceFrom(path[closest_idx]);
+        double searched = 0.0;
+        size_t search_idx = closest_idx + 1;
+        for(; search_idx < path.size() && searched <= FOLLOWER_CLOSEST_SEARCH_DIST; search_idx++)
+        {
+            searched += path[search_idx - 1].distanceFrom(path[search_idx]);
+            double dist = robot.distanceFrom(path[search_idx]);
+            if(dist < min_dist)
+            {
+                min_dist = dist;
+                closest_idx = search_idx;
+            }
+        }
+        if(search_idx < path.size() && min_dist > FOLLOWER_CLOSEST_SEARCH_DIST)
+        { // 探索範囲内に近い点が無い場合（自己位置の補正で大きく飛んだ時など）は残りの経路を全て探索する
+            for(; search_idx < path.size(); search_idx++)
+            {
+                double dist = robot.distanceFrom(path[search_idx]);
+                if(dist < min_dist)
+                {
+                    min_dist = dist;
+                    closest_idx = search_idx;
+                }
+            }
+        }
+
+        // 追従誤差（最近傍点前後の線分までの距離）
+        tracking_error = min_dist;
+        for(size_t i = (closest_idx > 0 ? closest_idx - 1 : 0); i + 1 < path.size() && i <= closest_idx; i++)
+        {
+            tracking_error = std::min(tracking_error, distanceToSegment(robot, path[i], path[i + 1]));
+        }
+
+        // ゴール判定
+        double goal_dist = robot.distanceFrom(path.back());
+        if(goal_dist <= _config.goal_tolerance)
+        {
+            return false;
+        }
+
+        // 前方注視距離
+        double lookahead = std::max(_config.min_lookahead, std::min(_config.max_lookahead, std::fabs(current_vel) * _config.lookahead_time));
+
+        // 注視点の探索
+        Vector2d carrot = path.back();
+        for(size_t i = closest_idx; i < path.size(); i++)
+        {
+            if(robot.distanceFrom(path[i]) >= lookahead)
+            {
+                carrot = path[i];
+                break;
+            }
+        }
+
+        // 注視点をロボット座標系へ変換
+        double dx = carrot.x - x;
+        double dy = carrot.y - y;
+        double local_x =  std::cos(yaw) * dx + std::sin(yaw) * dy;
+        double local_y = -std::sin(yaw) * dx + std::cos(yaw) * dy;
+        double carrot_dist_sq = local_x * local_x + local_y * local_y;
+        double carrot_angle = std::atan2(local_y, local_x);
+
+        if(std::fabs(carrot_angle) > _config.rotate_to_heading_angle)
+        { // 注視点との角度差が大きい場合はその場旋回
+            angular_vel = (carrot_angle > 0 ? 1.0 : -1.0) * _config.max_angular_vel;
+            return true;
+        }
+
+        double curvature = (carrot_dist_sq > DBL_EPSILON) ? 2.0 * local_y / carrot_dist_sq : 0.0;
+
+        // 曲率による減速
+        linear_vel = _config.desired_linear_vel;
+        if(std::fabs(curvature) > DBL_EPSILON)
+        {
+            double radius = 1.0 / std::fabs(curvature);
+            if(radius < _config.regulated_min_radius)
+            {
+                linear_vel *= radius / _config.regulated_min_radius;
+            }
+        }
+
+        // ゴール手前の減速（経路に沿った残距離で判定、減速開始距離に達した時点で打ち切る）
+        double remaining = robot.distanceFrom(path[closest_idx]);
+        for(size_t i = closest_idx; i + 1 < path.size() && remaining < _config.approach_dist; i++)
+        {
+            remaining += path[i].distanceFrom(path[i + 1]);
+        }
+        if(remaining < _config.approach_dist)
+        {
+            linear_vel = std::min(linear_vel, _config.desired_linear_vel * remaining / _config.approach_dist);
+        }
+        linear_vel = std::max(linear_vel, _config.min_approach_vel);
+
+        // 旋回速度
+        angular_vel = linear_vel * curvature;
+        if(std::fabs(angular_vel) > _config.max_angular_vel)
+        { // 旋回速度の上限に合わせて並進速度も落とす
+            linear_vel *= _config.max_angular_vel / std::fabs(angular_vel);
+            angular_vel = (angular_vel > 0 ? 1.0 : -1.0) * _config.max_angular_vel;
+        }
+
+        return true;
+    }
+
+private:
+    /**
+    * @brief        点と線分の距離
+    * @param[in]    const Vector2d& p 点
+    * @param[in]    const Vector2d& a 線分の始点
+    * @param[in]    const Vector2d& b 線分の終点
+    * @return       double 距離
+    */
+    static double distanceToSegment(const Vector2d& p, const Vector2d& a, const Vector2d& b)
+    {
+        Vector2d ab = b - a;
+        double len_sq = ab.lengthSquare();
+        if(len_sq <= DBL_EPSILON)
+        {
+            return p.distanceFrom(a);
+        }
+        double t = std::max(0.0, std::min(1.0, (p - a).dot(ab) / len_sq));
+        return p.distanceFrom(a + ab * t);
+    }
+
+    /**
+    * @brief        スレッドのCPU時間の取得
+    * @return       double CPU時間[s]
+    */
+    static double threadCpuTime()
+    {
+        struct timespec ts;
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+        return ts.tv_sec + ts.tv_nsec * 1e-9;
+    }
+
+    /**
+    * @brief        制御スレッド
+    * @return       void
+    */
+    void controlLoop()
+    {
+        const std::chrono::nanoseconds period(static_cast<long long>(1e9 / _config.control_rate));
+        std::string error;
+        if(!applyRealtimeThread(_config.realtime, error))
+        {
+            ROS_WARN("path follower: realtime setting failed (%s), running with normal priority", error.c_str());
+        }
+        std::vector<Vector2d> path;     // 追従中の経路（スレッド内のコピー）
+        size_t closest_idx = 0;
+        unsigned long path_seq = 0;
+        int pose_failure = 0;
+
+        while(_running)
+        {
+            // 追従経路が設定されるまで待機
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                _cond.wait(lock, [this]{ return !_running || _status == FOLLOWER_STATUS_ACTIVE; });
+                if(!_running)
+                {
+                    break;
+                }
+            }
+
+            std::chrono::steady_clock::time_point next = std::chrono::steady_clock::now();
+            pose_failure = 0;
+
+            while(_running && _status == FOLLOWER_STATUS_ACTIVE)
+            {
+                double cpu_start = threadCpuTime();
+
+                // 経路の更新確認
+                {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    if(path_seq != _path_seq)
+                    {
+                        path = _path;
+                        closest_idx = 0;
+                        path_seq = _path_seq;
+                    }
+                }
+
+                double x, y, yaw;
+                double linear_vel = 0.0, angular_vel = 0.0, tracking_error = 0.0;
+                bool tracked = false;   // 自己位置を取得して追従誤差を求めたか
+                if(_pose_provider(x, y, yaw))
+                {
+                    pose_failure = 0;
+                    tracked = !path.empty();
+                    if(!computeVelocity(path, closest_idx, x, y, yaw, _last_linear_vel, linear_vel, angular_vel, tracking_error))
+                    { // ゴール到達
+                        std::lock_guard<std::mutex> lock(_mutex);
+                        if(path_seq == _path_seq)
+                        {
+                            _status = FOLLOWER_STATUS_SUCCEEDED;
+                        }
+                    }
+                }
+                else if(++pose_failure >= FOLLOWER_POSE_FAILURE_LIMIT)
+                { // 自己位置が取得できない状態が続いた場合は中止
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    if(path_seq == _path_seq)
+                    {
+                        _status = FOLLOWER_STATUS_ABORTED;
+                    }
+                }
+
+                if(_status != FOLLOWER_STATUS_ACTIVE)
+                {
+                    linear_vel = angular_vel = 0.0;
+                }
+                _velocity_sink(linear_vel, angular_vel);
+                _last_linear_vel = linear_vel;
+
+                // 計測値の更新（追従誤差は自己位置を取得して算出した周期のみ集計する）
+                {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    _cpu_time_total += threadCpuTime() - cpu_start;
+                    if(tracked)
+                    {
+                        _tracking_error_last = tracking_error;
+                        _tracking_error_max = std::max(_tracking_error_max, tracking_error);
+                        _tracking_error_sq_sum += tracking_error * tracking_error;
+                        _cycle_count++;
+                    }
+                }
+
+                next += period;
+                std::this_thread::sleep_until(next);
+            }
+
+            // 追従終了・中止時は停止指令
+            _velocity_sink(0.0, 0.0);
+            _last_linear_vel = 0.0;
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,179 @@
+/**
+* @file     pose_cache.h
+* @brief    ロボットの位置・向きのキャッシュクラスの定義ヘッダファイル
+* @author   S.Kumada
+* @date     2026/10/18
+* @note     座標変換の取得を更新周期に1回にまとめ、状態報告・スタック判定・旋回・経路追従などの各処理は
+*           キャッシュ済みの位置を待たずに読み出す。複数スレッドからの読み出しに対応し、取得関数は排他の外で呼び出すため、
+*           座標変換の取得中に他のスレッド（経路追従の制御スレッドなど）の読み出しを待たせない
+*/
+
+#ifndef POSE_CACHE_H
+#define POSE_CACHE_H
+
+#include <cstdint>
+#include <functional>
+#include <mutex>
+
+// キャッシュした位置・向き
+typedef struct CachedPose
+{
+    double x;           // x座標[m]
+    double y;           // y座標[m]
+    double z;           // z座標[m]
+    double roll;        // ロール角[rad]
+    double pitch;       // ピッチ角[rad]
+    double yaw;         // ヨー角[rad]
+    double stamp;       // 座標変換の時刻[s]
+    double updated;     // 取得した時刻[s]（更新周期の判定用）
+
+    CachedPose()
+        : x(0.0), y(0.0), z(0.0), roll(0.0), pitch(0.0), yaw(0.0), stamp(0.0), updated(0.0) {}
+
+}stCachedPose;
+
+/**
+ * @brief 位置・向きのキャッシュクラス
+ * @details get()は前回の取得から更新周期が経過していれば取得関数を1回呼び出して更新し、それ以外は保持中の値を返す。
+ *          取得に失敗した場合は、保持中の値の座標変換の時刻が許容時間内であればその値を返す。
+ *          他のスレッドが取得中の場合は取得を待たず、保持中の値を同じ許容時間の条件で返す
+ */
+class PoseCache
+{
+public:
+    typedef std::function<bool(stCachedPose& pose)> LookupFunction;    // 取得関数（stamp以外の時刻は設定不要）
+
+private:
+    mutable std::mutex _mutex;  // 排他制御
+    stCachedPose _pose;         // 保持中の位置・向き
+    bool _valid;                // 保持中の値があるか
+    bool _looking_up;           // いずれかのスレッドが取得関数を呼び出し中か
+    uint64_t _generation;       // invalidate()の呼び出し回数（取得中に破棄された値を保持しないため）
+    double _period;             // 更新周期[s]
+    double _max_age;            // 取得失敗時に保持中の値を使う座標変換の経過時間の上限[s]
+    uint64_t _lookups;          // 取得関数の呼び出し回数
+    uint64_t _failures;         // 取得失敗の回数
+    uint64_t _hits;             // 取得せずに保持中の値を返した回数
+
+public:
+    /**
+    * @brief        PoseCacheクラスのコンストラクタ
+    * @param[in]    double period 更新周期[s]
+    * @param[in]    double max_age 取得失敗時に保持中の値を使う座標変換の経過時間の上限[s]
+    */
+    PoseCache(double period = 0.05, double max_age = 0.5)
+        : _valid(false)
+        , _looking_up(false)
+        , _generation(0)
+        , _period(period)
+        , _max_age(max_age)
+        , _lookups(0)
+        , _failures(0)
+        , _hits(0) {}
+
+    /**
+    * @brief        更新周期・経過時間の上限の設定
+    * @param[in]    double period 更新周期[s]
+    * @param[in]    double max_age 取得失敗時に保持中の値を使う座標変換の経過時間の上限[s]
+    * @return       void
+    */
+    void configure(double period, double max_age)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _period  = period;
+        _max_age = max_age;
+    }
+
+    /**
+    * @brief        位置・向きの取得
+    * @param[in]    double now 現在時刻[s]（座標変換の時刻と同じ時計）
+    * @param[in]    const LookupFunction& lookup 取得関数
+    * @param[out]   stCachedPose& pose 位置・向き
+    * @return       bool true:取得成功, false:保持中の値が無いか古い
+    */
+    bool get(double now, const LookupFunction& lookup, stCachedPose& pose)
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+
+        if(_valid && now - _pose.updated >= 0 && now - _pose.updated < _period)
+        {
+            _hits++;
+            pose = _pose;
+            return true;
+        }
+        if(_looking_up)
+        { // 他のスレッドが取得中の場合は待たずに保持中の値を返す
+            if(!_valid || now - _pose.stamp > _max_age)
+            {
+                return false;
+            }
+            _hits++;
+            pose = _pose;
+            return true;
+        }
+
+        // 取得関数（座標変換の取得）は排他の外で呼び出す
+        _looking_up = true;
+        _lookups++;
+        uint64_t generation = _generation;
+        lock.unlock();
+        stCachedPose latest;
+        bool found = lookup(latest);
+        lock.lock();
+        _looking_up = false;
+
+        if(generation != _generation)
+        { // 取得中に破棄された（初期位置の変更など）場合は取得した値を使わない
+            return false;
+        }
+
+        if(found)
+        {
+            latest.updated = now;
+            _pose  = latest;
+            _valid = true;
+        }
+        else
+        {
+            _failures++;
+            if(!_valid || now - _pose.stamp > _max_age)
+            {
+                return false;
+            }
+            _pose.updated = now;    // 失敗後も更新周期毎に再取得する
+        }
+
+        pose = _pose;
+        return true;
+    }
+
+    /**
+    * @brief        保持中の値の破棄（次のget()で必ず取得する）
+    * @return       void
+    */
+    void invalidate()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _valid = false;
+        _generation++;
+    }
+
+    /**
+    * @brief        集計値の取得
+    * @param[out]   uint64_t& lookups 取得関数の呼び出し回数
+    * @param[out]   uint64_t& failures 取得失敗の回数
+    * @param[out]   uint64_t& hits 保持中の値を返した回数
+    * @param[out]   double& stamp 保持中の値の座標変換の時刻[s]（値が無い場合は0）
+    * @return       void
+    */
+    void getStatistics(uint64_t& lookups, uint64_t& failures, uint64_t& hits, double& stamp) const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        lookups  = _lookups;
+        failures = _failures;
+        hits     = _hits;
+        stamp    = _valid ? _pose.stamp : 0.0;
+    }
+};
+
+#endif
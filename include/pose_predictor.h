@@ -0,0 +1,308 @@
+/**
+* @file     pose_predictor.h
+* @brief    オドメトリによる地図座標系の位置・向きの予測クラスの定義ヘッダファイル
+* @author   S.Kumada
+* @date     2026/10/18
+* @note     位置推定で補正された地図座標系の位置（更新が遅い）を基準とし、基準の時刻から問い合わせ時刻までの
+*           移動量をオドメトリの履歴（受信済みの範囲）と速度（受信済みの範囲の先、等速の一輪車モデル）から求めて加える。
+*           移動量に応じて広がる位置・向きの不確かさ（標準偏差）も返す。複数スレッドからの呼び出しに対応する
+*/
+
+#ifndef POSE_PREDICTOR_H
+#define POSE_PREDICTOR_H
+
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+
+#include "ring_buffer.h"
+
+#define POSE_PREDICTOR_HISTORY      256     // オドメトリの履歴の保持数（50Hzで約5秒分）
+
+typedef struct PosePredictorConfig
+{
+    double max_extrapolation;       // 受信済みのオドメトリの先を速度で予測する時間の上限[s]
+    double odom_trans_noise;        // オドメトリの並進の誤差率（移動距離に対する標準偏差の割合）
+    double odom_rot_noise;          // オドメトリの旋回の誤差率（旋回量に対する標準偏差の割合）
+    double extrapolation_noise;     // 速度による予測の誤差率（予測した移動量に対する標準偏差の割合）
+
+    PosePredictorConfig()
+        : max_extrapolation(0.5)
+        , odom_trans_noise(0.05)
+        , odom_rot_noise(0.05)
+        , extrapolation_noise(0.5) {}
+
+}stPosePredictorConfig;
+
+// オドメトリ1サンプル（odom座標系）
+typedef struct PredictorOdom
+{
+    double stamp;       // 計測時刻[s]
+    double x;           // x座標[m]
+    double y;           // y座標[m]
+    double yaw;         // 向き[rad]
+    double linear;      // 並進速度[m/s]
+    double angular;     // 旋回速度[rad/s]
+
+}stPredictorOdom;
+
+// 予測した位置・向き（地図座標系）
+typedef struct PredictedPose
+{
+    double x;               // x座標[m]
+    double y;               // y座標[m]
+    double yaw;             // 向き[rad]
+    double stamp;           // 予測した時刻[s]
+    double anchor_age;      // 基準の位置の時刻からの経過時間[s]
+    double extrapolation;   // 受信済みのオドメトリの先を速度で予測した時間[s]（max_extrapolationで制限）
+    double odom_age;        // 最新のオドメトリの時刻からの経過時間[s]
+    double sigma_xy;        // 位置の標準偏差[m]
+    double sigma_yaw;       // 向きの標準偏差[rad]
+
+    PredictedPose()
+        : x(0.0), y(0.0), yaw(0.0), stamp(0.0), anchor_age(0.0), extrapolation(0.0), odom_age(0.0), sigma_xy(0.0), sigma_yaw(0.0) {}
+
+}stPredictedPose;
+
+/**
+ * @brief オドメトリによる位置・向きの予測クラス
+ * @details setAnchor()で地図座標系の位置（位置推定で補正済み）とその時刻を、addOdometry()でオドメトリを与える。
+ *          predict()は基準の時刻と問い合わせ時刻のオドメトリの位置（履歴の補間、または最新の速度で予測）の差を
+ *          基準の位置に加える。位置推定の更新の遅れによらず、オドメトリの周期で位置が更新される
+ */
+class PosePredictor
+{
+private:
+    mutable std::mutex _mutex;              // 排他制御
+    stPosePredictorConfig _config;          // 予測パラメータ
+    RingBuffer<stPredictorOdom> _odom;      // オドメトリの履歴（時刻順）
+    bool _has_anchor;                       // 基準の位置を受け取ったか
+    double _anchor_x;                       // 基準のx座標[m]
+    double _anchor_y;                       // 基準のy座標[m]
+    double _anchor_yaw;                     // 基準の向き[rad]
+    double _anchor_stamp;                   // 基準の時刻[s]
+    double _anchor_var_xy;                  // 基準の位置の分散[m^2]
+    double _anchor_var_yaw;                 // 基準の向きの分散[rad^2]
+
+public:
+    /**
+    * @brief        PosePredictorクラスのコンストラクタ
+    */
+    PosePredictor()
+        : _odom(POSE_PREDICTOR_HISTORY)
+        , _has_anchor(false)
+        , _anchor_x(0.0)
+        , _anchor_y(0.0)
+        , _anchor_yaw(0.0)
+        , _anchor_stamp(0.0)
+        , _anchor_var_xy(0.0)
+        , _anchor_var_yaw(0.0) {}
+
+    /**
+    * @brief        予測パラメータの設定
+    * @param[in]    const stPosePredictorConfig& config 予測パラメータ
+    * @return       void
+    */
+    void configure(const stPosePredictorConfig& config)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _config = config;
+    }
+
+    /**
+    * @brief        基準の位置の設定（時刻が前回より古い場合は無視する）
+    * @param[in]    double x, y, yaw 地図座標系の位置・向き
+    * @param[in]    double stamp 位置の時刻[s]
+    * @return       bool true:更新した, false:古いため無視した
+    */
+    bool setAnchor(double x, double y, double yaw, double stamp)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if(_has_anchor && stamp < _anchor_stamp)
+        {
+            return false;
+        }
+        _anchor_x     = x;
+        _anchor_y     = y;
+        _anchor_yaw   = yaw;
+        _anchor_stamp = stamp;
+        _has_anchor   = true;
+        return true;
+    }
+
+    /**
+    * @brief        基準の位置の不確かさの設定（位置推定の共分散）
+    * @param[in]    double var_xy 位置の分散[m^2]（x・yの大きい方）
+    * @param[in]    double var_yaw 向きの分散[rad^2]
+    * @return       void
+    */
+    void setAnchorVariance(double var_xy, double var_yaw)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _anchor_var_xy  = std::max(0.0, var_xy);
+        _anchor_var_yaw = std::max(0.0, var_yaw);
+    }
+
+    /**
+    * @brief        オドメトリの追加（時刻が最新より古いものは無視する）
+    * @param[in]    const stPredictorOdom& odom オドメトリ
+    * @return       void
+    */
+    void addOdometry(const stPredictorOdom& odom)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if(!_odom.empty() && odom.stamp <= _odom.at(_odom.size() - 1).stamp)
+        {
+            return;
+        }
+        if(_odom.full())
+        {
+            _odom.popFront();
+        }
+        _odom.pushBack(odom);
+    }
+
+    /**
+    * @brief        基準の位置の破棄（初期位置の再設定時など、オドメトリの履歴は残す）
+    * @return       void
+    */
+    void resetAnchor()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _has_anchor = false;
+    }
+
+    /**
+    * @brief        問い合わせ時刻の位置・向きの予測
+    * @param[in]    double now 問い合わせ時刻[s]
+    * @param[out]   stPredictedPose& pose 予測した位置・向き
+    * @return       bool true:予測成功, false:基準の位置またはオドメトリが無い
+    */
+    bool predict(double now, stPredictedPose& pose) const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if(!_has_anchor || _odom.empty())
+        {
+            return false;
+        }
+
+        double extrapolation_anchor, extrapolation_now;
+        stPredictorOdom from = odomAt(_anchor_stamp, extrapolation_anchor);
+        stPredictorOdom to   = odomAt(now, extrapolation_now);
+
+        // 基準の時刻から問い合わせ時刻までの移動量（基準時刻のロボット座標系）
+        double dx_odom = to.x - from.x;
+        double dy_odom = to.y - from.y;
+        double dx =  cos(from.yaw) * dx_odom + sin(from.yaw) * dy_odom;
+        double dy = -sin(from.yaw) * dx_odom + cos(from.yaw) * dy_odom;
+        double dyaw = normalize(to.yaw - from.yaw);
+
+        pose.x     = _anchor_x + cos(_anchor_yaw) * dx - sin(_anchor_yaw) * dy;
+        pose.y     = _anchor_y + sin(_anchor_yaw) * dx + cos(_anchor_yaw) * dy;
+        pose.yaw   = normalize(_anchor_yaw + dyaw);
+        pose.stamp = now;
+        pose.anchor_age    = now - _anchor_stamp;
+        pose.extrapolation = extrapolation_now;
+
+        // 不確かさ：基準の分散＋オドメトリの移動量に比例する誤差＋速度による予測分の誤差
+        const stPredictorOdom& latest = _odom.at(_odom.size() - 1);
+        pose.odom_age = now - latest.stamp;
+        double distance = std::sqrt(dx * dx + dy * dy);
+        double predicted_distance = std::fabs(latest.linear) * (extrapolation_now + extrapolation_anchor);
+        double predicted_rotation = std::fabs(latest.angular) * (extrapolation_now + extrapolation_anchor);
+        double var_xy  = _anchor_var_xy
+                       + square(_config.odom_trans_noise * distance)
+                       + square(_config.extrapolation_noise * predicted_distance);
+        double var_yaw = _anchor_var_yaw
+                       + square(_config.odom_rot_noise * std::fabs(dyaw))
+                       + square(_config.extrapolation_noise * predicted_rotation);
+        pose.sigma_xy  = std::sqrt(var_xy);
+        pose.sigma_yaw = std::sqrt(var_yaw);
+
+        return true;
+    }
+
+private:
+    /**
+    * @brief        指定時刻のオドメトリの位置
+    * @param[in]    double stamp 時刻[s]
+    * @param[out]   double& extrapolation 最新のオドメトリの先を速度で予測した時間[s]
+    * @return       stPredictorOdom 位置（履歴内は前後の補間、最新より先は等速の一輪車モデル、最古より前は最古の位置）
+    */
+    stPredictorOdom odomAt(double stamp, double& extrapolation) const
+    {
+        extrapolation = 0.0;
+        const stPredictorOdom& oldest = _odom.at(0);
+        const stPredictorOdom& latest = _odom.at(_odom.size() - 1);
+
+        if(stamp <= oldest.stamp)
+        {
+            return oldest;
+        }
+        if(stamp >= latest.stamp)
+        {
+            extrapolation = std::min(stamp - latest.stamp, _config.max_extrapolation);
+            return unicycle(latest, extrapolation);
+        }
+
+        // 時刻を挟む2サンプルを二分探索し、線形補間する
+        size_t low = 0, high = _odom.size() - 1;
+        while(high - low > 1)
+        {
+            size_t mid = (low + high) / 2;
+            if(_odom.at(mid).stamp <= stamp)
+            {
+                low = mid;
+            }
+            else
+            {
+                high = mid;
+            }
+        }
+        const stPredictorOdom& a = _odom.at(low);
+        const stPredictorOdom& b = _odom.at(high);
+        double ratio = (stamp - a.stamp) / (b.stamp - a.stamp);
+
+        stPredictorOdom odom = a;
+        odom.stamp = stamp;
+        odom.x     = a.x + (b.x - a.x) * ratio;
+        odom.y     = a.y + (b.y - a.y) * ratio;
+        odom.yaw   = normalize(a.yaw + normalize(b.yaw - a.yaw) * ratio);
+        return odom;
+    }
+
+    /**
+    * @brief        等速の一輪車モデルによる位置の予測
+    */
+    static stPredictorOdom unicycle(const stPredictorOdom& odom, double dt)
+    {
+        stPredictorOdom result = odom;
+        result.stamp += dt;
+        if(std::fabs(odom.angular) < 1e-6)
+        {
+            result.x += odom.linear * cos(odom.yaw) * dt;
+            result.y += odom.linear * sin(odom.yaw) * dt;
+        }
+        else
+        {
+            double radius = odom.linear / odom.angular;
+            double yaw = odom.yaw + odom.angular * dt;
+            result.x  += radius * (sin(yaw) - sin(odom.yaw));
+            result.y  += radius * (cos(odom.yaw) - cos(yaw));
+            result.yaw = normalize(yaw);
+        }
+        return result;
+    }
+
+    static double normalize(double angle)
+    {
+        return atan2(sin(angle), cos(angle));
+    }
+
+    static double square(double value)
+    {
+        return value * value;
+    }
+};
+
+#endif
@@ -0,0 +1,226 @@
+/**
+* @file     realtime_thread.h
+* @brief    制御スレッドのリアルタイム実行設定（SCHED_FIFO・CPU固定・メモリロック）の定義ヘッダファイル
+* @author   S.Kumada
+* @date     2026/10/18
+* @note     Linuxのみ有効。権限（CAP_SYS_NICE・CAP_IPC_LOCKまたはrtprio/memlockのulimit）が無い場合は
+*           設定に失敗した旨を返し、通常の優先度のまま動作を続ける
+*/
+
+#ifndef REALTIME_THREAD_H
+#define REALTIME_THREAD_H
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#ifdef __linux__
+#include <malloc.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#define REALTIME_STACK_PREFAULT     (64 * 1024)     // スレッド開始時に確保済みにするスタックサイズ[byte]
+#define JITTER_HISTOGRAM_BINS       1000            // 遅れのヒストグラムの区間数
+#define JITTER_HISTOGRAM_RESOLUTION 10e-6           // 遅れのヒストグラムの区間幅[s]（10us刻みで10msまで）
+
+typedef struct RealtimeConfig
+{
+    bool enable;            // リアルタイム実行を行うか
+    int priority;           // SCHED_FIFOの優先度（1~99）
+    int cpu;                // 固定するCPU番号（-1:固定しない）
+
+    RealtimeConfig()
+        : enable(false)
+        , priority(80)
+        , cpu(-1) {}
+
+}stRealtimeConfig;
+
+/**
+* @brief        呼び出したスレッドのリアルタイム実行設定（SCHED_FIFO・CPU固定）
+* @param[in]    const stRealtimeConfig& config リアルタイム実行設定
+* @param[out]   std::string& error 失敗時の理由
+* @return       bool true:設定成功（無効時も含む）, false:一部または全ての設定に失敗
+*/
+inline bool applyRealtimeThread(const stRealtimeConfig& config, std::string& error)
+{
+    error.clear();
+    if(!config.enable)
+    {
+        return true;
+    }
+
+#ifdef __linux__
+    bool ret = true;
+
+    if(config.cpu >= 0)
+    {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(config.cpu, &cpus);
+        int err = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+        if(err != 0)
+        {
+            error += std::string("affinity: ") + strerror(err) + " ";
+            ret = false;
+        }
+    }
+
+    struct sched_param param;
+    memset(&param, 0, sizeof(param));
+    param.sched_priority = std::max(sched_get_priority_min(SCHED_FIFO),
+                                    std::min(sched_get_priority_max(SCHED_FIFO), config.priority));
+    int err = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+    if(err != 0)
+    {
+        error += std::string("SCHED_FIFO: ") + strerror(err);
+        ret = false;
+    }
+
+    // スタックを確保済みにし、制御周期中のページフォルトを避ける
+    volatile char stack[REALTIME_STACK_PREFAULT];
+    for(size_t i = 0; i < sizeof(stack); i += 4096)
+    {
+        stack[i] = 0;
+    }
+
+    return ret;
+#else
+    error = "not supported on this platform";
+    return false;
+#endif
+}
+
+/**
+* @brief        プロセスのメモリロックとヒープの事前確保
+* @param[in]    size_t heap_prefault 事前に確保しておくヒープサイズ[byte]
+* @param[out]   std::string& error 失敗時の理由
+* @return       bool true:成功, false:失敗
+* @details      以降の確保分も含めて物理メモリに固定し（mlockall）、ヒープを返却しない設定にした上で
+*               指定サイズを確保・書き込み・解放しておく。以降の確保はこの領域から行われページフォルトが起きない
+*/
+inline bool lockProcessMemory(size_t heap_prefault, std::string& error)
+{
+    error.clear();
+
+#ifdef __linux__
+    // 解放したヒープをOSへ返さない・大きな確保もmmapを使わずヒープから行う
+    mallopt(M_TRIM_THRESHOLD, -1);
+    mallopt(M_MMAP_MAX, 0);
+
+    if(mlockall(MCL_CURRENT | MCL_FUTURE) != 0)
+    {
+        error = std::string("mlockall: ") + strerror(errno);
+        return false;
+    }
+
+    if(heap_prefault > 0)
+    {
+        char* heap = static_cast<char*>(malloc(heap_prefault));
+        if(heap == NULL)
+        {
+            error = "heap prefault: out of memory";
+            return false;
+        }
+        long page = sysconf(_SC_PAGESIZE);
+        for(size_t i = 0; i < heap_prefault; i += (page > 0 ? page : 4096))
+        {
+            heap[i] = 0;
+        }
+        free(heap);
+    }
+
+    return true;
+#else
+    (void)heap_prefault;
+    error = "not supported on this platform";
+    return false;
+#endif
+}
+
+/**
+ * @brief 周期処理の遅れの集計クラス
+ * @details 遅れを固定幅の区間のヒストグラムで数え、集計中にメモリ確保を行わずにパーセンタイルを求める。
+ *          範囲を超えた遅れは最後の区間に数える（最大値は別に保持する）
+ */
+class JitterHistogram
+{
+private:
+    uint64_t _bins[JITTER_HISTOGRAM_BINS];  // 区間毎の回数
+    uint64_t _count;                        // 集計数
+    double _sum;                            // 遅れの合計[s]
+    double _max;                            // 遅れの最大値[s]
+
+public:
+    /**
+    * @brief        JitterHistogramクラスのコンストラクタ
+    */
+    JitterHistogram()
+    {
+        clear();
+    }
+
+    /**
+    * @brief        集計の破棄
+    * @return       void
+    */
+    void clear()
+    {
+        memset(_bins, 0, sizeof(_bins));
+        _count = 0;
+        _sum = 0.0;
+        _max = 0.0;
+    }
+
+    /**
+    * @brief        遅れの追加
+    * @param[in]    double late 遅れ[s]（負は0とする）
+    * @return       void
+    */
+    void add(double late)
+    {
+        late = std::max(0.0, late);
+        int bin = std::min(JITTER_HISTOGRAM_BINS - 1, (int)(late / JITTER_HISTOGRAM_RESOLUTION));
+        _bins[bin]++;
+        _count++;
+        _sum += late;
+        _max = std::max(_max, late);
+    }
+
+    /**
+    * @brief        パーセンタイルの取得
+    * @param[in]    double ratio 割合（0~1）
+    * @return       double 遅れ[s]（区間の上端）
+    */
+    double percentile(double ratio) const
+    {
+        if(_count == 0)
+        {
+            return 0.0;
+        }
+        uint64_t rank = (uint64_t)std::ceil(ratio * _count);
+        uint64_t sum = 0;
+        for(int i = 0; i < JITTER_HISTOGRAM_BINS; i++)
+        {
+            sum += _bins[i];
+            if(sum >= rank)
+            {
+                return std::min(_max, (i + 1) * JITTER_HISTOGRAM_RESOLUTION);
+            }
+        }
+        return _max;
+    }
+
+    uint64_t count() const { return _count; }
+    double mean() const { return (_count > 0) ? _sum / _count : 0.0; }
+    double max() const { return _max; }
+};
+
+#endif
@@ -0,0 +1,129 @@
+/**
+* @file     ring_buffer.h
+* @brief    固定長リングバッファの定義ヘッダファイル
+* @author   S.Kumada
+* @date     2026/10/18
+* @note     生成時に領域を確保し、以降の追加・削除ではメモリ確保を行わない
+*/
+
+#ifndef RING_BUFFER_H
+#define RING_BUFFER_H
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * @brief 固定長リングバッファクラス
+ * @details 先頭・末尾の両方から追加でき、先頭から取り出す（両端キュー）
+ */
+template <typename T>
+class RingBuffer
+{
+private:
+    std::vector<T> _buffer; // 要素の格納領域（生成時に確保）
+    size_t _head;           // 先頭要素のインデックス
+    size_t _count;          // 格納済み要素数
+
+public:
+    /**
+    * @brief        RingBufferクラスのコンストラクタ
+    * @param[in]    size_t capacity 最大格納数
+    */
+    explicit RingBuffer(size_t capacity = 0)
+        : _buffer(capacity)
+        , _head(0)
+        , _count(0) {}
+
+    /**
+    * @brief        格納領域の再確保（格納済みの要素は破棄する）
+    * @param[in]    size_t capacity 最大格納数
+    * @return       void
+    */
+    void reserve(size_t capacity)
+    {
+        _buffer.assign(capacity, T());
+        _head = 0;
+        _count = 0;
+    }
+
+    /**
+    * @brief        末尾への追加
+    * @param[in]    const T& item 追加する要素
+    * @return       bool true:追加成功, false:満杯
+    */
+    bool pushBack(const T& item)
+    {
+        if(full())
+        {
+            return false;
+        }
+        _buffer[(_head + _count) % _buffer.size()] = item;
+        _count++;
+
+        return true;
+    }
+
+    /**
+    * @brief        先頭への追加
+    * @param[in]    const T& item 追加する要素
+    * @return       bool true:追加成功, false:満杯
+    */
+    bool pushFront(const T& item)
+    {
+        if(full())
+        {
+            return false;
+        }
+        _head = (_head + _buffer.size() - 1) % _buffer.size();
+        _buffer[_head] = item;
+        _count++;
+
+        return true;
+    }
+
+    /**
+    * @brief        先頭要素の削除
+    * @return       void
+    */
+    void popFront()
+    {
+        if(empty())
+        {
+            return;
+        }
+        _head = (_head + 1) % _buffer.size();
+        _count--;
+    }
+
+    /**
+    * @brief        先頭要素の参照
+    * @return       T& 先頭要素
+    */
+    T& front() { return _buffer[_head]; }
+    const T& front() const { return _buffer[_head]; }
+
+    /**
+    * @brief        先頭から数えてidx番目の要素の参照
+    * @param[in]    size_t idx 先頭からのインデックス
+    * @return       T& 要素
+    */
+    T& at(size_t idx) { return _buffer[(_head + idx) % _buffer.size()]; }
+    const T& at(size_t idx) const { return _buffer[(_head + idx) % _buffer.size()]; }
+
+    /**
+    * @brief        全要素の削除（格納領域は保持する）
+    * @return       void
+    */
+    void clear()
+    {
+        _head = 0;
+        _count = 0;
+    }
+
+    size_t size() const { return _count; }
+    size_t capacity() const { return _buffer.size(); }
+    bool empty() const { return _count == 0; }
+    bool full() const { return _count >= _buffer.size(); }
+};
+
+#endif
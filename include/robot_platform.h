@@ -0,0 +1,210 @@
+/**
+* @file     robot_platform.h
+* @brief    ロボットの機種毎の差異（バッテリー電圧・速度制限・フレーム名・footprint）のポリシー定義ヘッダファイル
+* @author   S.Kumada
+* @date     2026/10/18
+* @note     機種毎の処理はポリシー（静的メンバのみの構造体）で定義し、受信処理などはポリシーを型引数とする
+*           テンプレートとしてコンパイル時に展開する。実行時の選択は起動時に機種名でレジストリを引いて一度だけ行う。
+*           新しい機種はポリシーを定義し、addBuiltinRobotPlatforms()に追加する
+*/
+
+#ifndef ROBOT_PLATFORM_H
+#define ROBOT_PLATFORM_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <sensor_msgs/BatteryState.h>
+#include <std_msgs/Int16MultiArray.h>
+
+#define ROBOT_PLATFORM_FALLBACK     "megarover" // 未登録の機種名の場合に用いる機種（従来の動作に合わせる）
+#define MR_VOLTAGE_FACTOR           137.8       // メガローバー 電圧係数
+
+// footprintの頂点
+typedef struct PlatformPoint
+{
+    double x;   // x座標[m]
+    double y;   // y座標[m]
+
+}stPlatformPoint;
+
+// 速度制限
+typedef struct PlatformLimits
+{
+    double max_linear_vel;      // 最大並進速度[m/s]
+    double max_linear_accel;    // 最大並進加速度[m/s^2]
+    double max_angular_vel;     // 最大旋回速度[rad/s]
+
+}stPlatformLimits;
+
+//------------------------------------------------------------------------------
+//  Turtlebot3
+//------------------------------------------------------------------------------
+/**
+ * @brief Turtlebot3のポリシー
+ * @details バッテリー電圧はsensor_msgs/BatteryStateのvoltageをそのまま用いる
+ */
+struct TurtlebotPlatform
+{
+    typedef sensor_msgs::BatteryState BatteryMsg;   // バッテリー情報のメッセージ型
+
+    static const char* name()           { return "turtlebot"; }
+    static const char* batteryTopic()   { return "battery_state"; }
+    static const char* velocityTopic()  { return "cmd_vel"; }
+    static const char* baseFrame()      { return "base_footprint"; }
+
+    static stPlatformLimits limits()
+    {
+        stPlatformLimits limits = { 0.22, 0.5, 2.84 };
+        return limits;
+    }
+
+    static std::vector<stPlatformPoint> footprint()
+    {
+        static const stPlatformPoint points[] = {{-0.205, -0.155}, {-0.205, 0.155}, {0.077, 0.0155}, {0.077, -0.0155}};
+        return std::vector<stPlatformPoint>(points, points + sizeof(points) / sizeof(points[0]));
+    }
+
+    /**
+    * @brief        バッテリー電圧の取得
+    * @param[in]    const BatteryMsg& msg バッテリー情報
+    * @param[out]   float& voltage 電圧[V]
+    * @return       bool true:取得成功, false:取得失敗
+    */
+    static bool decodeBattery(const BatteryMsg& msg, float& voltage)
+    {
+        voltage = msg.voltage;
+        return true;
+    }
+};
+
+//------------------------------------------------------------------------------
+//  メガローバー
+//------------------------------------------------------------------------------
+/**
+ * @brief メガローバーのポリシー
+ * @details バッテリー電圧はrover_sensorの10番目の値を電圧係数で割って求める
+ */
+struct MegaroverPlatform
+{
+    typedef std_msgs::Int16MultiArray BatteryMsg;   // バッテリー情報のメッセージ型
+
+    static const char* name()           { return "megarover"; }
+    static const char* batteryTopic()   { return "rover_sensor"; }
+    static const char* velocityTopic()  { return "rover_twist"; }
+    static const char* baseFrame()      { return "base_footprint"; }
+
+    static stPlatformLimits limits()
+    {
+        stPlatformLimits limits = { 1.0, 1.0, 2.0 };
+        return limits;
+    }
+
+    static std::vector<stPlatformPoint> footprint()
+    {
+        static const stPlatformPoint points[] = {{-0.300, 0.175}, {-0.300, -0.175}, {0.150, -0.175}, {0.150, 0.175}};
+        return std::vector<stPlatformPoint>(points, points + sizeof(points) / sizeof(points[0]));
+    }
+
+    /**
+    * @brief        バッテリー電圧の取得
+    * @param[in]    const BatteryMsg& msg バッテリー情報
+    * @param[out]   float& voltage 電圧[V]
+    * @return       bool true:取得成功, false:取得失敗（要素数不足）
+    */
+    static bool decodeBattery(const BatteryMsg& msg, float& voltage)
+    {
+        if(msg.data.size() < 10)
+        {
+            return false;
+        }
+        voltage = msg.data[9] / MR_VOLTAGE_FACTOR;
+        return true;
+    }
+};
+
+//------------------------------------------------------------------------------
+//  機種のレジストリ
+//------------------------------------------------------------------------------
+/**
+ * @brief 機種名からポリシーを選択するレジストリ
+ * @details 機種名毎にポリシーで展開した関数を登録しておき、bind()で該当するポリシーを型引数として
+ *          Binder::bindPlatform<Platform>()を呼び出す。Binderは受け取ったポリシーで受信処理の登録や
+ *          デフォルト値の設定を行う（以降の処理は実行時の分岐を含まない）
+ */
+template<class Binder>
+class RobotPlatformRegistry
+{
+private:
+    typedef void (*BindFunction)(Binder&);
+    std::map<std::string, BindFunction> _platforms;     // 機種名毎の設定関数
+
+public:
+    /**
+    * @brief        機種の登録
+    * @return       void
+    */
+    template<class Platform>
+    void add()
+    {
+        _platforms[Platform::name()] = &RobotPlatformRegistry::bindPlatform<Platform>;
+    }
+
+    /**
+    * @brief        機種名に該当するポリシーの適用
+    * @param[in]    const std::string& name 機種名
+    * @param[in]    Binder& binder 適用先
+    * @return       bool true:適用した, false:未登録の機種名
+    */
+    bool bind(const std::string& name, Binder& binder) const
+    {
+        typename std::map<std::string, BindFunction>::const_iterator it = _platforms.find(name);
+        if(it == _platforms.end())
+        {
+            return false;
+        }
+        it->second(binder);
+        return true;
+    }
+
+private:
+    template<class Platform>
+    static void bindPlatform(Binder& binder)
+    {
+        binder.template bindPlatform<Platform>();
+    }
+};
+
+/**
+* @brief        組み込みの機種の登録
+* @param[out]   RobotPlatformRegistry<Binder>& registry 登録先
+* @return       void
+*/
+template<class Binder>
+void addBuiltinRobotPlatforms(RobotPlatformRegistry<Binder>& registry)
+{
+    registry.template add<TurtlebotPlatform>();
+    registry.template add<MegaroverPlatform>();
+}
+
+/**
+* @brief        機種名に該当するポリシーの適用（未登録の場合はROBOT_PLATFORM_FALLBACKを適用）
+* @param[in]    const std::string& name 機種名
+* @param[in]    Binder& binder 適用先
+* @return       bool true:機種名に該当した, false:未登録のためROBOT_PLATFORM_FALLBACKを適用した
+*/
+template<class Binder>
+bool bindRobotPlatform(const std::string& name, Binder& binder)
+{
+    RobotPlatformRegistry<Binder> registry;
+    addBuiltinRobotPlatforms(registry);
+    if(registry.bind(name, binder))
+    {
+        return true;
+    }
+    registry.bind(ROBOT_PLATFORM_FALLBACK, binder);
+    return false;
+}
+
+#endif
@@ -0,0 +1,109 @@
+/**
+* @file     spsc_ring.h
+* @brief    単一生産者・単一消費者のロックフリーリングバッファの定義ヘッダファイル
+* @author   S.Kumada
+* @date     2026/10/18
+* @note     追加するスレッドと取り出すスレッドがそれぞれ1つの場合に限り、排他制御なしで使用できる
+*/
+
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+/**
+ * @brief 単一生産者・単一消費者のロックフリーリングバッファクラス
+ * @details 容量は2のべき乗に切り上げる。満杯時の追加は失敗し、古い要素は上書きしない。
+ *          書き込み位置は生産者のみ、読み出し位置は消費者のみが更新する
+ */
+template <typename T>
+class SpscRing
+{
+private:
+    std::vector<T> _buffer;             // 要素の格納領域（生成時に確保）
+    size_t _mask;                       // インデックスのマスク（容量 - 1）
+    std::atomic<size_t> _write_index;   // 書き込み位置（生産者が更新）
+    std::atomic<size_t> _read_index;    // 読み出し位置（消費者が更新）
+
+public:
+    /**
+    * @brief        SpscRingクラスのコンストラクタ
+    * @param[in]    size_t capacity 最大格納数（2のべき乗に切り上げる）
+    */
+    explicit SpscRing(size_t capacity = 64)
+        : _mask(0)
+        , _write_index(0)
+        , _read_index(0)
+    {
+        reserve(capacity);
+    }
+
+    /**
+    * @brief        格納領域の再確保（生産者・消費者がともに停止している時のみ呼び出すこと）
+    * @param[in]    size_t capacity 最大格納数（2のべき乗に切り上げる）
+    * @return       void
+    */
+    void reserve(size_t capacity)
+    {
+        size_t size = 2;
+        while(size < capacity)
+        {
+            size <<= 1;
+        }
+        _buffer.assign(size, T());
+        _mask = size - 1;
+        _write_index.store(0, std::memory_order_relaxed);
+        _read_index.store(0, std::memory_order_relaxed);
+    }
+
+    /**
+    * @brief        要素の追加（生産者側）
+    * @param[in]    const T& item 追加する要素
+    * @return       bool true:追加成功, false:満杯
+    */
+    bool push(const T& item)
+    {
+        size_t write = _write_index.load(std::memory_order_relaxed);
+        if(write - _read_index.load(std::memory_order_acquire) > _mask)
+        {
+            return false;
+        }
+        _buffer[write & _mask] = item;
+        _write_index.store(write + 1, std::memory_order_release);
+
+        return true;
+    }
+
+    /**
+    * @brief        要素の取り出し（消費者側）
+    * @param[out]   T& item 取り出した要素
+    * @return       bool true:取り出し成功, false:空
+    */
+    bool pop(T& item)
+    {
+        size_t read = _read_index.load(std::memory_order_relaxed);
+        if(read == _write_index.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+        item = _buffer[read & _mask];
+        _read_index.store(read + 1, std::memory_order_release);
+
+        return true;
+    }
+
+    /**
+    * @brief        格納済みの要素を全て破棄（消費者側）
+    * @return       void
+    */
+    void drain()
+    {
+        _read_index.store(_write_index.load(std::memory_order_acquire), std::memory_order_release);
+    }
+
+    size_t capacity() const { return _buffer.size(); }
+};
+
+#endif
@@ -0,0 +1,282 @@
+/**
+* @file     stuck_detector.h
+* @brief    位置の履歴によるスタック判定クラスの定義ヘッダファイル
+* @author   S.Kumada
+* @date     2026/10/18
+* @note     時刻付きの位置をロックフリーリングバッファで受け取り、複数の時間窓で
+*           目的地への前進量・移動距離と変位の比・旋回の向きから停滞度を求める
+*/
+
+#ifndef STUCK_DETECTOR_H
+#define STUCK_DETECTOR_H
+
+#include <algorithm>
+#include <cmath>
+
+#include "ring_buffer.h"
+#include "spsc_ring.h"
+
+#define STUCK_WINDOW_MAX    4       // 時間窓の最大数
+
+typedef struct StuckSample
+{
+    double time;    // 時刻[s]
+    double x;       // x座標[m]
+    double y;       // y座標[m]
+    double yaw;     // 向き[rad]
+
+    StuckSample() : time(0.0), x(0.0), y(0.0), yaw(0.0) {}
+    StuckSample(double t, double px, double py, double pyaw) : time(t), x(px), y(py), yaw(pyaw) {}
+
+}stStuckSample;
+
+typedef struct StuckDetectorConfig
+{
+    double windows[STUCK_WINDOW_MAX];   // 時間窓の長さ[s]
+    int window_count;                   // 時間窓の数
+    double sample_period;               // 位置の取得周期[s]
+    double min_speed;                   // 走行中とみなす最低前進速度[m/s]
+    double min_yaw_rate;                // 意図した旋回とみなす最低旋回速度[rad/s]
+    double confidence;                  // スタックと判定する停滞度（0~1）
+    double cooldown;                    // 判定後に再判定を行わない時間[s]
+
+    StuckDetectorConfig()
+        : window_count(3)
+        , sample_period(0.1)
+        , min_speed(0.05)
+        , min_yaw_rate(0.1)
+        , confidence(0.8)
+        , cooldown(5.0)
+    {
+        windows[0] = 1.0;
+        windows[1] = 1.5;
+        windows[2] = 2.5;
+        windows[3] = 0.0;
+    }
+
+}stStuckDetectorConfig;
+
+typedef struct StuckEvaluation
+{
+    double confidence;      // 停滞度（時間窓毎の値の平均、0~1）
+    double progress;        // 最長の時間窓での目的地への前進量[m]
+    double displacement;    // 最長の時間窓での変位[m]
+    double path_length;     // 最長の時間窓での移動距離[m]
+    double oscillation;     // 時間窓毎の往復度（1 - 変位/移動距離）の最大値
+
+    StuckEvaluation()
+        : confidence(0.0)
+        , progress(0.0)
+        , displacement(0.0)
+        , path_length(0.0)
+        , oscillation(0.0) {}
+
+}stStuckEvaluation;
+
+/**
+ * @brief スタック判定クラス
+ * @details push()は位置の取得側（生産者、オドメトリの受信スレッドなど）、update()・reset()は判定側（消費者）から呼び出す。
+ *          生産者・消費者はそれぞれ1スレッドに限る。
+ *          時間窓毎の停滞度は「前進していない度合い」×「動いていない・往復している度合い」×
+ *          「意図した旋回ではない度合い」とし、全ての時間窓の平均が設定値以上でスタックと判定する。
+ *          判定後は履歴を破棄し、一定時間経過後に再び判定を行う
+ */
+class StuckDetector
+{
+private:
+    stStuckDetectorConfig _config;          // 判定パラメータ
+    SpscRing<stStuckSample> _input;         // 取得した位置（生産者→消費者）
+    RingBuffer<stStuckSample> _history;     // 判定に使用する位置の履歴（消費者のみ参照）
+    stStuckEvaluation _evaluation;          // 直近の判定結果
+    double _longest_window;                 // 最長の時間窓[s]
+    double _rearm_time;                     // 再判定を開始する時刻[s]
+
+public:
+    /**
+    * @brief        StuckDetectorクラスのコンストラクタ
+    */
+    StuckDetector()
+        : _longest_window(0.0)
+        , _rearm_time(0.0)
+    {
+        configure(_config);
+    }
+
+    /**
+    * @brief        判定パラメータの設定（位置の取得・判定の停止中に呼び出すこと）
+    * @param[in]    const stStuckDetectorConfig& config 判定パラメータ
+    * @return       void
+    */
+    void configure(const stStuckDetectorConfig& config)
+    {
+        _config = config;
+        _config.window_count = std::max(1, std::min(STUCK_WINDOW_MAX, _config.window_count));
+        _config.sample_period = std::max(0.01, _config.sample_period);
+
+        _longest_window = 0.0;
+        for(int i = 0; i < _config.window_count; i++)
+        {
+            _longest_window = std::max(_longest_window, _config.windows[i]);
+        }
+
+        size_t capacity = (size_t)std::ceil(_longest_window / _config.sample_period) * 2 + 8;
+        _input.reserve(capacity);
+        _history.reserve(capacity);
+        _evaluation = stStuckEvaluation();
+        _rearm_time = 0.0;
+    }
+
+    const stStuckDetectorConfig& config() const { return _config; }
+
+    /**
+    * @brief        位置の追加（生産者側）
+    * @param[in]    const stStuckSample& sample 時刻付きの位置
+    * @return       bool true:追加成功, false:判定側の取り出し遅れで破棄
+    */
+    bool push(const stStuckSample& sample)
+    {
+        return _input.push(sample);
+    }
+
+    /**
+    * @brief        履歴の破棄（判定の開始・再開時に消費者側から呼び出す）
+    * @return       void
+    */
+    void reset()
+    {
+        _input.drain();
+        _history.clear();
+        _evaluation = stStuckEvaluation();
+        _rearm_time = 0.0;
+    }
+
+    /**
+    * @brief        スタック判定（消費者側）
+    * @param[in]    double now 現在時刻[s]
+    * @param[in]    bool has_goal 目的地の有無（無い場合は前進量を判定に用いない）
+    * @param[in]    double goal_x, goal_y 目的地の座標
+    * @return       bool true:スタックと判定
+    */
+    bool update(double now, bool has_goal, double goal_x, double goal_y)
+    {
+        // 取得済みの位置を履歴へ移し、最長の時間窓より古い位置を捨てる
+        stStuckSample sample;
+        while(_input.pop(sample))
+        {
+            if(_history.full())
+            {
+                _history.popFront();
+            }
+            _history.pushBack(sample);
+        }
+        while(_history.size() > 1 && _history.at(1).time <= now - _longest_window)
+        {
+            _history.popFront();
+        }
+
+        if(now < _rearm_time)
+        {
+            return false;
+        }
+
+        stStuckEvaluation evaluation;
+        double score_sum = 0.0;
+        for(int i = 0; i < _config.window_count; i++)
+        {
+            double progress, displacement, path_length, oscillation;
+            score_sum += evaluateWindow(now, _config.windows[i], has_goal, goal_x, goal_y,
+                                        progress, displacement, path_length, oscillation);
+            evaluation.oscillation = std::max(evaluation.oscillation, oscillation);
+            if(_config.windows[i] >= _longest_window)
+            {
+                evaluation.progress     = progress;
+                evaluation.displacement = displacement;
+                evaluation.path_length  = path_length;
+            }
+        }
+        evaluation.confidence = score_sum / _config.window_count;
+        _evaluation = evaluation;
+
+        if(evaluation.confidence < _config.confidence)
+        {
+            return false;
+        }
+
+        // 同じ停滞で繰り返し判定しないよう、履歴を捨てて一定時間判定を止める
+        _history.clear();
+        _rearm_time = now + _config.cooldown;
+
+        return true;
+    }
+
+    const stStuckEvaluation& evaluation() const { return _evaluation; }
+
+private:
+    /**
+    * @brief        時間窓の停滞度の算出
+    * @return       double 停滞度（0~1、履歴が時間窓に満たない場合は0）
+    */
+    double evaluateWindow(double now, double window, bool has_goal, double goal_x, double goal_y,
+                          double& progress, double& displacement, double& path_length, double& oscillation) const
+    {
+        progress = displacement = path_length = oscillation = 0.0;
+
+        // 時間窓の始点を含む履歴が無い場合は判定しない
+        if(window <= 0 || _history.size() < 2 || _history.front().time > now - window + _config.sample_period)
+        {
+            return 0.0;
+        }
+
+        size_t first = 0;
+        while(first + 1 < _history.size() && _history.at(first + 1).time <= now - window)
+        {
+            first++;
+        }
+
+        double yaw_path = 0.0;
+        double yaw_net  = 0.0;
+        for(size_t i = first + 1; i < _history.size(); i++)
+        {
+            const stStuckSample& prev = _history.at(i - 1);
+            const stStuckSample& curr = _history.at(i);
+            double dyaw = std::atan2(std::sin(curr.yaw - prev.yaw), std::cos(curr.yaw - prev.yaw));
+            path_length += std::hypot(curr.x - prev.x, curr.y - prev.y);
+            yaw_path += std::fabs(dyaw);
+            yaw_net  += dyaw;
+        }
+
+        const stStuckSample& start = _history.at(first);
+        const stStuckSample& end   = _history.at(_history.size() - 1);
+        displacement = std::hypot(end.x - start.x, end.y - start.y);
+        if(has_goal)
+        {
+            progress = std::hypot(goal_x - start.x, goal_y - start.y) - std::hypot(goal_x - end.x, goal_y - end.y);
+        }
+
+        double expected = _config.min_speed * window;
+        if(path_length > expected * 0.5)
+        {
+            oscillation = clamp(1.0 - displacement / path_length);
+        }
+
+        double no_progress = has_goal ? clamp(1.0 - progress / expected) : 1.0;
+        double stalled     = std::max(clamp(1.0 - displacement / expected), oscillation);
+
+        // 一方向への旋回（経路追従の向き合わせ等）は停滞とみなさない。首振りは停滞とみなす
+        double turning = 0.0;
+        double expected_yaw = _config.min_yaw_rate * window;
+        if(yaw_path > 0.0 && expected_yaw > 0.0)
+        {
+            turning = clamp(std::fabs(yaw_net) / yaw_path) * clamp(std::fabs(yaw_net) / expected_yaw);
+        }
+
+        return no_progress * stalled * (1.0 - turning);
+    }
+
+    static double clamp(double value)
+    {
+        return std::max(0.0, std::min(1.0, value));
+    }
+};
+
+#endif
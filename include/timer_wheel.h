@@ -0,0 +1,328 @@
+/**
+* @file     timer_wheel.h
+* @brief    階層型タイマーホイールの定義ヘッダファイル
+* @author   S.Kumada
+* @date     2026/10/18
+* @note     タイマーの開始・停止はスロットのリストへの追加・削除のみで行い、
+*           発火時刻からの遅れをタイマー毎に集計する
+*/
+
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#define TIMER_WHEEL_BITS    6                           // 1階層のスロット数のビット数
+#define TIMER_WHEEL_SLOTS   (1 << TIMER_WHEEL_BITS)     // 1階層のスロット数
+#define TIMER_WHEEL_MASK    (TIMER_WHEEL_SLOTS - 1)
+#define TIMER_WHEEL_LEVELS  3                           // 階層数（tick 10msで約43分先まで）
+
+typedef struct TimerStatistics
+{
+    uint64_t fired;         // 発火回数
+    uint64_t skipped;       // 遅れにより飛ばした周期の数
+    double late_max;        // 発火の遅れの最大値[s]
+    double late_sum;        // 発火の遅れの合計[s]
+    double late_last;       // 直近の発火の遅れ[s]
+
+    TimerStatistics()
+        : fired(0)
+        , skipped(0)
+        , late_max(0.0)
+        , late_sum(0.0)
+        , late_last(0.0) {}
+
+}stTimerStatistics;
+
+/**
+ * @brief 階層型タイマーホイールクラス
+ * @details 1tick毎に進む3階層（各64スロット）のホイールでタイマーを管理する。
+ *          タイマーはadd()で登録して番号で操作し、start()/stop()はO(1)で行う。
+ *          advance()を呼び出したスレッドでコールバックを実行する（内部で排他制御は行わない）。
+ *          コールバック内で処理を止める（spinOnceを伴う待ちなど）と、その間は全てのタイマーの発火が止まるため、
+ *          コールバック内では待たずに1回のみのタイマーで続きを行うこと
+ */
+class TimerWheel
+{
+private:
+    struct Entry
+    {
+        std::string name;                   // タイマー名（計測値のキー）
+        std::function<void()> callback;     // コールバック
+        int64_t period;                     // 周期[tick]
+        bool one_shot;                      // 1回のみ発火するか
+        bool active;                        // 開始済みか
+        int64_t expiry;                     // 発火予定のtick
+        int prev;                           // スロット内の前のタイマー（-1:先頭）
+        int next;                           // スロット内の次のタイマー（-1:末尾）
+        int slot;                           // 格納先のスロット（-1:未格納）
+        stTimerStatistics stats;            // 遅れの集計
+    };
+
+    std::vector<Entry> _entries;                        // 登録済みのタイマー
+    int _slots[TIMER_WHEEL_LEVELS * TIMER_WHEEL_SLOTS]; // スロット毎の先頭のタイマー
+    double _tick;                                       // 1tickの時間[s]
+    double _origin;                                     // tick 0の時刻[s]
+    int64_t _current;                                   // 処理済みのtick
+    int64_t _latest;                                    // advance()に与えられた最新の時刻のtick（タイマーの開始の基準）
+    bool _started;                                      // 時刻の基準を設定済みか
+    bool _advancing;                                    // advance()の実行中か（再入防止）
+
+public:
+    /**
+    * @brief        TimerWheelクラスのコンストラクタ
+    * @param[in]    double tick 1tickの時間[s]
+    */
+    explicit TimerWheel(double tick = 0.01)
+        : _tick(tick)
+        , _origin(0.0)
+        , _current(0)
+        , _latest(0)
+        , _started(false)
+        , _advancing(false)
+    {
+        for(int i = 0; i < TIMER_WHEEL_LEVELS * TIMER_WHEEL_SLOTS; i++)
+        {
+            _slots[i] = -1;
+        }
+    }
+
+    /**
+    * @brief        タイマーの登録（開始前に全て登録すること）
+    * @param[in]    const std::string& name タイマー名
+    * @param[in]    double period 周期[s]（1回のみの場合は開始から発火までの時間）
+    * @param[in]    bool one_shot 1回のみ発火するか
+    * @param[in]    const std::function<void()>& callback コールバック
+    * @return       int タイマー番号
+    */
+    int add(const std::string& name, double period, bool one_shot, const std::function<void()>& callback)
+    {
+        Entry entry;
+        entry.name     = name;
+        entry.callback = callback;
+        entry.period   = toTicks(period);
+        entry.one_shot = one_shot;
+        entry.active   = false;
+        entry.expiry   = 0;
+        entry.prev     = -1;
+        entry.next     = -1;
+        entry.slot     = -1;
+        _entries.push_back(entry);
+
+        return (int)_entries.size() - 1;
+    }
+
+    /**
+    * @brief        周期の変更（次の開始から反映する）
+    * @param[in]    int id タイマー番号
+    * @param[in]    double period 周期[s]
+    * @return       void
+    */
+    void setPeriod(int id, double period)
+    {
+        _entries[id].period = toTicks(period);
+    }
+
+    /**
+    * @brief        タイマーの開始（開始済みの場合は何もしない）
+    * @param[in]    int id タイマー番号
+    * @return       void
+    * @details      発火時刻は最新の時刻から数える（遅れて処理中のtickや、コールバック内で止まっている間の古いtickから数えない）
+    */
+    void start(int id)
+    {
+        Entry& entry = _entries[id];
+        if(entry.active)
+        {
+            return;
+        }
+        entry.active = true;
+        entry.expiry = std::max(_current, _latest) + entry.period;
+        insert(id);
+    }
+
+    /**
+    * @brief        タイマーの停止
+    * @param[in]    int id タイマー番号
+    * @return       void
+    */
+    void stop(int id)
+    {
+        Entry& entry = _entries[id];
+        entry.active = false;
+        unlink(id);
+    }
+
+    bool isActive(int id) const { return _entries[id].active; }
+
+    /**
+    * @brief        時刻を進め、発火時刻に達したタイマーのコールバックを実行
+    * @param[in]    double now 現在時刻[s]
+    * @return       void
+    */
+    void advance(double now)
+    {
+        if(!_started)
+        {
+            _origin  = now;
+            _current = 0;
+            _latest  = 0;
+            _started = true;
+        }
+        int64_t target = (int64_t)std::floor((now - _origin) / _tick);
+        _latest = std::max(_latest, target);
+        if(_advancing)
+        { // コールバック内からの呼び出しは時刻の記録のみ行う（発火は呼び出し元のadvance()が続けて行う）
+            return;
+        }
+        _advancing = true;
+        while(_current < target)
+        {
+            _current++;
+            cascade();
+
+            // 現在のtickのスロットのタイマーを発火
+            int* head = &_slots[_current & TIMER_WHEEL_MASK];
+            while(*head != -1)
+            {
+                int id = *head;
+                Entry& entry = _entries[id];
+                unlink(id);
+
+                double late = now - (_origin + entry.expiry * _tick);
+                entry.stats.fired++;
+                entry.stats.late_last = late;
+                entry.stats.late_sum += late;
+                if(late > entry.stats.late_max)
+                {
+                    entry.stats.late_max = late;
+                }
+
+                if(entry.one_shot)
+                {
+                    entry.active = false;
+                }
+                else
+                { // 遅れて周期を過ぎた分は飛ばす
+                    entry.expiry += entry.period;
+                    if(entry.expiry <= target)
+                    {
+                        int64_t skip = (target - entry.expiry) / entry.period + 1;
+                        entry.stats.skipped += skip;
+                        entry.expiry += skip * entry.period;
+                    }
+                    insert(id);
+                }
+
+                entry.callback();
+            }
+        }
+
+        _advancing = false;
+    }
+
+    /**
+    * @brief        タイマー数の取得
+    * @return       int 登録済みのタイマー数
+    */
+    int size() const { return (int)_entries.size(); }
+
+    const std::string& name(int id) const { return _entries[id].name; }
+    const stTimerStatistics& statistics(int id) const { return _entries[id].stats; }
+
+private:
+    int64_t toTicks(double time) const
+    {
+        int64_t ticks = (int64_t)std::llround(time / _tick);
+        return (ticks < 1) ? 1 : ticks;
+    }
+
+    /**
+    * @brief        発火予定のtickに応じた階層・スロットへの格納
+    */
+    void insert(int id)
+    {
+        Entry& entry = _entries[id];
+        int64_t delta = entry.expiry - _current;
+        int64_t expiry = entry.expiry;
+        int level = 0;
+
+        if(delta < 0)
+        {
+            expiry = _current;
+        }
+        while(level < TIMER_WHEEL_LEVELS - 1 && delta >= ((int64_t)1 << (TIMER_WHEEL_BITS * (level + 1))))
+        {
+            level++;
+        }
+        if(delta >= ((int64_t)1 << (TIMER_WHEEL_BITS * TIMER_WHEEL_LEVELS)))
+        { // 最上位の範囲外は最上位の最後のスロットに置き、繰り下げ時に格納し直す
+            expiry = _current + ((int64_t)1 << (TIMER_WHEEL_BITS * TIMER_WHEEL_LEVELS)) - 1;
+        }
+
+        int slot = level * TIMER_WHEEL_SLOTS + (int)((expiry >> (TIMER_WHEEL_BITS * level)) & TIMER_WHEEL_MASK);
+        entry.slot = slot;
+        entry.prev = -1;
+        entry.next = _slots[slot];
+        if(entry.next != -1)
+        {
+            _entries[entry.next].prev = id;
+        }
+        _slots[slot] = id;
+    }
+
+    /**
+    * @brief        スロットからの削除
+    */
+    void unlink(int id)
+    {
+        Entry& entry = _entries[id];
+        if(entry.slot < 0)
+        {
+            return;
+        }
+        if(entry.prev != -1)
+        {
+            _entries[entry.prev].next = entry.next;
+        }
+        else
+        {
+            _slots[entry.slot] = entry.next;
+        }
+        if(entry.next != -1)
+        {
+            _entries[entry.next].prev = entry.prev;
+        }
+        entry.slot = -1;
+        entry.prev = -1;
+        entry.next = -1;
+    }
+
+    /**
+    * @brief        下位の階層が一周した時の上位の階層のスロットの繰り下げ
+    */
+    void cascade()
+    {
+        for(int level = 1; level < TIMER_WHEEL_LEVELS; level++)
+        {
+            if((_current & (((int64_t)1 << (TIMER_WHEEL_BITS * level)) - 1)) != 0)
+            {
+                break;
+            }
+            int slot = level * TIMER_WHEEL_SLOTS + (int)((_current >> (TIMER_WHEEL_BITS * level)) & TIMER_WHEEL_MASK);
+            while(_slots[slot] != -1)
+            {
+                int id = _slots[slot];
+                unlink(id);
+                insert(id);
+            }
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,160 @@
+/**
+* @file     turn_controller.h
+* @brief    その場旋回の台形速度プロファイル制御クラスの定義ヘッダファイル
+* @author   S.Kumada
+* @date     2026/10/18
+* @note     角加速度制限付きで加速し、残り角度から求めた減速曲線と比例制御で目標角度に寄せる
+*/
+
+#ifndef TURN_CONTROLLER_H
+#define TURN_CONTROLLER_H
+
+#include <algorithm>
+#include <cmath>
+
+typedef struct TurnControllerConfig
+{
+    double max_angular_vel;     // 最大旋回速度[rad/s]
+    double max_angular_accel;   // 最大角加速度[rad/s^2]
+    double min_angular_vel;     // 最低旋回速度[rad/s]（静止摩擦で止まらない速度）
+    double kp;                  // 目標角度付近の比例ゲイン[1/s]
+    double tolerance;           // 旋回完了とみなす角度差[rad]
+
+    TurnControllerConfig()
+        : max_angular_vel(0.4)
+        , max_angular_accel(1.0)
+        , min_angular_vel(0.1)
+        , kp(2.0)
+        , tolerance(0.05) {}
+
+}stTurnControllerConfig;
+
+/**
+ * @brief 旋回制御クラス
+ * @details 角度差（目標 - 現在、-π~π）を周期毎に与えると旋回速度（+は左回転）を返す。
+ *          速度は min(最大速度, 減速曲線 sqrt(2*a*残り角度), 比例制御) とし、加速側のみ角加速度で制限する。
+ *          旋回毎に所要時間と行き過ぎ量（目標を越えた最大角度）を記録する
+ */
+class TurnController
+{
+private:
+    stTurnControllerConfig _config; // 制御パラメータ
+    double _command;                // 直前の指令速度[rad/s]
+    double _initial_error;          // 旋回開始時の角度差[rad]
+    double _overshoot;              // 行き過ぎ量[rad]
+    double _elapsed;                // 旋回開始からの経過時間[s]
+
+public:
+    /**
+    * @brief        TurnControllerクラスのコンストラクタ
+    */
+    TurnController()
+        : _command(0.0)
+        , _initial_error(0.0)
+        , _overshoot(0.0)
+        , _elapsed(0.0) {}
+
+    /**
+    * @brief        制御パラメータの設定
+    * @param[in]    const stTurnControllerConfig& config 制御パラメータ
+    * @return       void
+    */
+    void configure(const stTurnControllerConfig& config)
+    {
+        _config = config;
+    }
+
+    /**
+    * @brief        制御パラメータの取得
+    * @return       const stTurnControllerConfig& 制御パラメータ
+    */
+    const stTurnControllerConfig& config() const { return _config; }
+
+    /**
+    * @brief        旋回開始
+    * @param[in]    double error 旋回開始時の角度差[rad]
+    * @return       void
+    */
+    void start(double error)
+    {
+        _command = 0.0;
+        _initial_error = error;
+        _overshoot = 0.0;
+        _elapsed = 0.0;
+    }
+
+    /**
+    * @brief        旋回完了の判定
+    * @param[in]    double error 角度差[rad]
+    * @return       bool true:完了
+    */
+    bool isDone(double error) const
+    {
+        return std::fabs(error) <= _config.tolerance;
+    }
+
+    /**
+    * @brief        旋回速度の算出
+    * @param[in]    double error 角度差[rad]
+    * @param[in]    double dt 前回からの経過時間[s]
+    * @return       double 旋回速度[rad/s]（+は左回転）
+    */
+    double update(double error, double dt)
+    {
+        _elapsed += dt;
+
+        // 目標を越えた場合は行き過ぎ量を記録
+        if(error * _initial_error < 0)
+        {
+            _overshoot = std::max(_overshoot, std::fabs(error));
+        }
+
+        if(isDone(error))
+        {
+            _command = 0.0;
+            return _command;
+        }
+
+        double remain = std::fabs(error) - _config.tolerance;
+        double speed  = _config.max_angular_vel;
+        speed = std::min(speed, std::sqrt(2.0 * _config.max_angular_accel * remain)); // 減速曲線
+        speed = std::min(speed, _config.kp * std::fabs(error));                       // 比例制御
+        speed = std::max(speed, _config.min_angular_vel);
+
+        double target = (error > 0) ? speed : -speed;
+
+        // 加速側のみ角加速度で制限（減速・停止は即時）
+        double max_step = _config.max_angular_accel * dt;
+        if(target * _command <= 0)
+        { // 停止からの加速・反転
+            target = (target > 0) ? std::min(target, max_step) : std::max(target, -max_step);
+        }
+        else if(std::fabs(target) > std::fabs(_command) + max_step)
+        {
+            target = (target > 0) ? _command + max_step : _command - max_step;
+        }
+
+        _command = target;
+        return _command;
+    }
+
+    /**
+    * @brief        停止後の残りの角度差の記録（停止時の惰性による行き過ぎ）
+    * @param[in]    double error 停止後の角度差[rad]
+    * @return       void
+    */
+    void finish(double error)
+    {
+        if(error * _initial_error < 0)
+        {
+            _overshoot = std::max(_overshoot, std::fabs(error));
+        }
+        _command = 0.0;
+    }
+
+    double initialError() const { return _initial_error; }
+    double overshoot() const { return _overshoot; }
+    double elapsed() const { return _elapsed; }
+};
+
+#endif
@@ -5,13 +5,27 @@
 * @note     ロボットの操作（並進・旋回）を行うクラスの実装
 */
 
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <fstream>
 #include <iostream>
+#include <mutex>
+#include <thread>
 #include <ros/ros.h>
+#include <ros/callback_queue.h>
 #include <geometry_msgs/Twist.h>
-#include <tf/transform_listener.h>
+#include <nav_msgs/Odometry.h>
+#include <tf/transform_datatypes.h>
 
 #include <ros/console.h> // ログデバッグ出力用
 
+#include "motion_profile.h" // 並進の速度プロファイル
+#include "realtime_thread.h" // 制御スレッドのリアルタイム実行
+#include "robot_platform.h" // 機種毎のポリシー
+#include "dynamics_identifier.h" // 動特性の計測
+
 #ifndef M_PI
 #define M_PI 3.14159265358979             // 円周率
 #endif
@@ -22,7 +36,65 @@
 #define     DEFAULT_ROBOT_ID    "turtlebot_01"
 #define     DEFAULT_ROBOT_TYPE  "turtlebot"
 
-#define     DEFAULT_VELOCITY_TOPIC  "cmd_vel"
+#define     DEFAULT_ODOM_TOPIC      "odom"
+
+#define     ODOM_FIRST_TIMEOUT      3.0     // 動作開始時のオドメトリ受信待ちのタイムアウト[s]
+#define     ODOM_SAMPLE_TIMEOUT     0.5     // 動作中のオドメトリ受信待ちのタイムアウト[s]
+#define     ODOM_NOMINAL_PERIOD     0.02    // オドメトリの計測時刻が使えない場合の制御周期[s]
+
+#define     DEF_CMD_RATE            20.0    // 速度指令の定周期送信の周期[Hz]
+#define     DEF_CMD_TIMEOUT         0.5     // 速度指令が更新されない場合に停止させるまでの時間[s]
+
+// オドメトリ1サンプル
+typedef struct OdomSample
+{
+  ros::Time stamp;    // 計測時刻
+  double x;           // x座標[m]（odomフレーム）
+  double y;           // y座標[m]（odomフレーム）
+  double yaw;         // 向き[rad]
+  double linear;      // 並進速度[m/s]
+  double angular;     // 旋回速度[rad/s]
+
+  OdomSample() : x(0.0), y(0.0), yaw(0.0), linear(0.0), angular(0.0) {}
+
+}stOdomSample;
+
+// 制御ループの周期の揺らぎ
+typedef struct DriverLoopStatistics
+{
+  unsigned long samples;  // 制御周期の数
+  unsigned long timeouts; // オドメトリ受信待ちのタイムアウト回数
+  double period_last;     // 直近の周期[s]（オドメトリの受信間隔）
+  double period_mean;     // 周期の平均[s]
+  double period_m2;       // 周期の偏差の二乗和（分散の算出用）
+  double period_min;      // 周期の最小値[s]
+  double period_max;      // 周期の最大値[s]
+  double latency_last;    // 直近の計測から指令までの遅れ[s]
+  double latency_max;     // 計測から指令までの遅れの最大値[s]
+
+  DriverLoopStatistics()
+    : samples(0), timeouts(0), period_last(0.0), period_mean(0.0), period_m2(0.0)
+    , period_min(0.0), period_max(0.0), latency_last(0.0), latency_max(0.0) {}
+
+  // 周期の標準偏差[s]
+  double periodStddev() const { return (samples > 1) ? sqrt(period_m2 / (samples - 1)) : 0.0; }
+
+}stDriverLoopStatistics;
+
+// 速度指令の定周期送信の状況
+typedef struct DriverCommandStatistics
+{
+  unsigned long published;      // 定周期送信の回数
+  unsigned long watchdog_trips; // 指令の更新が途絶えて停止させた回数
+  unsigned long late_ticks;     // 1周期以上遅れた送信周期の数
+  double tick_late_max;         // 送信周期の遅れの最大値[s]
+  double tick_late_p99;         // 送信周期の遅れの99パーセンタイル[s]
+  double setpoint_age_max;      // 送信時の指令の経過時間の最大値[s]（停止させた場合を除く）
+
+  DriverCommandStatistics()
+    : published(0), watchdog_trips(0), late_ticks(0), tick_late_max(0.0), tick_late_p99(0.0), setpoint_age_max(0.0) {}
+
+}stDriverCommandStatistics;
 
 class RobotDriver
 {
@@ -31,14 +103,43 @@ private:
   ros::NodeHandle nh_;
   //! We will be publishing to the "cmd_vel" topic to issue commands    //コマンドを発行するために "cmd_vel"トピックに公開します。
   ros::Publisher cmd_vel_pub_;
-  //! We will be listening ot TF transforms as well //  TF変換も聴きます
-  tf::TransformListener listener_;
+  //! Odometry drives the control loops  // オドメトリの受信毎に制御を1周期進める
+  ros::NodeHandle odom_nh_;
+  ros::CallbackQueue odom_queue_;   // オドメトリ専用のコールバックキュー（制御ループ内でのみ処理）
+  ros::Subscriber odom_sub_;
+  stOdomSample odom_latest_;        // 最新のオドメトリ
+  unsigned long odom_seq_;          // オドメトリの受信数
+  ros::WallTime odom_recv_time_;    // 前回の制御周期のオドメトリ受信時刻
+  stDriverLoopStatistics loop_stats_;
+
+  stMotionProfileConfig profile_config_;  // 並進の速度プロファイルのパラメータ
+  stDynamicsConfig dynamics_config_;      // 動特性の計測のパラメータ
+
+  //! Velocity setpoint republished at a fixed rate  // 速度指令は送信スレッドが定周期で送り直す
+  std::mutex cmd_mutex_;                  // 速度指令の排他（値の受け渡しのみ。送信・ログ出力は排他外で行う）
+  std::condition_variable cmd_cond_;      // 速度指令の更新の通知（送信スレッドが即時に送信する）
+  bool cmd_pending_;                      // 送信スレッドが未送信の速度指令の更新があるか
+  double cmd_linear_;                     // 並進速度指令[m/s]（速度プロファイルで整形する前の目標値）
+  double cmd_angular_;                    // 旋回速度指令[rad/s]
+  bool cmd_active_;                       // 定周期送信中か（停止し終えた後・ウォッチドッグ停止後はfalse）
+  std::chrono::steady_clock::time_point cmd_stamp_; // 速度指令の更新時刻
+  MotionProfile cmd_profile_;             // 並進速度指令の整形（加速度・加加速度制限）
+  std::chrono::steady_clock::time_point cmd_profile_stamp_; // 整形を前回進めた時刻
+  double cmd_rate_;                       // 定周期送信の周期[Hz]
+  double cmd_timeout_;                    // 速度指令が更新されない場合に停止させるまでの時間[s]
+  std::thread cmd_thread_;                // 定周期送信スレッド
+  std::atomic<bool> cmd_running_;         // 定周期送信スレッド動作中フラグ
+  stDriverCommandStatistics cmd_stats_;   // 定周期送信の状況
+  JitterHistogram cmd_jitter_;            // 送信周期の遅れの分布
+  stRealtimeConfig realtime_;             // 定周期送信スレッドのリアルタイム実行設定
 
   bool move_forward_state_;
   bool move_turn_state_;
 
   std::string entityId_; // ロボットのユニークID
   std::string velocityTopic_; // velocityトピック名
+  std::string odomTopic_; // オドメトリトピック名
+  stPlatformLimits platform_limits_; // 機種毎の速度制限
 
 
 public:
@@ -54,6 +155,13 @@ public:
 
     move_forward_state_ = false;
     move_turn_state_ = false;
+    odom_seq_ = 0;
+    cmd_linear_ = cmd_angular_ = 0.0;
+    cmd_active_ = false;
+    cmd_pending_ = false;
+    cmd_rate_ = DEF_CMD_RATE;
+    cmd_timeout_ = DEF_CMD_TIMEOUT;
+    cmd_running_ = false;
 
   }
 
@@ -69,6 +177,13 @@ public:
 
     move_forward_state_ = false;
     move_turn_state_ = false;
+    odom_seq_ = 0;
+    cmd_linear_ = cmd_angular_ = 0.0;
+    cmd_active_ = false;
+    cmd_pending_ = false;
+    cmd_rate_ = DEF_CMD_RATE;
+    cmd_timeout_ = DEF_CMD_TIMEOUT;
+    cmd_running_ = false;
 
     if (privateNode.getParam("entity_id", entityId_)){
         ROS_INFO("RobotDriver entity_id:%s", entityId_.c_str());
@@ -76,106 +191,402 @@ public:
         entityId_ = DEFAULT_ROBOT_ID;
     }
 
+    // 機種毎のポリシー（速度指令トピック名・速度制限のデフォルト値）
+    std::string entity_type;
+    privateNode.param("entity_type", entity_type, std::string(DEFAULT_ROBOT_TYPE));
+    bindRobotPlatform(entity_type, *this);
+
     if (privateNode.getParam("velocity_topic", velocityTopic_)){
         ROS_INFO("RobotDriver velocity_topic:%s", velocityTopic_.c_str());
+    }
+
+    if (privateNode.getParam("odom_topic", odomTopic_)){
+        ROS_INFO("RobotDriver odom_topic:%s", odomTopic_.c_str());
     }else{
-        velocityTopic_ = DEFAULT_VELOCITY_TOPIC;
+        odomTopic_ = DEFAULT_ODOM_TOPIC;
     }
 
+    // 並進の速度プロファイル（速度・加速度・加加速度の制限）
+    std::string profile_type;
+    privateNode.param("driver_motion_profile", profile_type, std::string("s_curve"));
+    privateNode.param("driver_max_velocity",   profile_config_.max_velocity, profile_config_.max_velocity);
+    privateNode.param("driver_max_accel",      profile_config_.max_accel,    profile_config_.max_accel);
+    privateNode.param("driver_max_jerk",       profile_config_.max_jerk,     profile_config_.max_jerk);
+    privateNode.param("driver_min_velocity",   profile_config_.min_velocity, profile_config_.min_velocity);
+    privateNode.param("driver_tolerance",      profile_config_.tolerance,    profile_config_.tolerance);
+    profile_config_.type = MotionProfile::typeFromName(profile_type);
+    profile_config_.max_velocity = std::min(profile_config_.max_velocity, platform_limits_.max_linear_vel);
+    profile_config_.max_accel    = std::min(profile_config_.max_accel,    platform_limits_.max_linear_accel);
+    ROS_INFO("RobotDriver motion profile:%s v:%.2f a:%.2f j:%.2f", profile_type.c_str(),
+             profile_config_.max_velocity, profile_config_.max_accel, profile_config_.max_jerk);
+    cmd_profile_.configure(profile_config_);
+
     //set up the publisher for the cmd_vel topic    //cmd_velトピックの発行者を設定します。
     cmd_vel_pub_ = nh_.advertise<geometry_msgs::Twist>( entityId_ + "/" + velocityTopic_, 1);
+
+    // 動特性の計測（ステップ指令の大きさは機種の速度制限まで）
+    privateNode.param("dynamics_linear_levels",  dynamics_config_.linear_levels,  dynamics_config_.linear_levels);
+    privateNode.param("dynamics_angular_levels", dynamics_config_.angular_levels, dynamics_config_.angular_levels);
+    privateNode.param("dynamics_step_time",      dynamics_config_.step_time,      dynamics_config_.step_time);
+    privateNode.param("dynamics_rest_time",      dynamics_config_.rest_time,      dynamics_config_.rest_time);
+    privateNode.param("dynamics_chirp_time",     dynamics_config_.chirp_time,     dynamics_config_.chirp_time);
+    privateNode.param("dynamics_accel_margin",   dynamics_config_.accel_margin,   dynamics_config_.accel_margin);
+    for (size_t i = 0; i < dynamics_config_.linear_levels.size(); i++)
+    {
+      dynamics_config_.linear_levels[i] = std::min(fabs(dynamics_config_.linear_levels[i]), platform_limits_.max_linear_vel);
+    }
+    for (size_t i = 0; i < dynamics_config_.angular_levels.size(); i++)
+    {
+      dynamics_config_.angular_levels[i] = std::min(fabs(dynamics_config_.angular_levels[i]), platform_limits_.max_angular_vel);
+    }
+    dynamics_config_.linear_chirp_amplitude  = std::min(dynamics_config_.linear_chirp_amplitude,  platform_limits_.max_linear_vel);
+    dynamics_config_.angular_chirp_amplitude = std::min(dynamics_config_.angular_chirp_amplitude, platform_limits_.max_angular_vel);
+
+    // 速度指令の定周期送信とウォッチドッグ
+    privateNode.param("driver_cmd_rate",    cmd_rate_,    cmd_rate_);
+    privateNode.param("driver_cmd_timeout", cmd_timeout_, cmd_timeout_);
+    if (cmd_rate_ <= 0) cmd_rate_ = DEF_CMD_RATE;
+    privateNode.param("realtime_mode",     realtime_.enable,   realtime_.enable);
+    privateNode.param("realtime_priority", realtime_.priority, realtime_.priority);
+    privateNode.param("realtime_cpu",      realtime_.cpu,      realtime_.cpu);
+    cmd_running_ = true;
+    cmd_thread_ = std::thread(&RobotDriver::commandLoop, this);
+
+    // オドメトリは専用キューで受け、並進・旋回の制御ループ内で受信毎に処理する
+    odom_nh_ = nh_;
+    odom_nh_.setCallbackQueue(&odom_queue_);
+    odom_sub_ = odom_nh_.subscribe( entityId_ + "/" + odomTopic_, 1, &RobotDriver::odomCallback, this);
   }
 
-  //! Drive forward a specified distance based on odometry information  // 走行距離情報に基づいて指定された距離を前進する
-  // 並進   ※バックは不可 
-  // distance： >0  走行距離
   /**
-  * @brief   指定距離並進処理
-  * @param[in]   double distance
+  * @brief   機種毎のポリシーの適用（RobotPlatformRegistryから呼び出す）
+  * @return  void
+  * @details 速度指令トピック名のデフォルト値と速度制限を設定する
   */
-  bool driveForwardOdom(double distance)
+  template<class Platform>
+  void bindPlatform()
   {
-    //wait for the listener to get the first message    // リスナーが最初のメッセージを受け取るのを待つ
-
-    try{
-        ROS_DEBUG("--- waitForTransform --- Before  ");
-        ros::Time now = ros::Time::now();
-        listener_.waitForTransform(entityId_ + "_base_link", entityId_ + "_odom",     // base_linkから見たodomがくるまで待つ
-                                now, ros::Duration(3.0));   // タイムアウト3秒
-        ROS_DEBUG("--- waitForTransform --- After");
+    velocityTopic_   = Platform::velocityTopic();
+    platform_limits_ = Platform::limits();
+  }
+
+  /**
+  * @brief   RobotDriverクラスのデストラクタ
+  * @details 定周期送信スレッドを終了する
+  */
+  ~RobotDriver()
+  {
+    {
+      std::lock_guard<std::mutex> lock(cmd_mutex_);
+      cmd_running_ = false;
     }
-    catch (tf::TransformException ex)
+    cmd_cond_.notify_all();
+    if (cmd_thread_.joinable())
     {
-      ROS_INFO("---  catch msg  --- waitForTransform");
+      cmd_thread_.join();
+    }
+  }
 
-      ROS_ERROR("%s",ex.what());
-      return(false);
+  /**
+  * @brief   速度指令の設定
+  * @param[in]   double linearSpeed 並進速度（前進を正）
+  * @param[in]   double angularSpeed 旋回速度（＋は左回転、－は右回転）
+  * @param[in]   bool raw true:並進速度を整形せずにそのまま指令する（整形済みの指令・停止・動特性の計測）
+  * @details 指令値を置いて送信スレッドに通知するのみで、送信は送信スレッドが即時に行う（呼び出し側は送信を待たない）。
+  *          並進速度は送信スレッドが速度プロファイルの加速度・加加速度制限で整形しながら定周期で送り直し、
+  *          停止指令も減速し終えるまで送信を続ける
+  */
+  void setVelocity(double linearSpeed, double angularSpeed, bool raw = false)
+  {
+    {
+      std::lock_guard<std::mutex> lock(cmd_mutex_);
+      cmd_linear_  = linearSpeed;
+      cmd_angular_ = angularSpeed;
+      cmd_stamp_   = std::chrono::steady_clock::now();
+      if (raw)
+      {
+        cmd_profile_.startVelocity(linearSpeed, linearSpeed);
+      }
+      cmd_active_  = true;
+      cmd_pending_ = true;
     }
+    cmd_cond_.notify_one();
+  }
 
-    //we will record transforms here    // ここで変換を記録します
-    tf::StampedTransform start_transform;       // 開始位置
-    tf::StampedTransform current_transform;     // 現在位置
-    //record the starting transform from the odometry to the base frame     // オドメトリからベースフレームへの開始変換を記録する
-    ROS_DEBUG("--- lookupTransform --- Before");
+  /**
+  * @brief   並進速度指令の整形を現在時刻まで進める（cmd_mutex_の排他内で呼び出すこと）
+  * @param[in]   std::chrono::steady_clock::time_point now 現在時刻
+  * @return      double 整形後の並進速度指令[m/s]
+  * @details 経過時間は定周期送信の1周期までとし、停止中の空き時間で速度が跳ばないようにする
+  */
+  double shapeLinear(std::chrono::steady_clock::time_point now)
+  {
+    double dt = std::chrono::duration<double>(now - cmd_profile_stamp_).count();
+    dt = std::max(0.0, std::min(dt, 1.0 / cmd_rate_));
+    cmd_profile_stamp_ = now;
+    return(cmd_profile_.track(cmd_linear_, dt));
+  }
 
-    try{
-        listener_.lookupTransform( entityId_ + "_base_link", entityId_ + "_odom",              // 座標の読み出し
-                                  ros::Time(0), start_transform);
+  /**
+  * @brief   定周期送信の状況の取得
+  * @return  stDriverCommandStatistics 集計値
+  */
+  stDriverCommandStatistics commandStatistics()
+  {
+    std::lock_guard<std::mutex> lock(cmd_mutex_);
+    cmd_stats_.tick_late_p99 = cmd_jitter_.percentile(0.99);
+    return(cmd_stats_);
+  }
+
+  /**
+  * @brief   オドメトリ受信処理
+  * @param[in]   const nav_msgs::Odometry& msg オドメトリ
+  */
+  void odomCallback(const nav_msgs::Odometry& msg)
+  {
+    odom_latest_.stamp   = msg.header.stamp;
+    odom_latest_.x       = msg.pose.pose.position.x;
+    odom_latest_.y       = msg.pose.pose.position.y;
+    odom_latest_.yaw     = tf::getYaw(msg.pose.pose.orientation);
+    odom_latest_.linear  = msg.twist.twist.linear.x;
+    odom_latest_.angular = msg.twist.twist.angular.z;
+    odom_seq_++;
+  }
+
+  /**
+  * @brief   次のオドメトリの受信待ち
+  * @param[out]  stOdomSample& sample 受信したオドメトリ
+  * @param[in]   double timeout タイムアウト[s]
+  * @return      bool true:受信, false:タイムアウト
+  * @details 受信済みのオドメトリは使わず、新たに受信するまで待つ。制御周期の揺らぎを集計する
+  */
+  bool waitOdom(stOdomSample& sample, double timeout)
+  {
+    unsigned long seq = odom_seq_;
+    ros::WallTime deadline = ros::WallTime::now() + ros::WallDuration(timeout);
+
+    while (odom_seq_ == seq && nh_.ok())
+    {
+      double remain = (deadline - ros::WallTime::now()).toSec();
+      if (remain <= 0)
+      {
+        loop_stats_.timeouts++;
+        return(false);
+      }
+      odom_queue_.callAvailable(ros::WallDuration(remain));
     }
-    catch (tf::TransformException ex)
+    if (odom_seq_ == seq) return(false);
+
+    sample = odom_latest_;
+
+    ros::WallTime now = ros::WallTime::now();
+    if (!odom_recv_time_.isZero())
     {
-      ROS_INFO("---  catch msg --- lookupTransform");
+      double period = (now - odom_recv_time_).toSec();
+      loop_stats_.samples++;
+      loop_stats_.period_last = period;
+      if (loop_stats_.samples == 1 || period < loop_stats_.period_min) loop_stats_.period_min = period;
+      if (period > loop_stats_.period_max) loop_stats_.period_max = period;
+      double delta = period - loop_stats_.period_mean;
+      loop_stats_.period_mean += delta / loop_stats_.samples;
+      loop_stats_.period_m2   += delta * (period - loop_stats_.period_mean);
+    }
+    odom_recv_time_ = now;
+
+    loop_stats_.latency_last = (ros::Time::now() - sample.stamp).toSec();
+    if (loop_stats_.latency_last > loop_stats_.latency_max) loop_stats_.latency_max = loop_stats_.latency_last;
 
-      ROS_ERROR("%s",ex.what());
+    return(true);
+  }
+
+  /**
+  * @brief   制御ループ開始時のオドメトリ取得
+  * @param[out]  stOdomSample& sample 開始時のオドメトリ
+  * @return      bool true:取得, false:タイムアウト
+  */
+  bool startOdomLoop(stOdomSample& sample)
+  {
+    odom_queue_.callAvailable();            // 前回の動作以降に溜まった古いオドメトリを捨てる
+    odom_recv_time_ = ros::WallTime();      // 動作間の空き時間は周期に含めない
+    if (!waitOdom(sample, ODOM_FIRST_TIMEOUT))
+    {
+      ROS_ERROR("RobotDriver: no odometry on %s", odom_sub_.getTopic().c_str());
       return(false);
     }
+    return(true);
+  }
+
+  /**
+  * @brief   オドメトリ間の制御周期
+  * @param[in]   const stOdomSample& prev 前回のオドメトリ
+  * @param[in]   const stOdomSample& curr 今回のオドメトリ
+  * @return      double 制御周期[s]（計測時刻から求め、求められない場合は公称値）
+  */
+  static double odomPeriod(const stOdomSample& prev, const stOdomSample& curr)
+  {
+    double dt = (curr.stamp - prev.stamp).toSec();
+    if (dt <= 0 || dt > ODOM_SAMPLE_TIMEOUT) dt = ODOM_NOMINAL_PERIOD;
+    return(dt);
+  }
 
-    ROS_DEBUG("--- lookupTransform --- After");
+  /**
+  * @brief   直前の並進速度指令の取得
+  * @return  double 並進速度指令[m/s]（整形後の送信した値）
+  */
+  double linearCommand()
+  {
+    std::lock_guard<std::mutex> lock(cmd_mutex_);
+    return(cmd_profile_.velocity());
+  }
 
-    //we will be sending commands of type "twist"   //  "twist"タイプのコマンドを送信します
+  /**
+  * @brief   速度指令のパブリッシュ（送信スレッドからcmd_mutex_の排他外で呼び出す）
+  */
+  void publishVelocity(double linearSpeed, double angularSpeed)
+  {
     geometry_msgs::Twist base_cmd;
-    //the command will be to go forward at 0.25 m/s     // コマンドは0.25m/sで前進することです（直進速度）
-    base_cmd.linear.y = base_cmd.angular.z = 0;
-    base_cmd.linear.x = 0.25;
+    base_cmd.linear.y = 0.0;
+    base_cmd.linear.x = linearSpeed;
+    base_cmd.angular.z = angularSpeed;
+    cmd_vel_pub_.publish(base_cmd);
+  }
 
-    ros::Rate rate(50.0);   //  50Hz（1秒間に50回、この場合0.02秒間隔）
-    bool done = false;
+  /**
+  * @brief   速度指令の定周期送信スレッド
+  * @details 周期毎、および速度指令の更新の通知毎に並進速度指令の整形を進めて送信し、停止指令で減速し終えた後は
+  *          次の指令まで送信しない。更新がcmd_timeout_を超えて途絶えた指令は即時の停止指令に置き換える。
+  *          cmd_mutex_は指令値の読み書きの間のみ保持し、送信（メッセージの確保を伴う）とログ出力は排他外で行うため、
+  *          指令を更新する他のスレッドとの間で優先度の逆転が起きない。送信周期の遅れを集計する
+  */
+  void commandLoop()
+  {
+    std::string error;
+    if (!applyRealtimeThread(realtime_, error))
+    {
+      ROS_WARN("RobotDriver: realtime setting failed (%s), running with normal priority", error.c_str());
+    }
+
+    const std::chrono::duration<double> period(1.0 / cmd_rate_);
+    std::chrono::steady_clock::time_point next = std::chrono::steady_clock::now()
+      + std::chrono::duration_cast<std::chrono::steady_clock::duration>(period);
+
+    std::unique_lock<std::mutex> lock(cmd_mutex_);
+    while (cmd_running_)
+    {
+      // 次の周期まで待つ（速度指令の更新の通知で起きた場合は周期を変えずに即時に送信する）
+      bool notified = cmd_cond_.wait_until(lock, next, [this]{ return cmd_pending_ || !cmd_running_; });
+      if (!cmd_running_) break;
+      std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+      if (!notified)
+      {
+        double late = std::chrono::duration<double>(now - next).count();
+        if (late > cmd_stats_.tick_late_max) cmd_stats_.tick_late_max = late;
+        cmd_jitter_.add(late);
+        next += std::chrono::duration_cast<std::chrono::steady_clock::duration>(period);
+        if (late > period.count())
+        { // 1周期以上遅れた場合は遅れを取り戻さずに周期を合わせ直す
+          cmd_stats_.late_ticks++;
+          next = now + std::chrono::duration_cast<std::chrono::steady_clock::duration>(period);
+        }
+      }
+      cmd_pending_ = false;
+
+      if (!cmd_active_) continue;
+
+      // 送信する指令値を排他内で確定する
+      double age = std::chrono::duration<double>(now - cmd_stamp_).count();
+      bool stale = (cmd_timeout_ > 0 && age > cmd_timeout_);
+      double linear, angular;
+      if (stale)
+      { // 指令の更新が途絶えた（呼び出し側の処理が止まっている）場合は停止させる
+        cmd_linear_ = cmd_angular_ = 0.0;
+        cmd_profile_.startVelocity(0.0, 0.0);
+        cmd_active_ = false;
+        cmd_stats_.watchdog_trips++;
+        linear = angular = 0.0;
+      }
+      else
+      {
+        linear  = shapeLinear(now);
+        angular = cmd_angular_;
+        cmd_stats_.published++;
+        if (age > cmd_stats_.setpoint_age_max) cmd_stats_.setpoint_age_max = age;
+        if (linear == 0.0 && cmd_linear_ == 0.0 && cmd_angular_ == 0.0)
+        { // 停止指令で減速し終えた
+          cmd_active_ = false;
+        }
+      }
+
+      lock.unlock();
+      publishVelocity(linear, angular);
+      if (stale)
+      {
+        ROS_WARN("RobotDriver: velocity setpoint stale for %.2f[s], stopping", age);
+      }
+      lock.lock();
+    }
+  }
+
+  /**
+  * @brief   制御ループの周期の揺らぎの取得
+  * @return  const stDriverLoopStatistics& 集計値
+  */
+  const stDriverLoopStatistics& loopStatistics() const
+  {
+    return(loop_stats_);
+  }
+
+  //! Drive forward a specified distance based on odometry information  // 走行距離情報に基づいて指定された距離を前進する
+  // 並進
+  // distance： >0  走行距離（前進）  <0  走行距離（後退）
+  /**
+  * @brief   指定距離並進処理
+  * @param[in]   double distance 走行距離（負は後退）
+  * @details 速度プロファイル（加速度・加加速度制限）で加減速し、残り距離からの減速曲線で止める
+  */
+  bool driveForwardOdom(double distance)
+  {
+    //record the starting pose from the odometry     // オドメトリから開始位置を記録する
+    stOdomSample start_odom;     // 開始位置
+    stOdomSample prev_odom;      // 前回位置
+    stOdomSample current_odom;   // 現在位置
+    if (!startOdomLoop(start_odom)) return(false);
+    prev_odom = start_odom;
+
+    MotionProfile profile;
+    profile.configure(profile_config_);
+    profile.start(distance, linearCommand());
+
+    double start_cos = cos(start_odom.yaw);
+    double start_sin = sin(start_odom.yaw);
+    bool done = profile.isFinished();
 
       ROS_DEBUG("start");
-      ROS_DEBUG("x(%f) y(%f) z(%f) w(%f)",start_transform.getOrigin().x(),start_transform.getOrigin().y(),
-      start_transform.getOrigin().z(), start_transform.getOrigin().w());
+      ROS_DEBUG("x(%f) y(%f) yaw(%f)", start_odom.x, start_odom.y, start_odom.yaw);
       ROS_DEBUG("Advance"); // 前進
 
     while (!done && nh_.ok())   //doneまで、またはCtrl+Cが押されるまで
     {
-      //send the drive command      //  ドライブコマンドを送信する
-      cmd_vel_pub_.publish(base_cmd);   // パブリッシュ
-      rate.sleep();                     // 指定Hz間隔にするようにスリープ
-      //get the current transform   //  現在の変換を取得する
-      try
-      {
-        listener_.lookupTransform(entityId_ + "_base_link", entityId_ + "_odom",      // 座標の読み出し
-                                  ros::Time(0), current_transform);     // ros::Time(0) = 最新の情報を読み出す
-      }
-      catch (tf::TransformException ex)
+      //wait for the next odometry  //  次のオドメトリを受信するまで待つ（受信毎に1周期）
+      if (!waitOdom(current_odom, ODOM_SAMPLE_TIMEOUT))
       {
-        ROS_ERROR("%s",ex.what());
+        ROS_ERROR("RobotDriver: odometry timeout");
         break;
       }
-      //see how far we've traveled  // 走行距離を計算
-      tf::Transform relative_transform = 
-        start_transform.inverse() * current_transform;              // inverse()=この変換の逆を返します。
+      //see how far we've traveled  // 走行距離を計算（開始時の向きへの射影、前進を正）
+      double travelled = (current_odom.x - start_odom.x) * start_cos + (current_odom.y - start_odom.y) * start_sin;
+      double speed = profile.update(travelled, odomPeriod(prev_odom, current_odom));
+      prev_odom = current_odom;
 
-      double dist_moved = relative_transform.getOrigin().length();  // getOrigin()=Vector3型を返す  length()=ベクトルの長さを返します。
-//      ROS_DEBUG("x(%f) y(%f) z(%f) w(%f)",current_transform.getOrigin().x(),current_transform.getOrigin().y(),
-//      current_transform.getOrigin().z(), current_transform.getOrigin().w());
-      ROS_DEBUG("distance = %f dist_moved= %f",distance, dist_moved );
+      //send the drive command      //  ドライブコマンドを送信する（速度プロファイルで整形済み）
+      setVelocity(speed, 0.0, true);
+      ROS_DEBUG("distance = %f travelled = %f speed = %f", distance, travelled, speed);
 
-      if(dist_moved > distance) done = true;
+      done = profile.isFinished();
     }
 
-    base_cmd.linear.x = base_cmd.linear.y = base_cmd.angular.z = 0;
-    cmd_vel_pub_.publish(base_cmd);
+    setVelocity(0.0, 0.0, true);
 
     if (done) return true;
     return false;
@@ -192,46 +603,14 @@ public:
   */
   bool turnOdom(bool clockwise, double radians, double angularSpeed = 0.4)
   {
-    double radians_before = radians;
-
-    //wait for the listener to get the first message    // リスナーが最初のメッセージを受け取るのを待つ
-    ros::Time now = ros::Time::now();
-    try{
-        listener_.waitForTransform( entityId_ + "_base_link", entityId_ + "_odom",    // base_linkから見たodomがくるまで待つ
-                               now, ros::Duration(3.0));   // タイムアウト1秒
-    }
-    catch (tf::TransformException ex)
-    {
-      ROS_INFO("---  catch msg  --- waitForTransform");
+    //record the starting pose from the odometry // オドメトリから開始時の向きを記録する
+    stOdomSample start_odom;
+    stOdomSample current_odom;
+    if (!startOdomLoop(start_odom)) return(false);
 
-      ROS_ERROR("%s",ex.what());
-      return(false);
-    }
-
-    //we will record transforms here        // ここで変換を記録します
-    tf::StampedTransform start_transform;
-    tf::StampedTransform current_transform;
-
-
-
-    double yaw_before = 0;
-    double yaw_current = 0;
+    double yaw_before = start_odom.yaw;
     double yaw_total = 0;
 
-    //record the starting transform from the odometry to the base frame // オドメトリからベースフレームへの開始変換を記録する
-
-    try{
-        listener_.lookupTransform(entityId_ + "_base_link", entityId_ + "_odom",  // 座標の読み出し
-                              ros::Time(0), start_transform);
-    }
-    catch (tf::TransformException ex)
-    {
-      ROS_INFO("---  catch msg --- lookupTransform");
-
-      ROS_ERROR("%s",ex.what());
-      return(false);
-    }
-
     //we will be sending commands of type "twist"   // "twist"タイプのコマンドを送信します
     geometry_msgs::Twist base_cmd;
     //the command will be to turn at 0.75 rad/s     // コマンドは0.4 rad / sで回転するようになります（回転速度）
@@ -241,82 +620,105 @@ public:
 
     double turn_threshold = fabs(base_cmd.angular.z) / 5;// 回転量のしきい値 0.2s時の最大回転rad
 
-    //the axis we want to be rotating by            //  回転させたい軸
-    tf::Vector3 desired_turn_axis(0,0,1);           //  z軸を指定
-    if (!clockwise) desired_turn_axis = -desired_turn_axis;
-
-    ros::Rate rate(50.0);   //  50Hz（1秒間に50回、この場合0.02秒間隔）
     bool done = false;
 
-    double angle_turned_before = 0;
-    double angle_turned_total = 0;
-
     while (!done && nh_.ok())   //doneまで、またはCtrl+Cが押されるまで
     {
       //send the drive command      // ドライブコマンドを送信する
-      cmd_vel_pub_.publish(base_cmd);   // パブリッシュ
-      rate.sleep();                     // 指定Hz間隔にするようにスリープ
-      //get the current transform   //  現在の変換を取得する
-      try
-      {
-        listener_.lookupTransform(entityId_ + "_base_link", entityId_ + "_odom",  // 座標の読み出し
-                                  ros::Time(0), current_transform);
-
-        tf::Matrix3x3 m = current_transform.getBasis();
-        double roll, pitch, yaw;
-        m.getRPY(roll, pitch, yaw);
-
-        yaw_current = yaw; // 現在のyawを取得   
-
-      }
-      catch (tf::TransformException ex)
+      setVelocity(0.0, base_cmd.angular.z);
+      //wait for the next odometry  //  次のオドメトリを受信するまで待つ（受信毎に1周期）
+      if (!waitOdom(current_odom, ODOM_SAMPLE_TIMEOUT))
       {
-        ROS_ERROR("%s",ex.what());
+        ROS_ERROR("RobotDriver: odometry timeout");
         break;
       }
 
-      if ( fabs(yaw_current-yaw_before) < 1.0e-2) continue;       // fabs=絶対値
-
-      double turn_val;
+      // 前回からの回転量（旋回方向を正とする、±πの折り返しを考慮）
+      double diff = atan2(sin(current_odom.yaw - yaw_before), cos(current_odom.yaw - yaw_before));
+      double turn_val = clockwise ? -diff : diff;
 
-      if( clockwise ){
-          // 右回転     
-          if(yaw_current >= yaw_before){
-             turn_val = yaw_current - yaw_before;
-             ROS_DEBUG(">= yaw_before(%f) yaw_current(%f) yaw_total(%f)+turn_val(%f)",yaw_before, yaw_current, yaw_total, turn_val);
-          }else{  
-             turn_val = (M_PI - yaw_before) + (M_PI + yaw_current);
-             ROS_DEBUG("< yaw_before(%f) yaw_current(%f) yaw_total(%f)+turn_val(%f)",yaw_before, yaw_current, yaw_total, turn_val);
-          }
-      }else{
-          // 左回転           
-          if(yaw_before >= yaw_current){
-             turn_val = yaw_before - yaw_current;       
-             ROS_DEBUG(">= yaw_before(%f) yaw_current(%f) yaw_total(%f)+turn_val(%f)",yaw_before, yaw_current, yaw_total, turn_val);
-          }else{  
-             turn_val = (M_PI - yaw_current) + (M_PI + yaw_before);
-             ROS_DEBUG("< yaw_before(%f) yaw_current(%f) yaw_total(%f)+turn_val(%f)",yaw_before, yaw_current, yaw_total, turn_val);
-          }
-      }
-      if(turn_val <= turn_threshold){
+      if(fabs(turn_val) <= turn_threshold){
           yaw_total += turn_val; // 加算
+          ROS_DEBUG("yaw_before(%f) yaw_current(%f) yaw_total(%f) turn_val(%f)",yaw_before, current_odom.yaw, yaw_total, turn_val);
       }else{
           ROS_WARN("turn_threshold(%f) turn_val(%f)",turn_threshold, turn_val);
       }
 
-      yaw_before = yaw_current; // 前回値保持
+      yaw_before = current_odom.yaw; // 前回値保持
 
       if (yaw_total > radians) done = true;
 
     }
 
-    base_cmd.linear.x = base_cmd.linear.y = base_cmd.angular.z = 0;
-    cmd_vel_pub_.publish(base_cmd);
+    setVelocity(0.0, 0.0);
 
     if (done) return true;
     return false;
   }
 
+  /**
+  * @brief   動特性の計測
+  * @param[in]   const std::string& output 計測結果のYAMLの出力先（空の場合は dynamics_<entity_id>.yaml）
+  * @return      bool true:計測・出力成功, false:失敗
+  * @details 並進・旋回のステップ指令とチャープ指令を順に与え、オドメトリの受信毎に速度の応答を記録する。
+  *          ステップは正負の往復、チャープは0を中心とするため、開始位置付近で動作する。
+  *          推定したむだ時間・時定数・定常ゲイン・最大加速度と、それらから求めた制御パラメータをYAMLに出力する
+  */
+  bool characterizeDynamics(const std::string& output)
+  {
+    DynamicsIdentifier identifier;
+    identifier.configure(dynamics_config_);
+    ROS_INFO("RobotDriver: dynamics characterization start (%.0f s)", identifier.duration());
+
+    stOdomSample current_odom;
+    if (!startOdomLoop(current_odom)) return(false);
+
+    bool done = false;
+    while (nh_.ok())
+    {
+      // 計測時刻が無いオドメトリは受信時刻で代用する
+      double now = current_odom.stamp.isZero() ? ros::WallTime::now().toSec() : current_odom.stamp.toSec();
+      double linear_cmd, angular_cmd;
+      if (!identifier.update(now, current_odom.linear, current_odom.angular, linear_cmd, angular_cmd))
+      {
+        done = true;
+        break;
+      }
+      setVelocity(linear_cmd, angular_cmd, true); // ステップ・チャープは整形せずに与える
+
+      if (!waitOdom(current_odom, ODOM_SAMPLE_TIMEOUT))
+      {
+        ROS_ERROR("RobotDriver: odometry timeout");
+        break;
+      }
+    }
+    setVelocity(0.0, 0.0, true);
+    if (!done) return(false);
+
+    stDynamicsEstimate linear  = identifier.estimate(DYNAMICS_AXIS_LINEAR);
+    stDynamicsEstimate angular = identifier.estimate(DYNAMICS_AXIS_ANGULAR);
+    ROS_INFO("RobotDriver: dynamics samples:%lu dropped:%lu", (unsigned long)identifier.samples(), (unsigned long)identifier.dropped());
+    ROS_INFO("RobotDriver: odometry period mean:%.4f stddev:%.4f min:%.4f max:%.4f timeouts:%lu latency max:%.4f",
+             loop_stats_.period_mean, loop_stats_.periodStddev(), loop_stats_.period_min, loop_stats_.period_max,
+             loop_stats_.timeouts, loop_stats_.latency_max);
+    ROS_INFO("RobotDriver: linear  latency:%.3f tau:%.3f gain:%.3f accel:%.3f tracked:%.2f",
+             linear.latency, linear.time_constant, linear.gain, linear.max_accel, linear.max_tracked);
+    ROS_INFO("RobotDriver: angular latency:%.3f tau:%.3f gain:%.3f accel:%.3f tracked:%.2f",
+             angular.latency, angular.time_constant, angular.gain, angular.max_accel, angular.max_tracked);
+
+    std::string path = output.empty() ? "dynamics_" + entityId_ + ".yaml" : output;
+    std::ofstream file(path.c_str());
+    if (!file)
+    {
+      ROS_ERROR("RobotDriver: cannot write %s", path.c_str());
+      return(false);
+    }
+    file << identifier.toYaml(entityId_, linear, angular);
+    ROS_INFO("RobotDriver: dynamics written to %s", path.c_str());
+
+    return(linear.valid && angular.valid);
+  }
+
   /**
   * @brief   直進フラグゲッター
   * @param[in]   void
@@ -338,31 +740,42 @@ public:
   /**
   * @brief   並進・旋回停止処理
   * @param[in]   void
+  * @details 減速せずに即時に停止させる
   */
   void stopOdom()
   { 
-      geometry_msgs::Twist base_cmd;
-      base_cmd.linear.y = base_cmd.angular.z = 0;
-      base_cmd.linear.x = 0.0;
-      cmd_vel_pub_.publish(base_cmd);
+      setVelocity(0.0, 0.0, true);
       move_forward_state_ = false;
       move_turn_state_ = false;
   }
   
   /**
   * @brief   指定速度並進処理
-  * @param[in]   double linearSpeed　並進速度
+  * @param[in]   double linearSpeed　並進速度（負は後退）
+  * @details 指定速度までの加減速は速度指令の整形（setVelocity）で行うため、待たずに戻る。
+  *          指定速度は最大速度で制限する
   */
   void moveForward(double linearSpeed)
   { 
-      geometry_msgs::Twist base_cmd;
-      base_cmd.linear.y = base_cmd.angular.z = 0;
-      base_cmd.linear.x = linearSpeed;
-      cmd_vel_pub_.publish(base_cmd);
+      setVelocity(linearSpeed, 0.0);
 
-      move_forward_state_ = true;
+      move_forward_state_ = (linearSpeed != 0.0);
   }
   
+  /**
+  * @brief   指定速度並進・旋回処理
+  * @param[in]   double linearSpeed　並進速度
+  * @param[in]   double angularSpeed　旋回速度（＋は左回転、－は右回転）
+  * @details 並進速度は速度指令の整形（setVelocity）で加速度・加加速度を制限する
+  */
+  void moveVelocity(double linearSpeed, double angularSpeed)
+  { 
+      setVelocity(linearSpeed, angularSpeed);
+
+      move_forward_state_ = (linearSpeed != 0.0);
+      move_turn_state_ = (angularSpeed != 0.0);
+  }
+
   /**
   * @brief   指定速度旋回処理
   * @param[in]   bool clockwise　旋回方向
@@ -370,11 +783,8 @@ public:
   */
   void moveTurn(bool clockwise, double angularSpeed)
   { 
-    geometry_msgs::Twist base_cmd;
-    base_cmd.linear.x = base_cmd.linear.y = 0.0;
-    base_cmd.angular.z = angularSpeed;
-    if (clockwise) base_cmd.angular.z = -base_cmd.angular.z; // 回転方向を決める（＋は左回転、－は右回転）
-    cmd_vel_pub_.publish(base_cmd);
+    if (clockwise) angularSpeed = -angularSpeed; // 回転方向を決める（＋は左回転、－は右回転）
+    setVelocity(0.0, angularSpeed);
     move_turn_state_ = true;
   }
 };
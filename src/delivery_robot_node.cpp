@@ -22,15 +22,24 @@
 > 　　/robot_bridge/$(arg ENTITY_ID)/emgexe
 >   ⑥ロボットの情報通知
 >     /robot_bridge/$(arg ENTITY_ID)/robo_info
+>   ⑦ロボットへの複数目的地の移動指示
+>     /robot_bridge/$(arg ENTITY_ID)/navi_route_cmd
+>   ⑧ロボットの状態報告の補足情報（ルートの進捗）
+>     /robot_bridge/$(arg ENTITY_ID)/state_detail
+>   ⑨移動指示の到達可否判定結果（経路長・到達予想時間）
+>     /robot_bridge/$(arg ENTITY_ID)/navi_cmdexe_estimate
 
 */
 
 #include <ros/ros.h>
+#include <ros/callback_queue.h>
 #include <actionlib_msgs/GoalID.h>
 #include <geometry_msgs/PoseStamped.h>
 #include <geometry_msgs/PoseWithCovarianceStamped.h>// 初期位置トピックの型 https://demura.net/lecture/14011.html
 #include <tf/transform_datatypes.h>
-#include <tf/transform_listener.h>
+#include <tf2/utils.h>
+#include <tf2_ros/buffer.h>
+#include <tf2_ros/transform_listener.h>
 #include <sensor_msgs/BatteryState.h> //バッテリーステータス     TB3
 #include <std_msgs/Int16MultiArray.h> //バッテリーステータス     メガローバ
 #include <move_base_msgs/MoveBaseAction.h>
@@ -38,9 +47,27 @@
 #include <actionlib/client/simple_action_client.h>
 #include <actionlib/client/terminal_state.h>
 #include <nav_msgs/Path.h>
+#include <nav_msgs/Odometry.h>
 #include <nav_msgs/OccupancyGrid.h>
+#include <nav_msgs/GetPlan.h>
+#include <diagnostic_msgs/DiagnosticArray.h>
+#include <atomic>
+#include <deque>
+#include <memory>
 
 #include "utilities.h"
+#include "ring_buffer.h"
+#include "node_metrics.h"
+#include "path_follower.h"
+#include "grid_planner.h"
+#include "turn_controller.h"
+#include "footprint_stencil.h"
+#include "stuck_detector.h"
+#include "goal_approach_monitor.h"
+#include "timer_wheel.h"
+#include "robot_platform.h"
+#include "pose_cache.h"
+#include "pose_predictor.h"
 #include "RobotDriver.cpp" // ロボット制御
 #include "uoa_poc3_msgs/r_state.h"   // 状態報告メッセージ
 #include "uoa_poc3_msgs/r_emergency_command.h"  // 緊急停止メッセージ
@@ -64,6 +91,11 @@
 #include "uoa_poc6_msgs/r_get_map_pose_correct.h"
 #include "uoa_poc6_msgs/r_map_pose_correct_info.h"
 
+// 2026/10/18追加
+#include "delivery_robot/r_route_command.h"   // 複数目的地の移動指示メッセージ
+#include "delivery_robot/r_state_detail.h"    // 状態報告の補足情報メッセージ
+#include "delivery_robot/r_navi_estimate.h"   // 到達可否判定結果メッセージ
+
 //  MODE種別
 #define     MODE_STANDBY        "standby"
 #define     MODE_NAVI           "navi"
@@ -77,6 +109,7 @@
 #define     RESULT_ACK          "ack"
 #define     RESULT_IGNORE       "ignore"
 #define     RESULT_ERROR        "error"
+#define     RESULT_SUPERSEDED   "superseded"
 // ID,TYPE
 #define     DEFAULT_ROBOT_ID    "turtlebot_01"
 #define     DEFAULT_ROBOT_TYPE  "turtlebot"
@@ -103,9 +136,6 @@
 #define		ROS_QUEUE_SIZE_10	10
 #define		ROS_QUEUE_SIZE_100	100
 
-// メガローバ 電圧係数
-#define     MR_VOLTAGE_FACTOR   137.8
-
 // コスト定義
 #define     UNKNOWN_COST_GRIDMAP                -1
 #define     FREESPACE_COST_GRIDMAP              0
@@ -137,6 +167,64 @@
 // 更新済みコストの差分のしきい値
 #define     DIFFERENCIAL_COST_THRESHOLD 30
 
+// ルート停止地点の進捗
+#define     ROUTE_STOP_PENDING      "pending"
+#define     ROUTE_STOP_ACTIVE       "active"
+#define     ROUTE_STOP_ARRIVED      "arrived"
+#define     ROUTE_STOP_CANCELLED    "cancelled"
+// ルートの最大停止地点数
+#define     DEF_ROUTE_MAX_STOPS     32
+
+// その場旋回の衝突判定
+#define     DEF_TURN_CHECK_HEADINGS         72      // footprintのマスクの角度分割数（5度刻み）
+#define     DEF_TURN_CHECK_RESOLUTION       0.05    // マスクの解像度[m]（ソシオ地図受信時に地図の解像度で作り直す）
+
+// 到達可否判定（経路探索）
+#define     DEF_PLANNER_RESOLUTION          0.1     // 探索グリッドの解像度[m]
+#define     DEF_PLANNER_OCCUPIED_THRESHOLD  65      // 障害物とみなす占有値
+#define     DEF_PLANNER_TIME_BUDGET         0.01    // 探索の制限時間[s]
+#define     DEF_PLANNER_NOMINAL_SPEED       0.2     // 到達予想時間算出用の平均速度[m/s]
+
+// 移動前の旋回の向き
+#define     TURN_HEADING_GRID               "grid"      // 内蔵の経路探索の経路
+#define     TURN_HEADING_MOVE_BASE          "move_base" // move_baseのmake_planサービスの経路
+#define     TURN_HEADING_STRAIGHT           "straight"  // 目的地への直線
+#define     DEF_TURN_HEADING_LOOKAHEAD      1.0         // 経路上の注視点までの距離[m]
+
+// サスペンドからの再開
+#define     DEF_RESUME_POSITION_TOLERANCE   0.05        // 走行中の経路で再開する位置のずれの上限[m]
+#define     DEF_RESUME_ANGLE_TOLERANCE      0.1         // 走行中の経路で再開する向きのずれの上限[rad]
+#define     RESUME_MOTION_DISTANCE          0.02        // 再開後に走行を開始したとみなす移動距離[m]
+
+// コストマップ更新時の経路の部分修正
+#define     DEF_REPLAN_MARGIN               1.0         // 塞がれた区間の前後に加える修正範囲[m]
+
+// リアルタイム実行
+#define     DEF_REALTIME_HEAP_PREFAULT_MB   64          // 事前に確保しておくヒープサイズ[MB]
+
+// 走行開始時のコストマップ反映待ち
+#define     DEF_COSTMAP_SETTLE_TIME         ROS_TIME_5S // コストマップの反映を待つ時間[s]
+
+// 位置・向きのキャッシュ
+#define     DEF_POSE_CACHE_PERIOD           ROS_TIME_50MS   // 座標変換の取得周期[s]（この間の読み出しはキャッシュから返す）
+#define     DEF_POSE_CACHE_MAX_AGE          0.5             // 取得失敗時にキャッシュを使う座標変換の経過時間の上限[s]
+
+// オドメトリによる位置・向きの予測
+#define     DEF_PREDICTOR_ODOM_QUEUE_SIZE   50              // オドメトリの受信キューのサイズ
+
+// 起動時のキャリブレーション（その場旋回）
+#define     DEF_CALIBRATION_SETTLE_TIME     ROS_TIME_10S    // 旋回前に地図・初期位置の反映を待つ最長時間[s]
+#define     DEF_CALIBRATION_MIN_SETTLE_TIME 2.0             // 旋回前に待つ最短時間[s]
+#define     DEF_CALIBRATION_XY_VARIANCE     0.01            // 位置推定の収束とみなすx・yの分散[m^2]（標準偏差10cm）
+#define     DEF_CALIBRATION_YAW_VARIANCE    0.01            // 位置推定の収束とみなすyawの分散[rad^2]（標準偏差約5.7度）
+#define     DEF_CALIBRATION_MIN_UPDATES     2               // 収束の判定に必要な旋回開始後のamcl_poseの受信数
+
+// レイヤ地図の取得
+#define     DEF_LAYER_MAP_TIMEOUT           ROS_TIME_10S    // レイヤ毎の取得要求の応答待ち時間[s]（超過したレイヤのみ再要求する）
+
+// タイマーホイール
+#define     DEF_TIMER_WHEEL_TICK            0.01    // 1tickの時間[s]（駆動用のWallTimerの周期）
+
 typedef struct DestinationPoint 
 {
     double x;
@@ -144,6 +232,70 @@ typedef struct DestinationPoint
 
 }stExclusionPoint;
 
+typedef struct RouteStop
+{
+    uoa_poc3_msgs::r_pose_optional destination; // 目的地
+    double dwell_time;                          // 到着後の停止時間[s]
+    int route_index;                            // ルート内のインデックス（単一目的地の場合は-1）
+
+}stRouteStop;
+
+typedef struct PendingNaviUpdate
+{
+    uoa_poc3_msgs::r_navi_command msg;  // 反映待ちのコストマップ更新コマンド
+    ros::WallTime received_time;        // 最初の受信時刻
+
+}stPendingNaviUpdate;
+
+typedef struct NaviEstimate
+{
+    bool valid;             // 判定を行ったか（地図未受信・自己位置取得失敗の場合は判定しない）
+    bool reachable;         // 到達可能か
+    bool is_lower_bound;    // 経路長・到達予想時間が下限値か
+    double path_length;     // 経路長[m]
+    double eta;             // 到達予想時間[s]
+    double planning_time;   // 判定に要した時間[s]
+
+}stNaviEstimate;
+
+typedef struct SuspendSnapshot
+{
+    bool valid;                             // サスペンド時の状態を保持しているか
+    stRouteStop stop;                       // サスペンド時の停止地点
+    geometry_msgs::PoseStamped goal;        // サスペンド時に走行中だったmove_baseのゴール
+    std::vector<Vector2d> follow_path;      // サスペンド時に追従中だった経路（内蔵の経路追従制御）
+    double x;                               // サスペンド時の位置
+    double y;
+    double yaw;                             // サスペンド時の向き
+    unsigned int costmap_generation;        // サスペンド時の経路コストマップの世代
+
+    SuspendSnapshot() : valid(false), x(0.0), y(0.0), yaw(0.0), costmap_generation(0) {}
+
+}stSuspendSnapshot;
+
+typedef struct LayerMapFetch
+{
+    const char* layer;          // レイヤ名
+    const bool* received;       // 受信済みフラグ（layerMapUpdateNotifyRecvで設定）
+    int requests;               // 取得要求の送信回数
+    ros::WallTime requested;    // 最後に取得要求を送信した時刻
+    double fetch_time;          // 取得開始から受信完了までの時間[s]（-1:未受信）
+
+}stLayerMapFetch;
+
+typedef struct ObstacleCellIndex
+{
+    Vector2d origin;                // 索引の原点（セルの外接矩形の最小点）
+    double bucket;                  // バケットの大きさ[m]（干渉とみなす距離）
+    int cols;                       // バケットの列数
+    int rows;                       // バケットの行数
+    std::vector<size_t> start;      // バケット毎のセルの開始位置（cols*rows+1個）
+    std::vector<Vector2d> cells;    // バケット順に並べた障害物セルの中心
+
+    ObstacleCellIndex() : bucket(1.0), cols(0), rows(0) {}
+
+}stObstacleCellIndex;
+
 typedef actionlib::SimpleActionClient<move_base_msgs::MoveBaseAction> MoveBaseClient;
 
     /**
@@ -252,24 +404,35 @@ private:
     ros::Publisher pub_get_map;         // ロボットの地図情報取得用パブリッシャ
     ros::Publisher pub_get_layer_map;   // ロボットの環境地図に紐付くレイヤ地図取得用パブリッシャ
     ros::Publisher pub_get_map_correct_val;   // 地図の補正値の取得用パブリッシャ
+    ros::Publisher pub_state_detail;    // ロボットの状態報告の補足情報用パブリッシャ
+    ros::Publisher pub_diagnostics;     // ノードの計測値配信用パブリッシャ
+    ros::ServiceClient make_plan_client; // move_baseの経路探索サービスのクライアント
+    ros::Publisher pub_navi_estimate;   // 移動指示の到達可否判定結果配信用パブリッシャ
 
     // サブ
     ros::Subscriber sub_move_base_status;   // move_baseのステータス情報受信用サブスクライバ
     ros::Subscriber sub_command_recv;       // 移動指示コマンド受信用サブスクライバ
+    ros::Subscriber sub_route_command_recv; // 複数目的地の移動指示コマンド受信用サブスクライバ
     ros::Subscriber sub_battery_state_recv; // バッテリー情報受信用サブスクライバ
     ros::Subscriber sub_amclpose_recv;      // amcl_pose受信受信用サブスクライバ
     ros::Subscriber sub_emergency_recv;     // 緊急停止指示受信用サブスクライバ
     ros::Subscriber sub_sociomap;           // ソシオ地図サブスクライバ（2020/10/13追加）
     ros::Subscriber sub_position_recv;      // 初期位置の更新サブスクライバ
     ros::Subscriber sub_layermap_update_notifi;    // レイヤ地図の外部取得更新通知のサブスクライバ
+    ros::Subscriber sub_predictor_odom;     // 位置・向きの予測用のオドメトリ受信用サブスクライバ
     ros::Subscriber sub_correct_value;    // 地図の補正値情報のサブスクライバ
+    ros::Subscriber sub_follow_path;      // 追従経路のサブスクライバ
+    ros::Subscriber sub_global_plan;      // move_baseの大域経路のサブスクライバ
 
 
-    ros::Timer      status_send_timer;
-    ros::Timer      stuck_timer;	//stuckチェック用(2020/11/26追加)
-    ros::WallTimer  goal_timer;
+    ros::WallTimer  timer_wheel_tick;   // タイマーホイールの駆動用
+    TimerWheel      _timer_wheel;       // ステータス送信・スタックチェック・ゴール到達時のタイマー
+    int             status_send_timer;  // ステータス送信タイマー（タイマーホイールの番号）
+    int             stuck_timer;        //stuckチェック用(2020/11/26追加)（タイマーホイールの番号）
+    int             goal_timer;         // ゴール地点到達時のタイムアウトタイマー（タイマーホイールの番号）
+    int             replan_goal_timer;  // 経路の部分修正後のゴール再送信タイマー（タイマーホイールの番号）
 
-    tf::TransformListener tfl;
+    tf2_ros::Buffer *_tf_buffer;    // 座標変換バッファ（main()で生成し、ノード内で共有する）
     geometry_msgs::PoseWithCovarianceStamped _initial_pose;          // 初期位置
     geometry_msgs::Point                     _Past_Position;         // 過去の位置(2020/11/26追加)
     uoa_poc3_msgs::r_pose_optional          _current_destination;   // 現在の目的地(角度情報あり)
@@ -279,19 +442,62 @@ private:
     std::string _entityId;      // ロボットのユニークID
     std::string _entity_type;   // ロボットの種別の識別子
     std::string _global_map_frame_id;   // 地図のフレームID
+    std::string _base_frame_id;         // ロボットの基準フレーム名（entity_id/を除く）
+    std::vector<stPlatformPoint> _platform_footprint;               // 機種毎のfootprintのデフォルト値
+    stPlatformLimits _platform_limits;                              // 機種毎の速度制限
+    void (RobotNode::*_subscribe_battery)(ros::NodeHandle &node);   // 機種毎のバッテリー情報受信の登録
     std::string _environment_map_revision;  // 環境地図のリビジョン番号
     std::string _layer_map_revision;  // 環境地図のリビジョン番号
     std::string _navigation_map_source;  // ナビゲーション時の地図の取得先
 
     std::vector<stExclusionPoint> _exclusion_range_coordinate_list;   // 旋回対象外座標範囲リスト
     std::vector<uoa_poc3_msgs::r_corner> _footprint;               // footprint情報(2020/09/28追加)
-    std::list<uoa_poc3_msgs::r_pose_optional> _destinations;       // 目的値リスト
+    RingBuffer<stRouteStop> _destinations;                          // 目的値リスト（ルートの最大停止地点数で確保）
+    stRouteStop _current_stop;                                      // 現在の停止地点
+    std::vector<delivery_robot::r_route_stop_state> _route_progress; // ルート内の各停止地点の進捗
+    std::string _route_id;                                          // 実行中のルートの識別子
+    std::string _turn_heading_source;                               // 移動前の旋回の向きの求め方（TURN_HEADING_*）
+    Vector2d _turn_target;                                          // 移動前の旋回で向く地点（経路上の注視点または目的地）
+    geometry_msgs::PoseStamped _current_goal;                       // 走行中のmove_baseのゴール
+    std::vector<Vector2d> _follow_path;                             // 追従中の経路（内蔵の経路追従制御）
+    std::vector<Vector2d> _global_plan;                             // move_baseの走行中の大域経路
+    stSuspendSnapshot _suspend_snapshot;                            // サスペンド時の走行状態
+    ros::WallTime _resume_time;                                     // サスペンドからの再開時刻
+    bool _is_resume_pending;                                        // 再開後の走行開始待ちか
+    ros::WallTime _costmap_settle_start;                            // 走行開始時のコストマップの配信時刻
+    ros::WallTime _costmap_settle_until;                            // 走行開始時のコストマップの反映完了見込み時刻（未設定:反映待ちなし）
+    std::deque<stPendingNaviUpdate> _pending_navi_updates;          // 反映待ちのコストマップ更新
+    NodeMetrics _metrics;                                           // ノードの計測値
+    PoseCache _pose_cache;                                          // 位置・向きのキャッシュ（map→base_footprint）
+    PoseCache::LookupFunction _pose_lookup;                         // キャッシュの更新時の座標変換の取得
+    std::atomic<uint64_t> _tf_lookups;                              // 座標変換の取得回数
+    uint64_t _tf_lookups_prev;                                      // 前回の計測値配信時の座標変換の取得回数
+    ros::WallTime _tf_lookups_time;                                 // 前回の計測値配信の時刻
+    JitterHistogram _status_send_time;                              // 状態報告の処理時間の分布
+    double _status_pose_age;                                        // 直近の状態報告の位置・向きの経過時間[s]（-1:未取得）
+    bool _status_pose_extrapolated;                                 // 直近の状態報告の位置・向きをオドメトリで補間したか
+    double _status_pose_sigma_xy;                                   // 直近の状態報告の位置の標準偏差[m]（-1:予測を使用していない）
+    double _status_pose_sigma_yaw;                                  // 直近の状態報告の向きの標準偏差[rad]（-1:予測を使用していない）
+    PosePredictor _pose_predictor;                                  // オドメトリによる位置・向きの予測（到達判定・旋回・状態報告で使用）
+    ros::NodeHandle _predictor_nh;                                  // 位置・向きの予測用のオドメトリ受信用ノードハンドル
+    ros::CallbackQueue _predictor_queue;                            // 位置・向きの予測用のオドメトリ専用のコールバックキュー
+    std::unique_ptr<ros::AsyncSpinner> _predictor_spinner;          // オドメトリ専用のコールバックキューの処理スレッド
+    std::atomic<uint64_t> _predictor_odom_count;                    // 位置・向きの予測用のオドメトリの受信数
+    PathFollower _path_follower;                                    // 経路追従制御（naviノード使用時）
+    GridPlanner _grid_planner;                                      // 到達可否判定用の経路探索
+    stTurnControllerConfig _turn_config;                            // その場旋回の制御パラメータ
+    FootprintStencil _turn_stencil;                                 // その場旋回の衝突判定（回転済みfootprintマスク）
+    StuckDetector _stuck_detector;                                  // 位置の履歴によるスタック判定
+    std::atomic<bool> _stuck_sampling;                              // スタック判定の位置を取得中か（判定の開始で有効、停止で無効）
+    double _stuck_sample_time;                                      // スタック判定の位置を前回取得したオドメトリの時刻[s]（オドメトリ専用のスレッドのみ参照）
+    GoalApproachMonitor _goal_approach;                             // 目的地への接近の打ち切り判定
 
 
     bool _navi_flg;                 // 自動走行中かを判定
     bool _calibration_flg;          // キャリブレーション中かを判定
     bool _turn_busy_flg;            // 旋回中かを判定
     bool _navi_node;                // 自作ナビノードを使用するかどうか
+    bool _use_native_follower;      // naviノード使用時に内蔵の経路追従制御を使用するかどうか
     bool _goal_allowable_flg;       // goalポイント許容範囲圏内通知フラグ
     bool _update_current_destination; // 目的地更新フラグ(2020/10/05追加)
     bool _is_pub_ori_plan_costmap;  // オリジナルの経路コストマップはパブリッシュ済みか(2020/11/26追加)
@@ -300,10 +506,21 @@ private:
     bool _is_recv_static_map;       // 静的レイヤ地図受信フラグ
     bool _is_recv_quasi_static_map; // 準静的レイヤレイヤ地図受信フラグ
     bool _is_recv_exclusion_zone_map; // 侵入禁止レイヤ地図受信フラグ
+    bool _is_applying_navi_update;  // コストマップ更新の反映中フラグ
+    bool _use_feasibility_check;    // 移動指示の応答前に到達可否判定を行うか
+    bool _use_footprint_turn_check; // 旋回可否をfootprintと地図の照合で判定するか（false:旋回除外範囲のみ）
+    bool _use_stuck_detector;       // 位置の履歴によるスタック判定を行うか（false:一定時間毎の距離判定）
+    bool _use_adaptive_goal_timeout; // 目的地への接近を接近速度と距離の収束で打ち切るか（false:goal_allowable_timeの固定時間）
+    bool _use_pose_predictor;       // 現在の位置・向きをオドメトリで問い合わせ時刻まで予測するか（false:座標変換の値のまま）
+    bool _planner_use_jps;          // 到達可否判定の経路探索にJPSを使用するか（false:A*）
+    bool _planner_unknown_is_obstacle; // 到達可否判定で未知領域を障害物とみなすか
     char _cost_trans_table[256];    // コストの変換テーブル
     int8_t _replacing_cost;         // 送信するコストマップのコスト値
     int _move_base_sts;             // movebaseがゴールに着いたかを受信する
     int _move_base_status_id;       // move_baseのステータス値(2020/10/05追加)
+    int _route_max_stops;           // ルートの最大停止地点数
+    int _planner_occupied_threshold; // 到達可否判定で障害物とみなす占有値
+    unsigned int _costmap_generation; // 経路コストマップの配信毎に増える世代番号
     unsigned int _sociomap_width;   // ソシオ地図の幅(2020/10/13追加)
     unsigned int _sociomap_height;  // ソシオ地図の幅(2020/10/13追加)
     float _volt_sts;                // バッテリー電圧値
@@ -311,6 +528,8 @@ private:
     double _goal_tolerance_range;   // goalポイント許容範囲
     double _goal_allowable_range;   // ゴール地点到達時のタイムアウトタイマー開始半径
     double _goal_allowable_time;    // ゴール地点到達時のタイムアウト時間
+    double _goal_approach_prev_time;     // 接近の打ち切り判定の前回時刻[s]
+    double _goal_approach_prev_distance; // 接近の打ち切り判定の前回の目的地までの距離[m]
     double _goal_allowable_angle;   // ゴール地点到達時のangle許容角度
     double _g_covariance[36];       // 共分散値
     double _robot_radius;           // ロボットの幅(2020/09/28追加)
@@ -324,31 +543,73 @@ private:
     double _retry_time;             // 自己位置取得、地図取得のタイムアウト時間
     double _get_pose_timeout;   // 自己位置取得処理のタイムアウト時間
     double _get_map_timeout;    // 地図取得のタイムアウト時間
+    double _layer_map_timeout;  // レイヤ毎の地図取得要求の応答待ち時間
     double _get_correct_val_timeout;    // 地図取得のタイムアウト時間
+    double _planner_resolution;     // 到達可否判定の探索グリッドの解像度[m]
+    double _planner_nominal_speed;  // 到達予想時間算出用の平均速度[m/s]
+    double _turn_heading_lookahead; // 移動前の旋回で向く経路上の注視点までの距離[m]
+    double _resume_position_tolerance; // 走行中の経路で再開する位置のずれの上限[m]
+    double _resume_angle_tolerance; // 走行中の経路で再開する向きのずれの上限[rad]
+    double _replan_margin;          // コストマップ更新時に経路を部分修正する際の塞がれた区間の前後の範囲[m]
+    bool _use_incremental_replan;   // コストマップ更新時に走行中の経路を検査・部分修正し、停止せずに走行を継続するか
+    double _costmap_settle_time;    // 走行開始時にコストマップの反映を待つ時間[s]
+    bool _use_pipelined_start;      // コストマップの反映待ちと移動前の旋回を並行して行うか
+    bool _calibration_early_exit;   // 位置推定の収束でキャリブレーションの旋回を打ち切るか
+    double _calibration_settle_time;        // 旋回前に地図・初期位置の反映を待つ最長時間[s]
+    double _calibration_min_settle_time;    // 旋回前に待つ最短時間[s]
+    double _calibration_settle_wait;        // 旋回前に待った時間[s]
+    double _calibration_xy_variance;        // 位置推定の収束とみなすx・yの分散[m^2]
+    double _calibration_yaw_variance;       // 位置推定の収束とみなすyawの分散[rad^2]
+    double _calibration_min_rotation;       // 収束の判定を始める旋回量[rad]
+    double _calibration_max_rotation;       // 旋回量の上限[rad]
+    int _calibration_min_updates;           // 収束の判定に必要な旋回開始後のamcl_poseの受信数
+    unsigned long _amcl_pose_count;         // amcl_poseの受信数
 public:
     /**
     * @brief        RobotNodeクラスのコンストラクタ
     * @param[in]    RobotDriver& driver　RobotDriverオブジェクトのポインタ
+    * @param[in]    tf2_ros::Buffer& tf_buffer 共有の座標変換バッファ
     * @return       void
     * @details      初期化を行う
     */
-    RobotNode(RobotDriver& driver)
+    RobotNode(RobotDriver& driver, tf2_ros::Buffer& tf_buffer)
     {
         _driver = &driver;
+        _tf_buffer = &tf_buffer;
 
         _volt_sts = -FLT_MAX;
 
         _mode_status = MODE_STANDBY;
         _navi_flg = false;
         _calibration_flg = true;
+        _calibration_settle_wait = 0.0;
+        _tf_lookups = 0;
+        _status_pose_age = -1.0;
+        _status_pose_extrapolated = false;
+        _status_pose_sigma_xy = -1.0;
+        _status_pose_sigma_yaw = -1.0;
+        _predictor_odom_count = 0;
+        _stuck_sampling = false;
+        _stuck_sample_time = 0.0;
+        _tf_lookups_prev = 0;
+        _pose_lookup = [this](stCachedPose& pose)
+        {
+            return lookupRobotPose(pose);
+        };
+        _amcl_pose_count = 0;
         _move_base_sts = MOVE_BASE_PENDING;
         _goal_allowable_flg = false;
+        _goal_approach_prev_time = 0.0;
+        _costmap_generation = 0;
+        _is_resume_pending = false;
+        _goal_approach_prev_distance = 0.0;
         _turn_busy_flg = false;
         _is_pub_ori_plan_costmap = false;
         _is_recv_position = false;
         _is_recv_static_map = false;
         _is_recv_quasi_static_map   = false;
         _is_recv_exclusion_zone_map = false;
+        _is_applying_navi_update    = false;
 
         // 共分散値
         memset( &_g_covariance, 0, sizeof(_g_covariance)); 
@@ -391,6 +652,10 @@ public:
         // 置き換えるコストの初期化
         _replacing_cost = STUCK_AVOID_COST;
 
+        // 停止地点の初期化
+        _current_stop.dwell_time  = 0.0;
+        _current_stop.route_index = -1;
+
     }
 
     /**
@@ -443,6 +708,12 @@ public:
         {
             _entity_type = DEFAULT_ROBOT_TYPE;
         }
+        // 機種毎のポリシーの適用（バッテリー情報・速度制限・フレーム名・footprintのデフォルト値）
+        if(!bindRobotPlatform(_entity_type, *this))
+        {
+            ROS_WARN("unknown entity_type (%s), use %s platform", _entity_type.c_str(), ROBOT_PLATFORM_FALLBACK);
+        }
+        getParam(privateNode, "base_frame_id", _base_frame_id, _base_frame_id);
         
         // naviノード使用の可否読み込み
         if (privateNode.getParam("navi_node", _navi_node))
@@ -463,6 +734,10 @@ public:
             ROS_INFO("_navi_node==false");
         }
 
+        // 内蔵の経路追従制御の使用可否読み込み（naviノード使用時のみ有効）
+        getParam(privateNode, "use_native_follower", _use_native_follower, false);
+        _use_native_follower = _use_native_follower && _navi_node;
+
         // wayポイント停止時間の読み込み
         if (privateNode.getParam("wp_sleep_time", _wp_sleep_time))
         {
@@ -502,6 +777,17 @@ public:
         {
             _goal_allowable_time = 4;//[sec]
         }
+        // 目的地への接近の打ち切り判定
+        stGoalApproachConfig approach_config;
+        getParam(privateNode, "use_adaptive_goal_timeout", _use_adaptive_goal_timeout,         true);
+        getParam(privateNode, "goal_timeout_min",          approach_config.min_timeout,        approach_config.min_timeout);
+        getParam(privateNode, "goal_timeout_max",          approach_config.max_timeout,        _goal_allowable_time * 2.0);
+        getParam(privateNode, "goal_timeout_margin",       approach_config.margin,             approach_config.margin);
+        getParam(privateNode, "goal_converge_time",        approach_config.converge_time,      approach_config.converge_time);
+        getParam(privateNode, "goal_converge_distance",    approach_config.converge_distance,  approach_config.converge_distance);
+        getParam(privateNode, "goal_converge_yaw_rate",    approach_config.rotate_yaw_rate,    approach_config.rotate_yaw_rate);
+        approach_config.tolerance = _goal_tolerance_range;
+        _goal_approach.configure(approach_config);
 
         // ゴール地点のangleの許容角度
         if (privateNode.getParam("goal_allowable_angle", _goal_allowable_angle))
@@ -530,6 +816,18 @@ public:
         {
             _stuck_threshold_length = 0.1;  // 半径10cm
         }
+        // 位置の履歴によるスタック判定
+        stStuckDetectorConfig stuck_config;
+        getParam(privateNode, "use_stuck_detector",       _use_stuck_detector,            true);
+        getParam(privateNode, "stuck_window_short",       stuck_config.windows[0],        stuck_config.windows[0]);
+        getParam(privateNode, "stuck_window_middle",      stuck_config.windows[1],        stuck_config.windows[1]);
+        getParam(privateNode, "stuck_window_long",        stuck_config.windows[2],        stuck_config.windows[2]);
+        getParam(privateNode, "stuck_sample_period",      stuck_config.sample_period,     stuck_config.sample_period);
+        getParam(privateNode, "stuck_min_speed",          stuck_config.min_speed,         stuck_config.min_speed);
+        getParam(privateNode, "stuck_min_yaw_rate",       stuck_config.min_yaw_rate,      stuck_config.min_yaw_rate);
+        getParam(privateNode, "stuck_confidence",         stuck_config.confidence,        stuck_config.confidence);
+        getParam(privateNode, "stuck_cooldown",           stuck_config.cooldown,          stuck_config.cooldown);
+        _stuck_detector.configure(stuck_config);
 
         // 2020/09/28追加
         // ロボットのfootprint情報読み込み
@@ -579,11 +877,11 @@ public:
         // デフォルトパラメータの読み込み
         if(!isReadParam)   
         { //パラメータ読み込み失敗
-            double footprint_def[4][2]  = {{-0.205, -0.155}, {-0.205, 0.155}, {0.077, 0.0155}, {0.077, -0.0155}};
-            for(int i=0; i<4; i++)
+            _footprint.clear();
+            for(size_t i=0; i<_platform_footprint.size(); i++)
             {
-                footprint_.x = footprint_def[i][0];
-                footprint_.y = footprint_def[i][1];
+                footprint_.x = _platform_footprint[i].x;
+                footprint_.y = _platform_footprint[i].y;
                 _footprint.push_back(footprint_);
             }
         }
@@ -618,6 +916,16 @@ public:
             _navigation_turn_speed = 0.4;  // 0.4[rad/sec]
         }
 
+        // その場旋回の制御パラメータ（最大旋回速度の既定値は目的地への旋回速度）
+        getParam(privateNode, "turn_max_angular_vel",   _turn_config.max_angular_vel,   _navigation_turn_speed);
+        getParam(privateNode, "turn_max_angular_accel", _turn_config.max_angular_accel, _turn_config.max_angular_accel);
+        getParam(privateNode, "turn_min_angular_vel",   _turn_config.min_angular_vel,   _turn_config.min_angular_vel);
+        getParam(privateNode, "turn_kp",                _turn_config.kp,                _turn_config.kp);
+        if(_turn_config.max_angular_accel <= 0)
+        {
+            _turn_config.max_angular_accel = TurnControllerConfig().max_angular_accel;
+        }
+
         stExclusionPoint exclusion_range_coordinate; // 旋回除外範囲の座標
         XmlRpc::XmlRpcValue exclusion_range_member;
         isReadParam = true; // パラメータ読み込み成功フラグ
@@ -678,6 +986,22 @@ public:
                 _exclusion_range_coordinate_list.push_back(def_exclusion_range_coordinate[i]);
             }
         }
+
+        // その場旋回の衝突判定用footprintマスクの作成
+        int turn_check_headings;
+        double turn_check_resolution;
+        getParam(privateNode, "use_footprint_turn_check", _use_footprint_turn_check, true);
+        getParam(privateNode, "turn_check_headings",      turn_check_headings,       DEF_TURN_CHECK_HEADINGS);
+        getParam(privateNode, "turn_check_resolution",    turn_check_resolution,     DEF_TURN_CHECK_RESOLUTION);
+        if(_use_footprint_turn_check)
+        {
+            std::vector<Vector2d> footprint;
+            for(size_t i = 0; i < _footprint.size(); i++)
+            {
+                footprint.push_back(Vector2d(_footprint[i].x, _footprint[i].y));
+            }
+            _turn_stencil.build(footprint, turn_check_resolution, turn_check_headings);
+        }
  
         // リトライ間隔時間
         if (privateNode.getParam("retry_time", _retry_time))
@@ -711,9 +1035,74 @@ public:
         {
             _get_map_timeout = 60.0;  // 5.0[sec]
         }
+        getParam(privateNode, "layer_map_timeout", _layer_map_timeout, DEF_LAYER_MAP_TIMEOUT);
 
         // 初期地図の取得先
         getParam(privateNode, "navigation_map_source", _navigation_map_source, std::string("internal"));
+
+        // ルートの最大停止地点数
+        getParam(privateNode, "route_max_stops", _route_max_stops, DEF_ROUTE_MAX_STOPS);
+        if(_route_max_stops < 1)
+        {
+            _route_max_stops = DEF_ROUTE_MAX_STOPS;
+        }
+        _destinations.reserve(_route_max_stops + 1); // 一時停止時に現在の目的地を戻す分を確保
+        _route_progress.reserve(_route_max_stops);
+
+        // 到達可否判定（経路探索）
+        double planner_time_budget, planner_heuristic_weight;
+        getParam(privateNode, "use_feasibility_check",          _use_feasibility_check,         true);
+        getParam(privateNode, "planner_use_jps",                _planner_use_jps,               true);
+        getParam(privateNode, "planner_resolution",             _planner_resolution,            DEF_PLANNER_RESOLUTION);
+        getParam(privateNode, "planner_occupied_threshold",     _planner_occupied_threshold,    DEF_PLANNER_OCCUPIED_THRESHOLD);
+        getParam(privateNode, "planner_unknown_is_obstacle",    _planner_unknown_is_obstacle,   true);
+        getParam(privateNode, "planner_time_budget",            planner_time_budget,            DEF_PLANNER_TIME_BUDGET);
+        getParam(privateNode, "planner_heuristic_weight",       planner_heuristic_weight,       1.0);
+        getParam(privateNode, "planner_nominal_speed",          _planner_nominal_speed,         DEF_PLANNER_NOMINAL_SPEED);
+        if(_planner_nominal_speed <= 0)
+        {
+            _planner_nominal_speed = DEF_PLANNER_NOMINAL_SPEED;
+        }
+        _grid_planner.setTimeBudget(planner_time_budget);
+        _grid_planner.setHeuristicWeight(planner_heuristic_weight);
+
+        // 移動前の旋回の向き（経路の最初の区間の方向）
+        getParam(privateNode, "turn_heading_source",    _turn_heading_source,     std::string(TURN_HEADING_GRID));
+        getParam(privateNode, "turn_heading_lookahead", _turn_heading_lookahead,  DEF_TURN_HEADING_LOOKAHEAD);
+
+        // サスペンドからの再開（位置・向きがずれていなければ旋回せずに走行中の経路で再開する）
+        getParam(privateNode, "resume_position_tolerance", _resume_position_tolerance, DEF_RESUME_POSITION_TOLERANCE);
+        getParam(privateNode, "resume_angle_tolerance",    _resume_angle_tolerance,    DEF_RESUME_ANGLE_TOLERANCE);
+
+        // コストマップ更新時の経路の部分修正
+        getParam(privateNode, "use_incremental_replan",    _use_incremental_replan,    true);
+        getParam(privateNode, "replan_margin",             _replan_margin,             DEF_REPLAN_MARGIN);
+
+        // 走行開始時のコストマップ反映待ち（並行時は移動前の旋回の間に反映を待ち、両方の完了後にゴールを配信する）
+        getParam(privateNode, "costmap_settle_time",       _costmap_settle_time,       DEF_COSTMAP_SETTLE_TIME);
+        getParam(privateNode, "use_pipelined_start",       _use_pipelined_start,       true);
+
+        // 位置・向きのキャッシュ（座標変換の取得は周期に1回とし、各処理はキャッシュから読み出す）
+        double pose_cache_period, pose_cache_max_age;
+        getParam(privateNode, "pose_cache_period",         pose_cache_period,          DEF_POSE_CACHE_PERIOD);
+        getParam(privateNode, "pose_cache_max_age",        pose_cache_max_age,         DEF_POSE_CACHE_MAX_AGE);
+        _pose_cache.configure(pose_cache_period, pose_cache_max_age);
+
+        // オドメトリによる位置・向きの予測（到達判定・旋回・状態報告の位置を問い合わせ時刻まで進める）
+        getParam(privateNode, "use_pose_predictor",        _use_pose_predictor,        true);
+
+        // 起動時のキャリブレーション（位置推定の分散が閾値を下回った時点で旋回を打ち切る）
+        double min_rotation_deg, max_rotation_deg;
+        getParam(privateNode, "calibration_early_exit",         _calibration_early_exit,        true);
+        getParam(privateNode, "calibration_settle_time",        _calibration_settle_time,       DEF_CALIBRATION_SETTLE_TIME);
+        getParam(privateNode, "calibration_min_settle_time",    _calibration_min_settle_time,   DEF_CALIBRATION_MIN_SETTLE_TIME);
+        getParam(privateNode, "calibration_xy_variance",        _calibration_xy_variance,       DEF_CALIBRATION_XY_VARIANCE);
+        getParam(privateNode, "calibration_yaw_variance",       _calibration_yaw_variance,      DEF_CALIBRATION_YAW_VARIANCE);
+        getParam(privateNode, "calibration_min_updates",        _calibration_min_updates,       DEF_CALIBRATION_MIN_UPDATES);
+        getParam(privateNode, "calibration_min_rotation",       min_rotation_deg,               0.0);
+        getParam(privateNode, "calibration_max_rotation",       max_rotation_deg,               (double)ANGLE_OF_360_DEGREES);
+        _calibration_min_rotation = DEG2RAD(min_rotation_deg);
+        _calibration_max_rotation = DEG2RAD(max_rotation_deg);
         
         // --- パブ ---
         // 初期位置
@@ -722,9 +1111,14 @@ public:
         pub_cancel = node.advertise<actionlib_msgs::GoalID>("/" + _entityId + "/move_base/cancel", ROS_QUEUE_SIZE_5, true);
         // goal
         pub_goal = node.advertise<geometry_msgs::PoseStamped>("/" + _entityId + "/move_base_simple/goal", ROS_QUEUE_SIZE_5, false);
+        // move_baseの経路探索（移動前の旋回の向きの算出用）
+        if(_turn_heading_source == TURN_HEADING_MOVE_BASE)
+        {
+            make_plan_client = node.serviceClient<nav_msgs::GetPlan>("/" + _entityId + "/move_base/make_plan");
+        }
         // ロボットステータス
         pub_robot_sts = node.advertise<uoa_poc3_msgs::r_state>("/state", ROS_QUEUE_SIZE_10, true);
-        status_send_timer = node.createTimer(ros::Duration(ROS_TIME_1S), &RobotNode::robotStatusSend, this, false, false);// 1Hz
+        status_send_timer = _timer_wheel.add("status_send", ROS_TIME_1S, false, std::bind(&RobotNode::robotStatusSend, this));// 1Hz
         // answer
         pub_answer = node.advertise<uoa_poc3_msgs::r_navi_result>("/navi_cmdexe", ROS_QUEUE_SIZE_100, false); // 2020/09/30修正
         // 緊急停止応答
@@ -736,345 +1130,1489 @@ public:
         // 初期位置情報取得
         pub_get_position = node.advertise<uoa_poc5_msgs::r_get_position_data>("/robot_bridge/" + _entityId + "/get_position_data", ROS_QUEUE_SIZE_1, true);
         // ロボットの地図情報取得用パブリッシャ
-        pub_get_map = node.advertise<uoa_poc5_msgs::r_get_mapdata>("/robot_bridge/" + _entityId + "/get_map_data", ROS_QUEUE_SIZE_1, true);
+        pub_get_map = node.advertise<uoa_poc5_msgs::r_get_mapdata>("/robot_bridge/" + _entityId + "/get_map_data", ROS_QUEUE_SIZE_10, true);
         // ロボットの環境地図に紐付くレイヤ地図取得用パブリッシャ
-        pub_get_layer_map = node.advertise<uoa_poc5_msgs::r_get_mapdata>("/robot_bridge/" + _entityId + "/get_layer_map_data", ROS_QUEUE_SIZE_1, true);
+        pub_get_layer_map = node.advertise<uoa_poc5_msgs::r_get_mapdata>("/robot_bridge/" + _entityId + "/get_layer_map_data", ROS_QUEUE_SIZE_10, true);
         // 地図の補正値取得指令のパブリッシャ
         pub_get_map_correct_val = node.advertise<uoa_poc6_msgs::r_get_map_pose_correct>("/" + _entityId + "/robot_bridge/get_correction_value", ROS_QUEUE_SIZE_1, true);
+        // ロボットステータスの補足情報
+        pub_state_detail = node.advertise<delivery_robot::r_state_detail>("/state_detail", ROS_QUEUE_SIZE_10, true);
+        // ノードの計測値
+        pub_diagnostics = node.advertise<diagnostic_msgs::DiagnosticArray>("/diagnostics", ROS_QUEUE_SIZE_10, false);
+        // 移動指示の到達可否判定結果
+        pub_navi_estimate = node.advertise<delivery_robot::r_navi_estimate>("/navi_cmdexe_estimate", ROS_QUEUE_SIZE_100, false);
 
         // --- サブ ---
         // move_baseステータス
         sub_move_base_status = node.subscribe("/" + _entityId + "/move_base/status", ROS_QUEUE_SIZE_10, &RobotNode::movebaseStatusRecv, this);
         // 移動指示受信
         sub_command_recv = node.subscribe("/navi_cmd", ROS_QUEUE_SIZE_10, &RobotNode::commandRecv, this);
+        // 複数目的地の移動指示受信
+        sub_route_command_recv = node.subscribe("/navi_route_cmd", ROS_QUEUE_SIZE_10, &RobotNode::routeCommandRecv, this);
         // バッテリーステータス受信
-        if( _entity_type == DEFAULT_ROBOT_TYPE ){
-            sub_battery_state_recv = node.subscribe("/" + _entityId + "/battery_state", ROS_QUEUE_SIZE_10, &RobotNode::batteryStateRecv, this);
-        }else{
-            sub_battery_state_recv = node.subscribe("/" + _entityId + "/rover_sensor", ROS_QUEUE_SIZE_10, &RobotNode::batteryStateRecvMr, this);
-        }
+        (this->*_subscribe_battery)(node);
         // amcl_pose受信
         sub_amclpose_recv = node.subscribe("/" + _entityId + "/amcl_pose", ROS_QUEUE_SIZE_10, &RobotNode::amclPoseRecv, this);
         // 緊急停止受信
         sub_emergency_recv = node.subscribe("/emg", ROS_QUEUE_SIZE_10, &RobotNode::emergencyRecv, this);
         // ゴール地点到達時のタイムアウトタイマー
-        goal_timer = node.createWallTimer(ros::WallDuration(_goal_allowable_time), &RobotNode::goal_allowable_time, this, true, false);
+        goal_timer = _timer_wheel.add("goal", _goal_allowable_time, true, std::bind(&RobotNode::goal_allowable_time, this));
+        // 経路の部分修正後のゴール再送信（コストマップの反映を待ってから、走行は止めない）
+        replan_goal_timer = _timer_wheel.add("replan_goal", _costmap_settle_time, true, std::bind(&RobotNode::replanGoalResend, this));
         // ソシオ地図受信
         sub_sociomap = node.subscribe("/" + _entityId + "/map_movebase", ROS_QUEUE_SIZE_10 ,  &RobotNode::sociomapRecv, this);
         // 位置情報の受信
         sub_position_recv = node.subscribe("/" + _entityId + "/initialpose", ROS_QUEUE_SIZE_1 ,  &RobotNode::positionDataRecv, this);
         // レイヤ地図の外部取得更新通知
-        sub_layermap_update_notifi   = node.subscribe( "/layer_map_update_notify",   ROS_QUEUE_SIZE_1, &RobotNode::layerMapUpdateNotifyRecv, this);
+        sub_layermap_update_notifi   = node.subscribe( "/layer_map_update_notify",   ROS_QUEUE_SIZE_10, &RobotNode::layerMapUpdateNotifyRecv, this);
         //　スタックチェックタイマー
-        stuck_timer = node.createTimer(ros::Duration(_stuck_check_time), &RobotNode::robotStuckCheck, this, false, false);
+        if(_use_stuck_detector)
+        { // 位置の取得周期で履歴を更新して判定
+            stuck_timer = _timer_wheel.add("stuck", _stuck_detector.config().sample_period, false, std::bind(&RobotNode::robotStuckDetect, this));
+        }
+        else
+        {
+            stuck_timer = _timer_wheel.add("stuck", _stuck_check_time, false, std::bind(&RobotNode::robotStuckCheck, this));
+        }
+        // タイマーホイールの駆動（コールバックは他の受信処理と同じスレッドで実行する）
+        timer_wheel_tick = node.createWallTimer(ros::WallDuration(DEF_TIMER_WHEEL_TICK), &RobotNode::timerWheelTick, this);
+        // move_baseの大域経路の受信（コストマップ更新時の経路の検査用、内蔵の経路追従制御の場合は追従経路を使用）
+        if(_use_incremental_replan && !_use_native_follower)
+        {
+            std::string global_plan_topic;
+            getParam(privateNode, "global_plan_topic", global_plan_topic, std::string(""));
+            if(global_plan_topic.empty())
+            {
+                global_plan_topic = "/" + _entityId + "/move_base/NavfnROS/plan";
+            }
+            sub_global_plan = node.subscribe(global_plan_topic, ROS_QUEUE_SIZE_1, &RobotNode::globalPlanRecv, this);
+        }
         // 補正値取得結果の受信
         sub_correct_value = node.subscribe("/" + _entityId + "/robot_bridge/correction_value", ROS_QUEUE_SIZE_1, &RobotNode::correctValueRecv, this);
 
+        // オドメトリによる位置・向きの予測（経路追従制御の開始前に受信を始める）
+        if(_use_pose_predictor)
+        {
+            setupPosePredictor(node, privateNode);
+        }
+
+        // 内蔵の経路追従制御
+        if(_use_native_follower)
+        {
+            setupPathFollower(node, privateNode);
+        }
+
         return(true);
     }
 
     //--------------------------------------------------------------------------
-    //  ソシオ地図受信
+    //  位置・向きの予測の初期設定
     //--------------------------------------------------------------------------
     /**
-     * @brief       ロボットのソシオ地図の受信処理
-     * @param[in]   const nav_msgs::OccupancyGrid& msg 地図データ
+     * @brief       オドメトリによる位置・向きの予測の初期設定処理
+     * @param[in]   ros::NodeHandle &node           ノードハンドル
+     * @param[in]   ros::NodeHandle &privateNode    パラメータ読み込み用ノードハンドル
      * @return      void
+     * @details     オドメトリは専用キューで受け、専用スレッドで予測の履歴に追加する（メインループの周期に左右されない）
      */
-    void sociomapRecv(const nav_msgs::OccupancyGrid& msg)
+    void setupPosePredictor(ros::NodeHandle &node, ros::NodeHandle &privateNode)
     {
-        _sociomap_width         = msg.info.width;  //ソシオ地図の高さ
-        _sociomap_height        = msg.info.height; //ソシオ地図の幅
-        _sociomap_resolution    = (double)msg.info.resolution; //ソシオ地図の解像度
-        _sociomap_origin_x      = msg.info.origin.position.x; //ソシオ地図の原点のx座標
-        _sociomap_origin_y      = msg.info.origin.position.y; //ソシオ地図の原点のy座標
-        
+        stPosePredictorConfig config;
+        std::string odom_topic;
+
+        getParam(privateNode, "predictor_max_extrapolation",    config.max_extrapolation,   config.max_extrapolation);
+        getParam(privateNode, "predictor_odom_trans_noise",     config.odom_trans_noise,    config.odom_trans_noise);
+        getParam(privateNode, "predictor_odom_rot_noise",       config.odom_rot_noise,      config.odom_rot_noise);
+        getParam(privateNode, "predictor_extrapolation_noise",  config.extrapolation_noise, config.extrapolation_noise);
+        getParam(privateNode, "odom_topic",                     odom_topic,                 std::string(DEFAULT_ODOM_TOPIC));
+        _pose_predictor.configure(config);
+        _pose_predictor.setAnchorVariance(std::max(_g_covariance[0], _g_covariance[7]), _g_covariance[35]);
+
+        _predictor_nh = node;
+        _predictor_nh.setCallbackQueue(&_predictor_queue);
+        sub_predictor_odom = _predictor_nh.subscribe(_entityId + "/" + odom_topic, DEF_PREDICTOR_ODOM_QUEUE_SIZE, &RobotNode::predictorOdomRecv, this);
+        _predictor_spinner.reset(new ros::AsyncSpinner(1, &_predictor_queue));
+        _predictor_spinner->start();
+
+        ROS_INFO("pose predictor started odom topic: %s", odom_topic.c_str());
+
         return;
     }
 
-    //--------------------------------------------------------------------------
-    //  空のコストマップの送信
-    //--------------------------------------------------------------------------
     /**
-     * @brief       空のコストマップの配信処理
-     * @param[in]   void
+     * @brief       位置・向きの予測用のオドメトリ受信処理（オドメトリ専用のスレッドで実行）
+     * @param[in]   const nav_msgs::Odometry& msg  オドメトリ
      * @return      void
      */
-    void emptyCostmapSend(void)
+    void predictorOdomRecv(const nav_msgs::Odometry& msg)
     {
-        nav_msgs::OccupancyGrid empty_cost_map; //パブリッシュする空の経路コストマップ（OccupancyGrid型）
-        unsigned int map_size = _sociomap_width * _sociomap_height; //コストマップのサイズを求める
-        
-        //コストマップの情報をセット
-        empty_cost_map.header.stamp             = ros::Time::now();
-		empty_cost_map.header.frame_id          = _global_map_frame_id; // frame_id = map
-        empty_cost_map.info.resolution          = _sociomap_resolution; //コストマップの解像度
-        empty_cost_map.info.width               = _sociomap_width;  //コストマップの幅
-        empty_cost_map.info.height              = _sociomap_height;  //コストマップの高さ
-        empty_cost_map.info.origin.position.x   = _sociomap_origin_x; //mapの原点座標
-        empty_cost_map.info.origin.position.y   = _sociomap_origin_y; //mapの原点座標
+        stPredictorOdom odom;
+        odom.stamp   = msg.header.stamp.toSec();
+        odom.x       = msg.pose.pose.position.x;
+        odom.y       = msg.pose.pose.position.y;
+        odom.yaw     = tf2::getYaw(msg.pose.pose.orientation);
+        odom.linear  = msg.twist.twist.linear.x;
+        odom.angular = msg.twist.twist.angular.z;
+        _pose_predictor.addOdometry(odom);
+        _predictor_odom_count++;
+
+        // スタック判定の位置の取得（位置の履歴の生産者）。取得周期毎に予測した地図座標系の位置を渡す
+        if(_stuck_sampling && odom.stamp - _stuck_sample_time >= _stuck_detector.config().sample_period)
+        {
+            stPredictedPose predicted;
+            if(_pose_predictor.predict(odom.stamp, predicted))
+            {
+                _stuck_sample_time = odom.stamp;
+                if(!_stuck_detector.push(stStuckSample(odom.stamp, predicted.x, predicted.y, predicted.yaw)))
+                {
+                    _metrics.add("stuck_sample_dropped");
+                }
+            }
+        }
 
-        // コストマップのリサイズ
-        empty_cost_map.data.resize(map_size);
+        return;
+    }
 
-        // コストを0で埋める
-        for(int idx = 0; idx < map_size; idx++)
+    //--------------------------------------------------------------------------
+    //  経路追従制御の初期設定
+    //--------------------------------------------------------------------------
+    /**
+     * @brief       内蔵の経路追従制御の初期設定処理
+     * @param[in]   ros::NodeHandle &node           ノードハンドル
+     * @param[in]   ros::NodeHandle &privateNode    パラメータ読み込み用ノードハンドル
+     * @return      void
+     * @details     追従経路を受信するサブスクライバを設定し、制御スレッドを開始する
+     */
+    void setupPathFollower(ros::NodeHandle &node, ros::NodeHandle &privateNode)
+    {
+        stPathFollowerConfig config;
+        std::string path_topic;
+
+        getParam(privateNode, "follower_control_rate",           config.control_rate,            config.control_rate);
+        getParam(privateNode, "follower_desired_linear_vel",     config.desired_linear_vel,      config.desired_linear_vel);
+        getParam(privateNode, "follower_lookahead_time",         config.lookahead_time,          config.lookahead_time);
+        getParam(privateNode, "follower_min_lookahead",          config.min_lookahead,           config.min_lookahead);
+        getParam(privateNode, "follower_max_lookahead",          config.max_lookahead,           config.max_lookahead);
+        getParam(privateNode, "follower_max_angular_vel",        config.max_angular_vel,         config.max_angular_vel);
+        getParam(privateNode, "follower_rotate_to_heading_angle", config.rotate_to_heading_angle, config.rotate_to_heading_angle);
+        getParam(privateNode, "follower_regulated_min_radius",   config.regulated_min_radius,    config.regulated_min_radius);
+        getParam(privateNode, "follower_approach_dist",          config.approach_dist,           config.approach_dist);
+        getParam(privateNode, "follower_min_approach_vel",       config.min_approach_vel,        config.min_approach_vel);
+        getParam(privateNode, "follower_path_topic",             path_topic,                     std::string("/" + _entityId + "/follow_path"));
+        config.goal_tolerance = _goal_tolerance_range;
+        config.desired_linear_vel = std::min(config.desired_linear_vel, _platform_limits.max_linear_vel);
+        config.max_angular_vel = std::min(config.max_angular_vel, _platform_limits.max_angular_vel);
+        getParam(privateNode, "realtime_mode",                   config.realtime.enable,         config.realtime.enable);
+        getParam(privateNode, "realtime_priority",               config.realtime.priority,       config.realtime.priority);
+        getParam(privateNode, "realtime_cpu",                    config.realtime.cpu,            config.realtime.cpu);
+
+        if(config.control_rate <= 0)
         {
-            empty_cost_map.data[idx] = FREESPACE_COST_GRIDMAP;    //コスト変換テーブルを参照し、コストの値(0~255)に対応する値(-1~100)を取り出す
+            config.control_rate = ROS_RATE_20HZ;
         }
 
-        // コストマップをパブリッシュ
-        pub_plan_costmap.publish(empty_cost_map);
+        // 追従経路の受信
+        sub_follow_path = node.subscribe(path_topic, ROS_QUEUE_SIZE_1, &RobotNode::followPathRecv, this);
 
-        _is_pub_ori_plan_costmap = false; // オリジナルの経路コストマップは未パブリッシュ
+        // 制御スレッドの開始
+        _path_follower.start(config,
+            [this](double& x, double& y, double& yaw)
+            {
+                return currentPose(x, y, yaw);
+            },
+            [this](double linear_vel, double angular_vel)
+            {
+                _driver->moveVelocity(linear_vel, angular_vel);
+            });
+
+        ROS_INFO("native path follower started (%f Hz) path topic: %s", config.control_rate, path_topic.c_str());
 
         return;
     }
 
     //--------------------------------------------------------------------------
-    //  コストマップの送信
+    //  追従経路受信
     //--------------------------------------------------------------------------
     /**
-     * @brief       コストマップの配信処理
-     * @param[in]   const uoa_poc3_msgs::r_costmap costmap_data　コストマップのデータ
+     * @brief       追従経路の受信処理
+     * @param[in]   const nav_msgs::Path& msg 追従経路
      * @return      void
      */
-    void costmapSend(const uoa_poc3_msgs::r_costmap costmap_data)
+    void followPathRecv(const nav_msgs::Path& msg)
     {
-        /* コストマップデータを変換(r_costmap → OccupancyGrid)し/plan_costmapとしてパブリッシュする */
-        nav_msgs::OccupancyGrid plan_cost_grid_map; //他ロボットの経路コストマップ（OccupancyGrid型）
-        unsigned int costmap_width              = costmap_data.width; //コストマップの幅
-        unsigned int costmap_height             = costmap_data.height; //コストマップの高さ
-        unsigned int map_size                   = costmap_width * costmap_height; //コストマップのサイズを求める
-        unsigned int cost_table_idx             = 0;
-        float costmap_resolution                = (float)costmap_data.resolution; // 解像度
-        uoa_poc3_msgs::r_pose costmap_origin   = costmap_data.origin; //原点座標
-
-        //コストマップの情報をセット
-        plan_cost_grid_map.header.stamp         = ros::Time::now();
-		plan_cost_grid_map.header.frame_id      = _global_map_frame_id; // frame_id = map
-        plan_cost_grid_map.info.resolution      = costmap_resolution; //コストマップの解像度
-        plan_cost_grid_map.info.width           = costmap_width;
-        plan_cost_grid_map.info.height          = costmap_height;
-        plan_cost_grid_map.info.origin.position = costmap_origin.point; //mapの原点座標
-
-        plan_cost_grid_map.data.resize(costmap_width * costmap_height);
+        if(_mode_status != MODE_NAVI || _navi_flg == false || msg.poses.empty())
+        { // ナビ走行中以外は無視
+            return;
+        }
 
-        // コストの変換（0~255→-1~100）
-        for(int idx = 0; idx < map_size; idx++)
+        // 経路の終点が現在の目的地か
+        const geometry_msgs::Point& end_point = msg.poses.back().pose.position;
+        if(hypot(end_point.x - _current_destination.point.x, end_point.y - _current_destination.point.y) > _goal_allowable_range)
         {
-            cost_table_idx = costmap_data.cost_value[idx];    // コスト値を取り出す
-            plan_cost_grid_map.data[idx] = _cost_trans_table[cost_table_idx];    //コスト変換テーブルを参照し、コストの値(0~255)に対応する値(-1~100)を取り出す
+            ROS_WARN("followPathRecv ignore because the path does not end at the current destination");
+            return;
         }
 
-        // コストマップをパブリッシュ
-        pub_plan_costmap.publish(plan_cost_grid_map);
+        std::vector<Vector2d> path;
+        path.reserve(msg.poses.size());
+        for(size_t i = 0; i < msg.poses.size(); i++)
+        {
+            path.push_back(Vector2d(msg.poses[i].pose.position.x, msg.poses[i].pose.position.y));
+        }
 
-        _is_pub_ori_plan_costmap = true; // オリジナルの経路コストマップをパブリッシュ済み
+        _path_follower.setPath(path);
+        _follow_path.swap(path);
 
         return;
     }
 
     //--------------------------------------------------------------------------
-    //  コストマップの送信
+    //  move_baseの大域経路受信
     //--------------------------------------------------------------------------
     /**
-     * @brief       コストマップの配信処理
-     * @param[in]   const uoa_poc3_msgs::r_costmap costmap_data　コストマップのデータ
-     * @param[in]   int8_t cost コスト値
+     * @brief       move_baseの大域経路の受信処理
+     * @param[in]   const nav_msgs::Path& msg 大域経路
      * @return      void
      */
-    void costmapSend(const uoa_poc3_msgs::r_costmap costmap_data, int8_t cost )
+    void globalPlanRecv(const nav_msgs::Path& msg)
     {
-        /* コストマップデータを変換(r_costmap → OccupancyGrid)し/plan_costmapとしてパブリッシュする */
-        nav_msgs::OccupancyGrid plan_cost_grid_map; //他ロボットの経路コストマップ（OccupancyGrid型）
-        unsigned int costmap_width              = costmap_data.width; //コストマップの幅
-        unsigned int costmap_height             = costmap_data.height; //コストマップの高さ
-        unsigned int map_size                   = costmap_width * costmap_height; //コストマップのサイズを求める
-        unsigned int cost_table_idx             = 0;
-        float costmap_resolution                = (float)costmap_data.resolution; // 解像度
-        uoa_poc3_msgs::r_pose costmap_origin   = costmap_data.origin; //原点座標
-
-        //コストマップの情報をセット
-        plan_cost_grid_map.header.stamp         = ros::Time::now();
-		plan_cost_grid_map.header.frame_id      = _global_map_frame_id; // frame_id = map
-        plan_cost_grid_map.info.resolution      = costmap_resolution; //コストマップの解像度
-        plan_cost_grid_map.info.width           = costmap_width;
-        plan_cost_grid_map.info.height          = costmap_height;
-        plan_cost_grid_map.info.origin.position = costmap_origin.point; //mapの原点座標
-
-        plan_cost_grid_map.data.resize(costmap_width * costmap_height);
-
+        if(_mode_status != MODE_NAVI || _navi_flg == false)
+        { // ナビ走行中以外は無視
+            return;
+        }
 
-        // コストの格納
-        for(int idx = 0; idx < map_size; idx++)
+        _global_plan.resize(msg.poses.size());
+        for(size_t i = 0; i < msg.poses.size(); i++)
         {
-            if(costmap_data.cost_value[idx] == OBSTACLE_COST)
-            {
-                plan_cost_grid_map.data[idx] = cost;    // 引数のコスト値に変換する
-            }
+            _global_plan[i] = Vector2d(msg.poses[i].pose.position.x, msg.poses[i].pose.position.y);
         }
 
-        // コストマップをパブリッシュ
-        pub_plan_costmap.publish(plan_cost_grid_map);
-
-        _is_pub_ori_plan_costmap = false; // オリジナルの経路コストマップは未パブリッシュへ
-
         return;
     }
-    
+
     //--------------------------------------------------------------------------
-    //  受信したコストマップの情報チェック
+    //  コストマップ更新時の経路の検査・部分修正
     //--------------------------------------------------------------------------
     /**
-     * @brief       受信したコストマップの情報チェック処理
-     * @param[in]   const uoa_poc3_msgs::r_costmap costmap_data　コストマップのデータ
-     * @return      bool true:地図情報の一致, false:地図情報の不一致
+     * @brief       コストマップ更新時の走行中の経路の検査・部分修正処理
+     * @param[in]   const uoa_poc3_msgs::r_costmap& costmap　更新後のコストマップ
+     * @return      bool true:停止せずに走行を継続, false:停止してリルートする
+     * @details     更新で新たに障害物となったセルと走行中の経路（現在地以降）の距離を調べ、ロボット半径以内に無ければ経路を維持する。
+     *              塞がれた区間がある場合は、その前後replan_margin[m]の区間のみを探索し直して経路に繋ぐ。
+     *              内蔵の経路追従制御の場合は修正した経路をそのまま追従し、move_baseの場合は迂回路があることを確認して
+     *              停止せずにコストマップの反映後（costmap_settle_time後）にゴールを再送信する（move_baseが走行中に経路を引き直す）。
+     *              新たな障害物のセルは索引に分けて区間の近傍のみを調べる
      */
-    bool checkCostmapInfo(const uoa_poc3_msgs::r_costmap costmap_data)
+    bool incrementalReplan(const uoa_poc3_msgs::r_costmap& costmap)
     {
-        bool isMatchInfo = true; // 地図情報が一致の場合true
-        std::string error_msg;
-        
-        // チェック1：ソシオ地図の幅とコストマップの幅
-        if(costmap_data.width != _sociomap_width)
+        ros::WallTime begin = ros::WallTime::now();
+        const std::vector<Vector2d>& plan = _use_native_follower ? _follow_path : _global_plan;
+        double cur_x, cur_y, cur_yaw;
+
+        if(plan.size() < 2 || _current_goal.header.frame_id.empty() ||  // ゴール配信前（移動前の旋回中）
+           costmap.cost_value.size() != _navi_cmd_costmap.cost_value.size() ||
+           costmap.width != _navi_cmd_costmap.width || !currentPose(cur_x, cur_y, cur_yaw))
         {
-            isMatchInfo = false;
-            error_msg = "Width information does not match. Internal map: "+ std::to_string(_sociomap_width) + " Costmap:"  + std::to_string(costmap_data.width) + "\n"; 
+            return false;
         }
 
-        // チェック2：ソシオ地図の高さとコストマップの高さ
-        if(costmap_data.height != _sociomap_height)
+        // 新たに障害物となったセル
+        std::vector<Vector2d> cells;
+        for(size_t idx = 0; idx < costmap.cost_value.size(); idx++)
         {
-            isMatchInfo = false;
-            error_msg += "Height information does not match. Internal map: "+ std::to_string(_sociomap_height) + " Costmap:"  + std::to_string(costmap_data.height) + "\n";
+            if(costmap.cost_value[idx] == OBSTACLE_COST && _navi_cmd_costmap.cost_value[idx] != OBSTACLE_COST)
+            {
+                cells.push_back(Vector2d(costmap.origin.point.x + ((idx % costmap.width) + 0.5) * costmap.resolution,
+                                         costmap.origin.point.y + ((idx / costmap.width) + 0.5) * costmap.resolution));
+            }
+        }
+        if(cells.empty())
+        { // 新たな障害物が無い
+            _metrics.add("replan_kept");
+            _metrics.set("replan_time_last", (ros::WallTime::now() - begin).toSec());
+            return true;
         }
 
-        // チェック3：ソシオ地図の解像度はコストマップの解像度
-        if(fabsf(costmap_data.resolution - _sociomap_resolution) > FLT_EPSILON) // costmap_data.resolution = double, _sociomap_resolution = float
+        // 区間の近傍のセルのみを調べるための索引（区間数×セル数の総当たりにしない）
+        double clearance = _robot_radius + costmap.resolution;
+        stObstacleCellIndex index;
+        buildObstacleCellIndex(cells, clearance, index);
+
+        // 現在地に最も近い区間以降で、新たな障害物がロボット半径以内にある区間
+        double nearest_t;
+        size_t nearest = nearestSegment(plan, Vector2d(cur_x, cur_y), nearest_t);
+        int first_blocked = -1, last_blocked = -1;
+        for(size_t i = nearest; i + 1 < plan.size(); i++)
         {
-            isMatchInfo = false;
-            error_msg += "Resolution information does not match. Internal map: "+ std::to_string(_sociomap_resolution) + " Costmap:"  + std::to_string(costmap_data.resolution) + "\n";
+            if(isSegmentBlocked(plan[i], plan[i + 1], index, clearance))
+            {
+                if(first_blocked < 0)
+                {
+                    first_blocked = (int)i;
+                }
+                last_blocked = (int)i + 1;
+            }
         }
 
-        // チェック4：ソシオ地図の解像度はコストマップの原点（x）
-        if(fabs(costmap_data.origin.point.x - _sociomap_origin_x) > DBL_EPSILON)
+        if(first_blocked < 0)
+        { // 経路は塞がれていない
+            _metrics.add("replan_kept");
+            _metrics.set("replan_time_last", (ros::WallTime::now() - begin).toSec());
+            ROS_INFO("incremental replan: the current plan is still clear (%zu new obstacle cells)", cells.size());
+            return true;
+        }
+
+        if(!_grid_planner.isReady() || !_grid_planner.setOverlay(costmap.cost_value, OBSTACLE_COST))
         {
-            isMatchInfo = false;
-            error_msg += "Origin X information does not match. Internal map: " + std::to_string(_sociomap_origin_x) + " Costmap:"  + std::to_string(costmap_data.origin.point.x) + "\n";
+            return false;
         }
 
-		// チェック5：ソシオ地図の解像度はコストマップの原点（y）
-        if(fabs(costmap_data.origin.point.y - _sociomap_origin_y) > DBL_EPSILON)
+        // 塞がれた区間の前後に余裕を取った修正区間（始点は現在地より手前にしない）
+        size_t repair_from = first_blocked;
+        for(double length = 0.0; repair_from > nearest && length < _replan_margin; repair_from--)
         {
-            isMatchInfo = false;
-            error_msg += "Oringin Y information does not match. Internal map: " + std::to_string(_sociomap_origin_y) + " Costmap:"  + std::to_string(costmap_data.origin.point.y) + "\n";
+            length += plan[repair_from].distanceFrom(plan[repair_from - 1]);
+        }
+        size_t repair_to = last_blocked;
+        for(double length = 0.0; repair_to + 1 < plan.size() && length < _replan_margin; repair_to++)
+        {
+            length += plan[repair_to].distanceFrom(plan[repair_to + 1]);
         }
+        Vector2d from = (repair_from <= nearest) ? Vector2d(cur_x, cur_y) : plan[repair_from];
+        const Vector2d& to = plan[repair_to];
+
+        std::vector<Vector2d> detour;
+        double length;
+        int result = _grid_planner.plan(from.x, from.y, to.x, to.y, _planner_use_jps, detour, length);
+        bool is_clear = (result == PLAN_SUCCEEDED);
+        for(size_t i = 0; is_clear && i + 1 < detour.size(); i++)
+        {
+            is_clear = !isSegmentBlocked(detour[i], detour[i + 1], index, clearance);
+        }
+        double replan_time = (ros::WallTime::now() - begin).toSec();
+        _metrics.set("replan_time_last", replan_time);
 
-        if(!error_msg.empty())
+        if(!is_clear)
         {
-            ROS_WARN_STREAM(error_msg);
+            ROS_WARN("incremental replan failed (%d). segment %d-%d from (%f, %f) to (%f, %f)",
+                     result, first_blocked, last_blocked, from.x, from.y, to.x, to.y);
+            return false;
         }
 
+        // 修正区間を迂回路に置き換える
+        std::vector<Vector2d> repaired;
+        repaired.reserve(plan.size() + detour.size());
+        if(repair_from > nearest)
+        {
+            repaired.insert(repaired.end(), plan.begin() + nearest, plan.begin() + repair_from);
+        }
+        repaired.insert(repaired.end(), detour.begin(), detour.end());
+        repaired.insert(repaired.end(), plan.begin() + repair_to + 1, plan.end());
 
-        return isMatchInfo;
-    }
+        if(_use_native_follower)
+        { // 修正した経路をそのまま追従
+            _path_follower.setPath(repaired);
+            _follow_path.swap(repaired);
+        }
+        else
+        { // 停止せずに、コストマップの反映後にゴールを再送信
+            _timer_wheel.stop(replan_goal_timer);
+            _timer_wheel.start(replan_goal_timer);
+        }
+
+        _metrics.add("replan_repaired");
+        ROS_INFO("incremental replan: repaired segment %d-%d with a %f [m] detour in %f [s]",
+                 first_blocked, last_blocked, length, replan_time);
+
+        return true;
+    }
+
+    /**
+     * @brief       経路の部分修正後のゴール再送信タイマー処理
+     * @param[in]   void
+     * @return      void
+     * @details     走行を続けたまま、更新後のコストマップの反映を待ってからゴールを再送信し、move_baseに経路を引き直させる
+     */
+    void replanGoalResend(void)
+    {
+        if(_mode_status != MODE_NAVI || _navi_flg == false || _current_goal.header.frame_id.empty())
+        { // 待つ間に走行を終えた・停止地点が切り替わった場合は送信しない
+            return;
+        }
+        _current_goal.header.stamp = ros::Time::now();
+        pub_goal.publish(_current_goal);
+        ROS_INFO("incremental replan: goal resent after the costmap settled");
+
+        return;
+    }
+
+    /**
+     * @brief       経路上で指定位置に最も近い区間の算出処理
+     * @param[in]   const std::vector<Vector2d>& path　経路（折れ線）
+     * @param[in]   const Vector2d& position　位置
+     * @param[out]  double& nearest_t　区間上の最近傍点の位置（0:始点, 1:終点）
+     * @return      size_t 区間の始点のインデックス
+     */
+    size_t nearestSegment(const std::vector<Vector2d>& path, const Vector2d& position, double& nearest_t)
+    {
+        size_t nearest = 0;
+        double nearest_distance = DBL_MAX;
+        nearest_t = 0.0;
+        for(size_t i = 0; i + 1 < path.size(); i++)
+        {
+            Vector2d edge = path[i + 1] - path[i];
+            double len2 = edge.lengthSquare();
+            double t = (len2 > 0) ? std::max(0.0, std::min(1.0, (position - path[i]).dot(edge) / len2)) : 0.0;
+            double distance = (path[i] + edge * t).distanceFrom(position);
+            if(distance < nearest_distance)
+            {
+                nearest_distance = distance;
+                nearest = i;
+                nearest_t = t;
+            }
+        }
+
+        return nearest;
+    }
+
+    /**
+     * @brief       障害物セルの索引の作成処理
+     * @param[in]   const std::vector<Vector2d>& cells　障害物セルの中心
+     * @param[in]   double clearance　干渉とみなす距離[m]（バケットの大きさ）
+     * @param[out]  stObstacleCellIndex& index　索引
+     * @return      void
+     * @details     セルの外接矩形をclearance四方のバケットに分け、セルをバケット順に並べ替える
+     */
+    void buildObstacleCellIndex(const std::vector<Vector2d>& cells, double clearance, stObstacleCellIndex& index)
+    {
+        Vector2d box_min(DBL_MAX, DBL_MAX), box_max(-DBL_MAX, -DBL_MAX);
+        for(size_t i = 0; i < cells.size(); i++)
+        {
+            box_min = Vector2d(std::min(box_min.x, cells[i].x), std::min(box_min.y, cells[i].y));
+            box_max = Vector2d(std::max(box_max.x, cells[i].x), std::max(box_max.y, cells[i].y));
+        }
+        index.origin = box_min;
+        index.bucket = std::max(clearance, 1e-3);
+        index.cols   = (int)((box_max.x - box_min.x) / index.bucket) + 1;
+        index.rows   = (int)((box_max.y - box_min.y) / index.bucket) + 1;
+
+        // バケット毎のセル数を数えて開始位置を求め、バケット順に格納する
+        std::vector<int> bucket_of(cells.size());
+        index.start.assign((size_t)index.cols * index.rows + 1, 0);
+        for(size_t i = 0; i < cells.size(); i++)
+        {
+            int col = std::min(index.cols - 1, (int)((cells[i].x - box_min.x) / index.bucket));
+            int row = std::min(index.rows - 1, (int)((cells[i].y - box_min.y) / index.bucket));
+            bucket_of[i] = row * index.cols + col;
+            index.start[bucket_of[i] + 1]++;
+        }
+        for(size_t b = 1; b < index.start.size(); b++)
+        {
+            index.start[b] += index.start[b - 1];
+        }
+        std::vector<size_t> fill(index.start.begin(), index.start.end() - 1);
+        index.cells.resize(cells.size());
+        for(size_t i = 0; i < cells.size(); i++)
+        {
+            index.cells[fill[bucket_of[i]]++] = cells[i];
+        }
+
+        return;
+    }
+
+    /**
+     * @brief       区間と障害物セルの干渉判定処理
+     * @param[in]   const Vector2d& a, b　区間の両端
+     * @param[in]   const stObstacleCellIndex& index　障害物セルの索引
+     * @param[in]   double clearance　干渉とみなす距離[m]
+     * @return      bool true:干渉あり
+     * @details     区間の外接矩形をclearance広げた範囲のバケットのセルのみを調べる
+     */
+    bool isSegmentBlocked(const Vector2d& a, const Vector2d& b, const stObstacleCellIndex& index, double clearance)
+    {
+        if(index.cells.empty())
+        {
+            return false;
+        }
+        int col_min = (int)std::floor((std::min(a.x, b.x) - clearance - index.origin.x) / index.bucket);
+        int col_max = (int)std::floor((std::max(a.x, b.x) + clearance - index.origin.x) / index.bucket);
+        int row_min = (int)std::floor((std::min(a.y, b.y) - clearance - index.origin.y) / index.bucket);
+        int row_max = (int)std::floor((std::max(a.y, b.y) + clearance - index.origin.y) / index.bucket);
+        col_min = std::max(col_min, 0);
+        row_min = std::max(row_min, 0);
+        col_max = std::min(col_max, index.cols - 1);
+        row_max = std::min(row_max, index.rows - 1);
+
+        Vector2d edge = b - a;
+        double len2 = edge.lengthSquare();
+        for(int row = row_min; row <= row_max; row++)
+        {
+            for(int col = col_min; col <= col_max; col++)
+            {
+                size_t bucket = (size_t)row * index.cols + col;
+                for(size_t i = index.start[bucket]; i < index.start[bucket + 1]; i++)
+                {
+                    const Vector2d& cell = index.cells[i];
+                    double t = (len2 > 0) ? std::max(0.0, std::min(1.0, (cell - a).dot(edge) / len2)) : 0.0;
+                    if((a + edge * t).distanceFrom(cell) <= clearance)
+                    {
+                        return true;
+                    }
+                }
+            }
+        }
+
+        return false;
+    }
+
+    //--------------------------------------------------------------------------
+    //  ソシオ地図受信
+    //--------------------------------------------------------------------------
+    /**
+     * @brief       ロボットのソシオ地図の受信処理
+     * @param[in]   const nav_msgs::OccupancyGrid& msg 地図データ
+     * @return      void
+     */
+    void sociomapRecv(const nav_msgs::OccupancyGrid& msg)
+    {
+        _sociomap_width         = msg.info.width;  //ソシオ地図の高さ
+        _sociomap_height        = msg.info.height; //ソシオ地図の幅
+        _sociomap_resolution    = (double)msg.info.resolution; //ソシオ地図の解像度
+        _sociomap_origin_x      = msg.info.origin.position.x; //ソシオ地図の原点のx座標
+        _sociomap_origin_y      = msg.info.origin.position.y; //ソシオ地図の原点のy座標
+
+        // その場旋回の衝突判定用の障害物グリッドの生成
+        if(_use_footprint_turn_check)
+        {
+            _turn_stencil.setMap(msg.info.width, msg.info.height, _sociomap_resolution, _sociomap_origin_x, _sociomap_origin_y,
+                                 msg.data, _planner_occupied_threshold);
+        }
+
+        // 到達可否判定用の探索グリッドの生成（受信時に一度だけ行い、移動指示の応答時は行わない）
+        if(_use_feasibility_check)
+        {
+            ros::WallTime begin = ros::WallTime::now();
+            _grid_planner.setStaticMap(msg.info.width, msg.info.height, _sociomap_resolution, _sociomap_origin_x, _sociomap_origin_y,
+                                       msg.data, _planner_resolution, _robot_radius, _planner_occupied_threshold, _planner_unknown_is_obstacle);
+            ROS_INFO("grid planner map updated. cell size(%f) time(%f)", _grid_planner.cellSize(), (ros::WallTime::now() - begin).toSec());
+        }
+        
+        return;
+    }
+
+    //--------------------------------------------------------------------------
+    //  空のコストマップの送信
+    //--------------------------------------------------------------------------
+    /**
+     * @brief       空のコストマップの配信処理
+     * @param[in]   void
+     * @return      void
+     */
+    void emptyCostmapSend(void)
+    {
+        nav_msgs::OccupancyGrid empty_cost_map; //パブリッシュする空の経路コストマップ（OccupancyGrid型）
+        unsigned int map_size = _sociomap_width * _sociomap_height; //コストマップのサイズを求める
+        
+        //コストマップの情報をセット
+        empty_cost_map.header.stamp             = ros::Time::now();
+		empty_cost_map.header.frame_id          = _global_map_frame_id; // frame_id = map
+        empty_cost_map.info.resolution          = _sociomap_resolution; //コストマップの解像度
+        empty_cost_map.info.width               = _sociomap_width;  //コストマップの幅
+        empty_cost_map.info.height              = _sociomap_height;  //コストマップの高さ
+        empty_cost_map.info.origin.position.x   = _sociomap_origin_x; //mapの原点座標
+        empty_cost_map.info.origin.position.y   = _sociomap_origin_y; //mapの原点座標
+
+        // コストマップのリサイズ
+        empty_cost_map.data.resize(map_size);
+
+        // コストを0で埋める
+        for(int idx = 0; idx < map_size; idx++)
+        {
+            empty_cost_map.data[idx] = FREESPACE_COST_GRIDMAP;    //コスト変換テーブルを参照し、コストの値(0~255)に対応する値(-1~100)を取り出す
+        }
+
+        // コストマップをパブリッシュ
+        pub_plan_costmap.publish(empty_cost_map);
+        _costmap_generation++;
+
+        _is_pub_ori_plan_costmap = false; // オリジナルの経路コストマップは未パブリッシュ
+
+        return;
+    }
+
+    //--------------------------------------------------------------------------
+    //  コストマップの送信
+    //--------------------------------------------------------------------------
+    /**
+     * @brief       コストマップの配信処理
+     * @param[in]   const uoa_poc3_msgs::r_costmap costmap_data　コストマップのデータ
+     * @return      void
+     */
+    void costmapSend(const uoa_poc3_msgs::r_costmap costmap_data)
+    {
+        /* コストマップデータを変換(r_costmap → OccupancyGrid)し/plan_costmapとしてパブリッシュする */
+        nav_msgs::OccupancyGrid plan_cost_grid_map; //他ロボットの経路コストマップ（OccupancyGrid型）
+        unsigned int costmap_width              = costmap_data.width; //コストマップの幅
+        unsigned int costmap_height             = costmap_data.height; //コストマップの高さ
+        unsigned int map_size                   = costmap_width * costmap_height; //コストマップのサイズを求める
+        unsigned int cost_table_idx             = 0;
+        float costmap_resolution                = (float)costmap_data.resolution; // 解像度
+        uoa_poc3_msgs::r_pose costmap_origin   = costmap_data.origin; //原点座標
+
+        //コストマップの情報をセット
+        plan_cost_grid_map.header.stamp         = ros::Time::now();
+		plan_cost_grid_map.header.frame_id      = _global_map_frame_id; // frame_id = map
+        plan_cost_grid_map.info.resolution      = costmap_resolution; //コストマップの解像度
+        plan_cost_grid_map.info.width           = costmap_width;
+        plan_cost_grid_map.info.height          = costmap_height;
+        plan_cost_grid_map.info.origin.position = costmap_origin.point; //mapの原点座標
+
+        plan_cost_grid_map.data.resize(costmap_width * costmap_height);
+
+        // コストの変換（0~255→-1~100）
+        for(int idx = 0; idx < map_size; idx++)
+        {
+            cost_table_idx = costmap_data.cost_value[idx];    // コスト値を取り出す
+            plan_cost_grid_map.data[idx] = _cost_trans_table[cost_table_idx];    //コスト変換テーブルを参照し、コストの値(0~255)に対応する値(-1~100)を取り出す
+        }
+
+        // コストマップをパブリッシュ
+        pub_plan_costmap.publish(plan_cost_grid_map);
+        _costmap_generation++;
+
+        _is_pub_ori_plan_costmap = true; // オリジナルの経路コストマップをパブリッシュ済み
+
+        return;
+    }
+
+    //--------------------------------------------------------------------------
+    //  コストマップの送信
+    //--------------------------------------------------------------------------
+    /**
+     * @brief       コストマップの配信処理
+     * @param[in]   const uoa_poc3_msgs::r_costmap costmap_data　コストマップのデータ
+     * @param[in]   int8_t cost コスト値
+     * @return      void
+     */
+    void costmapSend(const uoa_poc3_msgs::r_costmap costmap_data, int8_t cost )
+    {
+        /* コストマップデータを変換(r_costmap → OccupancyGrid)し/plan_costmapとしてパブリッシュする */
+        nav_msgs::OccupancyGrid plan_cost_grid_map; //他ロボットの経路コストマップ（OccupancyGrid型）
+        unsigned int costmap_width              = costmap_data.width; //コストマップの幅
+        unsigned int costmap_height             = costmap_data.height; //コストマップの高さ
+        unsigned int map_size                   = costmap_width * costmap_height; //コストマップのサイズを求める
+        unsigned int cost_table_idx             = 0;
+        float costmap_resolution                = (float)costmap_data.resolution; // 解像度
+        uoa_poc3_msgs::r_pose costmap_origin   = costmap_data.origin; //原点座標
+
+        //コストマップの情報をセット
+        plan_cost_grid_map.header.stamp         = ros::Time::now();
+		plan_cost_grid_map.header.frame_id      = _global_map_frame_id; // frame_id = map
+        plan_cost_grid_map.info.resolution      = costmap_resolution; //コストマップの解像度
+        plan_cost_grid_map.info.width           = costmap_width;
+        plan_cost_grid_map.info.height          = costmap_height;
+        plan_cost_grid_map.info.origin.position = costmap_origin.point; //mapの原点座標
+
+        plan_cost_grid_map.data.resize(costmap_width * costmap_height);
+
+
+        // コストの格納
+        for(int idx = 0; idx < map_size; idx++)
+        {
+            if(costmap_data.cost_value[idx] == OBSTACLE_COST)
+            {
+                plan_cost_grid_map.data[idx] = cost;    // 引数のコスト値に変換する
+            }
+        }
+
+        // コストマップをパブリッシュ
+        pub_plan_costmap.publish(plan_cost_grid_map);
+        _costmap_generation++;
+
+        _is_pub_ori_plan_costmap = false; // オリジナルの経路コストマップは未パブリッシュへ
+
+        return;
+    }
+    
+    //--------------------------------------------------------------------------
+    //  受信したコストマップの情報チェック
+    //--------------------------------------------------------------------------
+    /**
+     * @brief       受信したコストマップの情報チェック処理
+     * @param[in]   const uoa_poc3_msgs::r_costmap costmap_data　コストマップのデータ
+     * @return      bool true:地図情報の一致, false:地図情報の不一致
+     */
+    bool checkCostmapInfo(const uoa_poc3_msgs::r_costmap costmap_data)
+    {
+        bool isMatchInfo = true; // 地図情報が一致の場合true
+        std::string error_msg;
+        
+        // チェック1：ソシオ地図の幅とコストマップの幅
+        if(costmap_data.width != _sociomap_width)
+        {
+            isMatchInfo = false;
+            error_msg = "Width information does not match. Internal map: "+ std::to_string(_sociomap_width) + " Costmap:"  + std::to_string(costmap_data.width) + "\n"; 
+        }
+
+        // チェック2：ソシオ地図の高さとコストマップの高さ
+        if(costmap_data.height != _sociomap_height)
+        {
+            isMatchInfo = false;
+            error_msg += "Height information does not match. Internal map: "+ std::to_string(_sociomap_height) + " Costmap:"  + std::to_string(costmap_data.height) + "\n";
+        }
+
+        // チェック3：ソシオ地図の解像度はコストマップの解像度
+        if(fabsf(costmap_data.resolution - _sociomap_resolution) > FLT_EPSILON) // costmap_data.resolution = double, _sociomap_resolution = float
+        {
+            isMatchInfo = false;
+            error_msg += "Resolution information does not match. Internal map: "+ std::to_string(_sociomap_resolution) + " Costmap:"  + std::to_string(costmap_data.resolution) + "\n";
+        }
+
+        // チェック4：ソシオ地図の解像度はコストマップの原点（x）
+        if(fabs(costmap_data.origin.point.x - _sociomap_origin_x) > DBL_EPSILON)
+        {
+            isMatchInfo = false;
+            error_msg += "Origin X information does not match. Internal map: " + std::to_string(_sociomap_origin_x) + " Costmap:"  + std::to_string(costmap_data.origin.point.x) + "\n";
+        }
+
+		// チェック5：ソシオ地図の解像度はコストマップの原点（y）
+        if(fabs(costmap_data.origin.point.y - _sociomap_origin_y) > DBL_EPSILON)
+        {
+            isMatchInfo = false;
+            error_msg += "Oringin Y information does not match. Internal map: " + std::to_string(_sociomap_origin_y) + " Costmap:"  + std::to_string(costmap_data.origin.point.y) + "\n";
+        }
+
+        if(!error_msg.empty())
+        {
+            ROS_WARN_STREAM(error_msg);
+        }
+
+
+        return isMatchInfo;
+    }
+
+    //------------------------------------------------------------------------------
+    //  更新用のコストマップの全コストを走査し、差分の数を求める
+    //------------------------------------------------------------------------------
+    /**
+     * @brief       更新前と更新用のコスト値の差分の総数を求める
+     * @param[in]   uoa_poc3_msgs::r_costmap costmap_data　コストマップのデータ
+     * @return      unsigned int　差分
+     */
+    unsigned int getCostDifferencialCount(const uoa_poc3_msgs::r_costmap costmap_data)
+    {
+        unsigned int costmap_size; // コストマップ上の座標値
+        unsigned int cost_diff_counter = 0; // コストの差異の総数
+
+        // コストマップのサイズを求める
+        costmap_size = costmap_data.width * costmap_data.height;
+
+        //コストマップのデータをチェックする
+        for(unsigned int idx = 0; idx < costmap_size; idx++)
+        {
+            if(costmap_data.cost_value[idx] != _navi_cmd_costmap.cost_value[idx])
+            { // コストが一致しない場合
+                // コストの差異カウンターをカウントアップ
+                cost_diff_counter++;
+            }
+        }
+
+        if(cost_diff_counter == 0)
+        {
+            ROS_INFO("costmap data match!!!");
+        }
+        else
+        {
+            ROS_WARN("costmap data unmatch...%d", cost_diff_counter);
+        }
+
+        return( cost_diff_counter );
+    }
+    
+    //------------------------------------------------------------------------------
+    //  地図のリビジョン番号チェック
+    //------------------------------------------------------------------------------
+    /**
+     * @brief       移動指示の地図リビジョン番号のチェック処理
+     * @param[in]   const std::string& revision　移動指示の環境地図のリビジョン番号
+     * @return      void
+     * @details     内部地図とリビジョン番号が異なる場合はレイヤ地図を取得し直す
+     */
+    void checkMapRevision(const std::string& revision)
+    {
+        ROS_INFO_STREAM("Map revition Current: " << _environment_map_revision << ", Newly: " << revision);
+
+        // 内部地図のリビジョン番号と受信したリビジョン番号の比較
+        if(_environment_map_revision != revision)
+        { // リビジョン番号が一致しない場合
+            
+            // 内部保持リビジョン番号を更新
+            _environment_map_revision = revision;
+
+            // レイヤ地図の取得済みフラグをクリア
+            setLayerMapRenewed();
+
+            // リビジョン番号に一致したレイヤ地図を取得
+            uoa_poc5_msgs::r_get_mapdata get_layer_mapdata;
+            get_layer_mapdata.revision = revision;
+            get_layer_mapdata.retry = 5;
+            get_layer_mapdata.wait_interval = 1.0;
+            
+            if( _navigation_map_source == "external" &&   // 外部の地図を利用する場合
+                !getLayerMap(get_layer_mapdata, true))
+            {   // 取得失敗
+                ROS_WARN_STREAM("Failed to load map from RDR.");
+            }
+
+        }
+
+        return;
+    }
+
+    //------------------------------------------------------------------------------
+    //  移動指示受信
+    //------------------------------------------------------------------------------
+    /**
+     * @brief       （上位）移動指示受信処理
+     * @param[in]   uoa_poc3_msgs::r_navi_command msg　ナビゲーションコマンド
+     * @return      void
+     */
+    void commandRecv(const uoa_poc3_msgs::r_navi_command msg)
+    {
+        ROS_INFO("commandRecv id(%s) type(%s) time(%s) cmd(%s)",msg.id.c_str(), msg.type.c_str(), msg.time.c_str(), msg.cmd.c_str() );
+        std::vector<std::string> err_list;
+        std::vector<stRouteStop> stops(1);
+        stNaviEstimate estimate;
+
+        // 到達可否判定の対象（単一目的地）
+        stops[0].destination = msg.destination;
+        stops[0].dwell_time  = -1.0;
+        stops[0].route_index = -1;
+
+        // コマンド取得 
+        std::string cmd_status = msg.cmd; // 受信したCMD
+
+        // 地図のリビジョン番号チェック
+        checkMapRevision(msg.revision);
+
+        if( _mode_status == MODE_STANDBY && cmd_status == CMD_NAVI)
+        { // 待機中のnavi受信
+
+            removeAllGoals();  // goal全削除
+            clearRouteProgress(); // 単一目的地のためルートの進捗をクリア
+            // 目的地
+            bool stored = pushDestination(msg.destination, -1.0, -1);
+
+            if(_calibration_flg == true)
+            {
+                // キャリブレーション中
+                err_list.push_back("during calibration");
+                commandAnswer( msg, RESULT_ERROR, err_list);
+            }
+            else if(!stored)
+            {
+                // WPリストへ格納できない目的地は走行を開始せずに応答
+                err_list.push_back("destination could not be stored");
+                removeAllGoals();
+                commandAnswer( msg, RESULT_ERROR, err_list);
+            }
+            else if(!checkNaviFeasibility(msg.costmap, stops, estimate, err_list))
+            {
+                // 到達不可の目的地は走行を開始せずに応答
+                removeAllGoals();
+                commandAnswer( msg, RESULT_ERROR, err_list);
+                naviEstimateSend( msg.time, msg.cmd, "", estimate);
+            }
+            else
+            {
+                // ナビ（自動走行）
+                if( msg.costmap.cost_value.size() >= 1 && checkCostmapInfo(msg.costmap))
+                {
+                    // コストマップの送信
+                    costmapSend(msg.costmap);
+
+                    // コストマップ反映前にナビゲーション開始してしまう事象への対策
+                    costmapSettleStart();
+
+                    _navi_cmd_costmap = msg.costmap; // メッセージのコストマップをコピー
+                    
+                }
+                else
+                {
+                    if(msg.costmap.cost_value.size() == 0)
+                    {
+                        ROS_WARN("The cost map data is empty"); // コストマップのデータが空です
+                    }
+                    if(!checkCostmapInfo(msg.costmap))
+                    {
+                        ROS_WARN("Map information doesn't match"); // 地図情報が一致しません
+                    }
+                    _is_pub_ori_plan_costmap = false; // オリジナルの経路コストマップは未パブリッシュ
+                }
+
+                // navi開始
+                ROS_INFO("commandRecv destination point x: (%fl), y: (%fl)", msg.destination.point.x,  msg.destination.point.y);
+                _mode_status = MODE_NAVI;  // mode naviセット
+                _navi_flg = true;
+
+                // 移動指示結果応答
+                commandAnswer( msg, RESULT_ACK, err_list);
+                naviEstimateSend( msg.time, msg.cmd, "", estimate);
+            }
+        }
+        else if( (_mode_status == MODE_NAVI || _mode_status == MODE_SUSPEND) && cmd_status == CMD_NAVI)
+        { // 移動中のNavi受信(コストマップ更新)
+            // 同一目的地の未反映の更新はまとめ、最新のコストマップのみ反映する
+            queueNaviUpdate(msg);
+            applyPendingNaviUpdates();
+        }
+        else if( (_mode_status == MODE_NAVI || _mode_status == MODE_SUSPEND) && cmd_status == CMD_REFRESH &&
+                 !checkNaviFeasibility(msg.costmap, stops, estimate, err_list))
+        { // 移動中のRefresh受信（到達不可の目的地は走行中の目的地を維持したまま応答）
+            commandAnswer( msg, RESULT_ERROR, err_list);
+            naviEstimateSend( msg.time, msg.cmd, "", estimate);
+        }
+        else if( (_mode_status == MODE_NAVI || _mode_status == MODE_SUSPEND) && cmd_status == CMD_REFRESH)
+        { // 移動中のRefresh受信
+            stuckCheckStop();
+            movebaseCancel();   // 走行中断
+            removeAllGoals();  // goal全削除
+            clearRouteProgress(); // 単一目的地のためルートの進捗をクリア
+            
+            // 目的地
+            if(!pushDestination(msg.destination, -1.0, -1))
+            { // WPリストへ格納できない場合は走行中断のまま待機に戻して応答
+                emptyCostmapSend();
+                _mode_status = MODE_STANDBY;
+                _navi_flg = false;
+                err_list.push_back("destination could not be stored");
+                commandAnswer( msg, RESULT_ERROR, err_list);
+                return;
+            }
+
+            _mode_status = MODE_NAVI; // サスペンド中、NAVI状態に復帰させる
+            
+            // コストマップ情報チェック
+            if( msg.costmap.cost_value.size() >= 1 && checkCostmapInfo(msg.costmap)) 
+            { // コストマップのサイズ及びコストマップの情報が正常な場合
+                // コストマップの送信
+                costmapSend(msg.costmap);
+
+                _navi_cmd_costmap = msg.costmap; // メッセージのコストマップをコピー
+
+                // コストマップ反映前にナビゲーション開始してしまう事象への対策
+                costmapSettleStart();
+                
+            }
+            else
+            {
+                if(msg.costmap.cost_value.size() == 0)
+                {
+                    ROS_WARN("The cost map data is empty"); // コストマップのデータが空です
+                }
+                if(!checkCostmapInfo(msg.costmap))
+                {
+                    ROS_WARN("Map information doesn't match"); // 地図情報が一致しません
+                }
+
+                // 空のコストマップの送信
+                emptyCostmapSend();
+            }
+
+            // navi継続
+            ROS_INFO("commandRecv destination point x: (%fl), y: (%fl)", msg.destination.point.x,  msg.destination.point.y);
+            commandAnswer( msg, RESULT_ACK, err_list);
+            naviEstimateSend( msg.time, msg.cmd, "", estimate);
+            goalSend();
+        
+        }
+        else if( (_mode_status == MODE_NAVI || _mode_status == MODE_SUSPEND) && cmd_status == CMD_STANDBY)
+        { // 移動中のstandby受信
+            stuckCheckStop();
+            movebaseCancel();   // 走行中断
+            removeAllGoals();  // goal全削除
+            
+            // 空のコストマップの送信
+            emptyCostmapSend();
+
+            _mode_status = MODE_STANDBY;  // mode standbyセット
+            _navi_flg = false;
+            commandAnswer( msg, RESULT_ACK, err_list);
+        }
+        else
+        { // コマンド無視
+            ROS_INFO("commandRecv ignore MODE:%s CMD:%s", _mode_status.c_str(), cmd_status.c_str());
+            commandAnswer( msg, RESULT_IGNORE, err_list);
+        }
+
+        return;
+    }
 
     //------------------------------------------------------------------------------
-    //  更新用のコストマップの全コストを走査し、差分の数を求める
+    //  移動中のNavi受信（コストマップ更新）の格納
     //------------------------------------------------------------------------------
     /**
-     * @brief       更新前と更新用のコスト値の差分の総数を求める
-     * @param[in]   uoa_poc3_msgs::r_costmap costmap_data　コストマップのデータ
-     * @return      unsigned int　差分
+     * @brief       コストマップ更新の反映待ちキューへの格納処理
+     * @param[in]   const uoa_poc3_msgs::r_navi_command& msg　ナビゲーションコマンド
+     * @return      void
+     * @details     同一目的地の反映待ちの更新がある場合は古い方を破棄し、superseded応答を返す
      */
-    unsigned int getCostDifferencialCount(const uoa_poc3_msgs::r_costmap costmap_data)
+    void queueNaviUpdate(const uoa_poc3_msgs::r_navi_command& msg)
     {
-        unsigned int costmap_size; // コストマップ上の座標値
-        unsigned int cost_diff_counter = 0; // コストの差異の総数
+        std::vector<std::string> err_list;
+        stPendingNaviUpdate update;
 
-        // コストマップのサイズを求める
-        costmap_size = costmap_data.width * costmap_data.height;
+        update.msg = msg;
+        update.received_time = ros::WallTime::now();
 
-        //コストマップのデータをチェックする
-        for(unsigned int idx = 0; idx < costmap_size; idx++)
+        _metrics.add("navi_update_received");
+
+        for(std::deque<stPendingNaviUpdate>::iterator ite = _pending_navi_updates.begin(); ite != _pending_navi_updates.end(); ite++)
         {
-            if(costmap_data.cost_value[idx] != _navi_cmd_costmap.cost_value[idx])
-            { // コストが一致しない場合
-                // コストの差異カウンターをカウントアップ
-                cost_diff_counter++;
+            if( fabs(ite->msg.destination.point.x - msg.destination.point.x) < DBL_EPSILON &&
+                fabs(ite->msg.destination.point.y - msg.destination.point.y) < DBL_EPSILON )
+            { // 同一目的地の更新が反映待ちの場合
+                ROS_INFO("navi update coalesced. superseded time(%s) by time(%s)", ite->msg.time.c_str(), msg.time.c_str());
+                commandAnswer( ite->msg, RESULT_SUPERSEDED, err_list);
+                _metrics.add("navi_update_coalesced");
+
+                // 最初の受信時刻は保持したまま最新のコマンドへ置き換える
+                ite->msg = msg;
+                return;
+            }
+        }
+
+        _pending_navi_updates.push_back(update);
+
+        return;
+    }
+
+    //------------------------------------------------------------------------------
+    //  反映待ちのコストマップ更新の反映
+    //------------------------------------------------------------------------------
+    /**
+     * @brief       反映待ちのコストマップ更新を順に反映する
+     * @param[in]   void
+     * @return      void
+     * @details     反映中（コストマップ反映待ちのspinOnce内）に受信した更新はキューへの格納のみ行い、
+     *              反映中の処理が終わってから最新のもののみ反映する
+     */
+    void applyPendingNaviUpdates(void)
+    {
+        if(_is_applying_navi_update)
+        { // 反映中の場合は格納のみ
+            return;
+        }
+        _is_applying_navi_update = true;
+
+        while(!_pending_navi_updates.empty())
+        {
+            stPendingNaviUpdate update = _pending_navi_updates.front();
+            _pending_navi_updates.pop_front();
+
+            applyNaviUpdate(update.msg);
+
+            // 受信から応答までの時間
+            double latency = (ros::WallTime::now() - update.received_time).toSec();
+            _metrics.add("navi_update_applied");
+            _metrics.set("navi_update_latency_last", latency);
+            _metrics.max("navi_update_latency_max", latency);
+        }
+
+        _is_applying_navi_update = false;
+
+        return;
+    }
+
+    //------------------------------------------------------------------------------
+    //  移動中のNavi受信（コストマップ更新）の反映
+    //------------------------------------------------------------------------------
+    /**
+     * @brief       コストマップ更新の反映処理
+     * @param[in]   const uoa_poc3_msgs::r_navi_command& msg　ナビゲーションコマンド
+     * @return      void
+     */
+    void applyNaviUpdate(const uoa_poc3_msgs::r_navi_command& msg)
+    {
+        std::vector<std::string> err_list;
+
+        // 反映待ちの間にモードが変わっていないか、現在の目的地が更新され、メッセージのコマンドが一致しているか
+        if( (_mode_status == MODE_NAVI || _mode_status == MODE_SUSPEND) &&
+            fabs(_current_destination.point.x - msg.destination.point.x) < DBL_EPSILON &&
+            fabs(_current_destination.point.y - msg.destination.point.y) < DBL_EPSILON && 
+            _update_current_destination)
+        {
+            // 一致していれば更新するコストマップを送信
+            if( msg.costmap.cost_value.size() >= 1 && checkCostmapInfo(msg.costmap))
+            {
+                ROS_INFO("update costmap");
+                
+                // スタック検知済みの場合、コストの値を下げているのでそれに合わせる
+                if(_is_pub_ori_plan_costmap)
+                { // オリジナルの経路コストマップがパブリッシュされている場合
+                    // コストマップの送信
+                    costmapSend(msg.costmap); // コスト置き換えなし
+                }
+                else
+                { // コストを下げた経路コストマップがパブリッシュされている場合
+                    // コストマップの送信
+                    costmapSend(msg.costmap, _replacing_cost); // コスト置き換えあり
+                }
+
+                if(_mode_status == MODE_NAVI)
+                { // navi中
+                    // 更新前と更新されるコストマップの差異をチェック（反映待ちの前に判定し、停止が必要なら直ちに止める）
+                    if(getCostDifferencialCount(msg.costmap) >= DIFFERENCIAL_COST_THRESHOLD &&
+                       !(_use_incremental_replan && incrementalReplan(msg.costmap)))
+                    { // 走行中の経路を維持・部分修正できない場合
+                        _metrics.add("replan_stopped");
+
+                        // ロボットのナビゲーション停止
+                        movebaseCancel();   // 走行中断
+                        _driver->stopOdom();// いったん停止
+
+                        // コストマップ反映前にナビゲーション開始してしまう事象への対策
+                        sleepFunc(ROS_TIME_5S);
+
+                        // リルート（ルートの残りの停止地点は保持する）
+                        simpleGoalSend();
+                    }
+                    // 経路を維持・部分修正した場合は走行を続けるため反映を待たない
+
+                    // オリジナルの経路コストマップがプッシュ済みの場合のみスタックタイマーを再開する
+                    if(_is_pub_ori_plan_costmap)
+                    { // オリジナルの経路コストマップを送信の場合
+                        stuckCheckStart();
+                    }
+                }
+                else
+                { // サスペンド中は再開時のナビゲーション開始に備えて反映を待つ
+                    sleepFunc(ROS_TIME_5S);
+                }
+
+                _navi_cmd_costmap = msg.costmap; // メッセージのコストマップをコピー
+            }
+            else
+            {
+                if(msg.costmap.cost_value.size() == 0)
+                {
+                    ROS_WARN("The cost map data is empty"); // コストマップのデータが空です
+                }
+                if(!checkCostmapInfo(msg.costmap))
+                {
+                    ROS_WARN("Map information doesn't match"); // 地図情報が一致しません
+                }
+                
+                // コストマップが空になる為stuckのチェック処理は必要なし
+                stuckCheckStop();
+                
+                // 空のコストマップの送信
+                emptyCostmapSend();
+            }
+
+            // 結果応答
+            commandAnswer( msg, RESULT_ACK, err_list);
+
+        }
+        else
+        { // 目的地が一致しない場合は無視
+            // コマンド無視
+            ROS_INFO("applyNaviUpdate ignore because the current destination does not match the msg destination");
+            ROS_INFO("applyNaviUpdate current destination x: (%fl), y: (%fl), msg destination x: (%fl), y: (%fl)", _current_destination.point.x, _current_destination.point.y, msg.destination.point.x,  msg.destination.point.y);
+            commandAnswer( msg, RESULT_IGNORE, err_list);
+        }
+
+        return;
+    }
+
+    //------------------------------------------------------------------------------
+    //  移動指示の到達可否判定
+    //------------------------------------------------------------------------------
+    /**
+     * @brief       現在地から停止地点を順に巡回する経路を探索し、到達可否と到達予想時間を求める
+     * @param[in]   const uoa_poc3_msgs::r_costmap& costmap　移動指示のコストマップ（他ロボットの経路）
+     * @param[in]   const std::vector<stRouteStop>& stops　停止地点（巡回順）
+     * @param[out]  stNaviEstimate& estimate　判定結果
+     * @param[out]  std::vector<std::string>& err_list　エラーリスト
+     * @return      bool true:到達可能または判定不可, false:到達不可
+     * @details     地図未受信・自己位置取得失敗の場合は判定せずに従来通り受け付ける。
+     *              到達不可の場合は経路探索の重ね合わせを走行中の移動指示のコストマップに戻す
+     */
+    bool checkNaviFeasibility(const uoa_poc3_msgs::r_costmap& costmap, const std::vector<stRouteStop>& stops, stNaviEstimate& estimate, std::vector<std::string>& err_list)
+    {
+        ros::WallTime begin = ros::WallTime::now();
+        std::vector<Vector2d> path;
+        double cur_x, cur_y, cur_yaw;
+
+        estimate.valid          = false;
+        estimate.reachable      = true;
+        estimate.is_lower_bound = false;
+        estimate.path_length    = 0.0;
+        estimate.eta            = -1.0;
+        estimate.planning_time  = 0.0;
+
+        if(!_use_feasibility_check || !_grid_planner.isReady() || stops.empty())
+        {
+            return true;
+        }
+        if(!currentCoordinates(cur_x, cur_y, cur_yaw))
+        {
+            ROS_WARN("checkNaviFeasibility skipped because the current position is unknown");
+            return true;
+        }
+
+        // 他ロボットの経路（コストマップの障害物）を重ねる
+        if(!_grid_planner.setOverlay(costmap.cost_value, OBSTACLE_COST))
+        {
+            _grid_planner.clearOverlay();
+        }
+
+        Vector2d from(cur_x, cur_y);
+        double eta = 0.0;
+        estimate.valid = true;
+
+        for(size_t i = 0; i < stops.size(); i++)
+        {
+            Vector2d to(stops[i].destination.point.x, stops[i].destination.point.y);
+            double length = 0.0;
+            int result = _grid_planner.plan(from.x, from.y, to.x, to.y, _planner_use_jps, path, length);
+
+            if(result == PLAN_START_BLOCKED && i == 0)
+            { // 自己位置が障害物内（自己位置のずれ）の場合は判定しない
+                ROS_WARN("checkNaviFeasibility skipped because the current position (%f, %f) is in an obstacle", cur_x, cur_y);
+                estimate.valid = false;
+                break;
+            }
+            if(result != PLAN_SUCCEEDED && result != PLAN_TIMEOUT)
+            {
+                std::string reason = (result == PLAN_GOAL_BLOCKED) ? " is in an obstacle or out of the map" : " is unreachable";
+                err_list.push_back("destination[" + std::to_string(i) + "] (" + std::to_string(to.x) + ", " + std::to_string(to.y) + ")" + reason);
+                estimate.reachable   = false;
+                estimate.path_length = 0.0;
+                eta = -1.0;
+                break;
+            }
+
+            if(i == 0)
+            { // 最初の目的地への旋回（目的地の方向へその場旋回してから走行する）
+                double bearing = atan2(to.y - from.y, to.x - from.x);
+                double turn = fabs(atan2(sin(bearing - cur_yaw), cos(bearing - cur_yaw)));
+                eta += turn / _navigation_turn_speed;
+            }
+            else
+            { // 途中の停止地点での停止時間
+                double dwell = stops[i - 1].dwell_time;
+                eta += (dwell >= 0) ? dwell : _wp_sleep_time;
             }
+            eta += length / _planner_nominal_speed;
+            estimate.path_length += length;
+            estimate.is_lower_bound = estimate.is_lower_bound || (result == PLAN_TIMEOUT);
+
+            from = to;
+        }
+
+        estimate.eta = eta;
+        estimate.planning_time = (ros::WallTime::now() - begin).toSec();
+
+        if(estimate.valid)
+        {
+            ROS_INFO("checkNaviFeasibility reachable(%d) length(%f) eta(%f) lower_bound(%d) time(%f)",
+                     estimate.reachable, estimate.path_length, estimate.eta, estimate.is_lower_bound, estimate.planning_time);
+            _metrics.add(estimate.reachable ? "planner_accepted" : "planner_rejected");
+            if(estimate.is_lower_bound)
+            {
+                _metrics.add("planner_timeout");
+            }
+            _metrics.set("planner_time_last", estimate.planning_time);
+            _metrics.max("planner_time_max", estimate.planning_time);
+        }
+
+        if(!estimate.reachable)
+        { // 受け付けない移動指示のコストマップを以降の経路探索（移動前の旋回など）に残さない
+            restorePlannerOverlay();
+        }
+
+        return estimate.reachable;
+    }
+
+    //------------------------------------------------------------------------------
+    //  経路探索の重ね合わせの復元
+    //------------------------------------------------------------------------------
+    /**
+     * @brief       経路探索の重ね合わせを走行中の移動指示のコストマップに戻す
+     * @param[in]   void
+     * @return      void
+     * @details     待機中、または走行中の移動指示のコストマップが地図と一致しない場合は重ね合わせを解除する
+     */
+    void restorePlannerOverlay(void)
+    {
+        if(!_grid_planner.isReady())
+        {
+            return;
+        }
+        if(_mode_status == MODE_STANDBY || _navi_cmd_costmap.cost_value.empty() || !checkCostmapInfo(_navi_cmd_costmap) ||
+           !_grid_planner.setOverlay(_navi_cmd_costmap.cost_value, OBSTACLE_COST))
+        {
+            _grid_planner.clearOverlay();
         }
 
-        if(cost_diff_counter == 0)
-        {
-            ROS_INFO("costmap data match!!!");
-        }
-        else
-        {
-            ROS_WARN("costmap data unmatch...%d", cost_diff_counter);
+        return;
+    }
+
+    //------------------------------------------------------------------------------
+    //  移動指示の到達可否判定結果の配信
+    //------------------------------------------------------------------------------
+    /**
+     * @brief       到達可否判定結果（経路長・到達予想時間）の配信処理
+     * @param[in]   const std::string& received_time　受信した移動指示の送信時刻
+     * @param[in]   const std::string& received_cmd　受信した移動指示のコマンド
+     * @param[in]   const std::string& route_id　ルートの識別子（単一目的地の場合は空）
+     * @param[in]   const stNaviEstimate& estimate　判定結果
+     * @return      void
+     * @details     移動指示結果応答の直後に配信する。判定を行わなかった場合は配信しない
+     */
+    void naviEstimateSend(const std::string& received_time, const std::string& received_cmd, const std::string& route_id, const stNaviEstimate& estimate)
+    {
+        delivery_robot::r_navi_estimate estimate_msg;
+
+        if(!estimate.valid)
+        {
+            return;
+        }
+
+        estimate_msg.id             = _entityId;
+        estimate_msg.type           = _entity_type;
+        estimate_msg.time           = iso8601ex();
+        estimate_msg.received_time  = received_time;
+        estimate_msg.received_cmd   = received_cmd;
+        estimate_msg.route_id       = route_id;
+        estimate_msg.reachable      = estimate.reachable;
+        estimate_msg.is_lower_bound = estimate.is_lower_bound;
+        estimate_msg.path_length    = estimate.path_length;
+        estimate_msg.eta            = estimate.eta;
+        estimate_msg.planning_time  = estimate.planning_time;
+
+        pub_navi_estimate.publish(estimate_msg);
+
+        return;
+    }
+
+    //------------------------------------------------------------------------------
+    //  移動指示    結果応答
+    //------------------------------------------------------------------------------
+    /**
+     * @brief       （上位）移動指示結果応答配信処理
+     * @param[in]   const uoa_poc3_msgs::r_navi_command& cmd_msg　ナビゲーションコマンド
+     * @param[in]   std::string result_kind　処理結果
+     * @param[in]   std::vector<std::string>& err_list　エラーリスト
+     * @return      void
+     */
+    void commandAnswer(const uoa_poc3_msgs::r_navi_command& cmd_msg, std::string result_kind, std::vector<std::string>& err_list)
+    {
+        uoa_poc3_msgs::r_navi_result ans_msg;
+
+        ans_msg.id = _entityId;
+        ans_msg.type = _entity_type;
+        ans_msg.time =  iso8601ex();
+        ans_msg.received_time = cmd_msg.time;
+        ans_msg.received_cmd = cmd_msg.cmd;
+        ans_msg.received_revision = cmd_msg.revision;
+
+        // 目標地点のコピー
+        waypointCopy(cmd_msg.destination, ans_msg.received_destination);
+
+        // コストマップをコピー
+        ans_msg.received_costmap = cmd_msg.costmap;
+    
+        // 処理結果を格納
+        ans_msg.result = result_kind;
+
+        // エラーメッセージ
+        int err_cnt = err_list.size();
+        ans_msg.errors.resize(err_cnt);
+        for( int i=0; i<err_cnt; i++){
+            ans_msg.errors[i] = err_list[i];
         }
 
-        return( cost_diff_counter );
+        // パブ 
+        pub_answer.publish(ans_msg);
+
+        return;
     }
-    
+
     //------------------------------------------------------------------------------
-    //  移動指示受信
+    //  複数目的地の移動指示受信
     //------------------------------------------------------------------------------
     /**
-     * @brief       （上位）移動指示受信処理
-     * @param[in]   uoa_poc3_msgs::r_navi_command msg　ナビゲーションコマンド
+     * @brief       （上位）複数目的地の移動指示受信処理
+     * @param[in]   const delivery_robot::r_route_command& msg　ルートの移動指示コマンド
      * @return      void
+     * @details     停止地点をまとめてWPリストへ格納し、応答は1回のみ行う。
+     *              以降のコストマップ更新は現在の停止地点を目的地とした移動指示で受け付ける
      */
-    void commandRecv(const uoa_poc3_msgs::r_navi_command msg)
+    void routeCommandRecv(const delivery_robot::r_route_command& msg)
     {
-        ROS_INFO("commandRecv id(%s) type(%s) time(%s) cmd(%s)",msg.id.c_str(), msg.type.c_str(), msg.time.c_str(), msg.cmd.c_str() );
+        ROS_INFO("routeCommandRecv id(%s) type(%s) time(%s) cmd(%s) route_id(%s) stops(%d)", msg.id.c_str(), msg.type.c_str(), msg.time.c_str(), msg.cmd.c_str(), msg.route_id.c_str(), (int)msg.stops.size());
         std::vector<std::string> err_list;
+        std::vector<stRouteStop> stops(msg.stops.size());
+        stNaviEstimate estimate;
+
+        // 到達可否判定の対象（巡回順の停止地点）
+        for(size_t i = 0; i < msg.stops.size(); i++)
+        {
+            stops[i].destination = msg.stops[i].destination;
+            stops[i].dwell_time  = msg.stops[i].dwell_time;
+            stops[i].route_index = (int)i;
+        }
 
         // コマンド取得 
         std::string cmd_status = msg.cmd; // 受信したCMD
 
-        ROS_INFO_STREAM("Map revition Current: " << _environment_map_revision << ", Newly: " << msg.revision);
-
-        // 内部地図のリビジョン番号と受信したリビジョン番号の比較
-        if(_environment_map_revision != msg.revision)
-        { // リビジョン番号が一致しない場合
-            
-            // 内部保持リビジョン番号を更新
-            _environment_map_revision = msg.revision;
-
-            // レイヤ地図の取得済みフラグをクリア
-            setLayerMapRenewed();
+        // 地図のリビジョン番号チェック
+        checkMapRevision(msg.revision);
 
-            // リビジョン番号に一致したレイヤ地図を取得
-            uoa_poc5_msgs::r_get_mapdata get_layer_mapdata;
-            get_layer_mapdata.revision = msg.revision;
-            get_layer_mapdata.retry = 5;
-            get_layer_mapdata.wait_interval = 1.0;
-            
-            if( _navigation_map_source == "external" &&   // 外部の地図を利用する場合
-                !getLayerMap(get_layer_mapdata, true))
-            {   // 取得失敗
-                ROS_WARN_STREAM("Failed to load map from RDR.");
+        if( cmd_status == CMD_NAVI || cmd_status == CMD_REFRESH )
+        { // 停止地点数のチェック
+            if(msg.stops.size() == 0)
+            {
+                err_list.push_back("route has no stops");
+            }
+            else if((int)msg.stops.size() > _route_max_stops)
+            {
+                err_list.push_back("route has too many stops (max " + std::to_string(_route_max_stops) + ")");
             }
-
         }
 
-        if( _mode_status == MODE_STANDBY && cmd_status == CMD_NAVI)
+        if( !err_list.empty() )
+        { // 停止地点の異常
+            routeAnswer( msg, RESULT_ERROR, err_list);
+        }
+        else if( _mode_status == MODE_STANDBY && cmd_status == CMD_NAVI )
         { // 待機中のnavi受信
-
-            removeAllGoals();  // goal全削除
-            // 目的地
-            _destinations.push_back(msg.destination);
-
             if(_calibration_flg == true)
             {
                 // キャリブレーション中
                 err_list.push_back("during calibration");
-                commandAnswer( msg, RESULT_ERROR, err_list);
+                routeAnswer( msg, RESULT_ERROR, err_list);
+            }
+            else if(!checkNaviFeasibility(msg.costmap, stops, estimate, err_list))
+            {
+                // 到達不可の停止地点を含むルートは走行を開始せずに応答
+                routeAnswer( msg, RESULT_ERROR, err_list);
+                naviEstimateSend( msg.time, msg.cmd, msg.route_id, estimate);
             }
             else
             {
+                removeAllGoals();  // goal全削除
+                if(!setRoute(msg)) // 停止地点の格納
+                { // WPリストへ格納できない場合は走行を開始せずに応答
+                    removeAllGoals();
+                    clearRouteProgress();
+                    err_list.push_back("route stops could not be stored");
+                    routeAnswer( msg, RESULT_ERROR, err_list);
+                    return;
+                }
+
                 // ナビ（自動走行）
                 if( msg.costmap.cost_value.size() >= 1 && checkCostmapInfo(msg.costmap))
                 {
@@ -1082,128 +2620,52 @@ public:
                     costmapSend(msg.costmap);
 
                     // コストマップ反映前にナビゲーション開始してしまう事象への対策
-                    sleepFunc(ROS_TIME_5S);
+                    costmapSettleStart();
 
                     _navi_cmd_costmap = msg.costmap; // メッセージのコストマップをコピー
-                    
                 }
                 else
                 {
-                    if(msg.costmap.cost_value.size() == 0)
-                    {
-                        ROS_WARN("The cost map data is empty"); // コストマップのデータが空です
-                    }
-                    if(!checkCostmapInfo(msg.costmap))
-                    {
-                        ROS_WARN("Map information doesn't match"); // 地図情報が一致しません
-                    }
+                    ROS_WARN("The cost map data is empty or map information doesn't match"); // コストマップのデータが空か地図情報が一致しません
                     _is_pub_ori_plan_costmap = false; // オリジナルの経路コストマップは未パブリッシュ
                 }
 
                 // navi開始
-                ROS_INFO("commandRecv destination point x: (%fl), y: (%fl)", msg.destination.point.x,  msg.destination.point.y);
                 _mode_status = MODE_NAVI;  // mode naviセット
                 _navi_flg = true;
 
                 // 移動指示結果応答
-                commandAnswer( msg, RESULT_ACK, err_list);
+                routeAnswer( msg, RESULT_ACK, err_list);
+                naviEstimateSend( msg.time, msg.cmd, msg.route_id, estimate);
             }
         }
-        else if( (_mode_status == MODE_NAVI || _mode_status == MODE_SUSPEND) && cmd_status == CMD_NAVI)
-        { // 移動中のNavi受信(コストマップ更新)
-            // 現在の目的地が更新され、メッセージのコマンドが一致しているか
-            if( fabs(_current_destination.point.x - msg.destination.point.x) < DBL_EPSILON &&
-                fabs(_current_destination.point.y - msg.destination.point.y) < DBL_EPSILON && 
-                _update_current_destination)
-            {
-                // 一致していれば更新するコストマップを送信
-                if( msg.costmap.cost_value.size() >= 1 && checkCostmapInfo(msg.costmap))
-                {
-                    ROS_INFO("update costmap");
-                    
-                    // スタック検知済みの場合、コストの値を下げているのでそれに合わせる
-                    if(_is_pub_ori_plan_costmap)
-                    { // オリジナルの経路コストマップがパブリッシュされている場合
-                        // コストマップの送信
-                        costmapSend(msg.costmap); // コスト置き換えなし
-                    }
-                    else
-                    { // コストを下げた経路コストマップがパブリッシュされている場合
-                        // コストマップの送信
-                        costmapSend(msg.costmap, _replacing_cost); // コスト置き換えあり
-                    }
-
-                    // コストマップ反映前にナビゲーション開始してしまう事象への対策
-                    sleepFunc(ROS_TIME_5S);
-
-                    if(_mode_status == MODE_NAVI)
-                    { // navi中
-                        // 更新前と更新されるコストマップの差異をチェック
-                        if(getCostDifferencialCount(msg.costmap) >= DIFFERENCIAL_COST_THRESHOLD)
-                        {
-                            // ロボットのナビゲーション停止
-                            movebaseCancel();   // 走行中断
-                            _driver->stopOdom();// いったん停止
-
-                            // 目的地を削除
-                            removeAllGoals();   // goal全削除
-
-                            // リルート
-                            simpleGoalSend();
-                        }
-
-                        // オリジナルの経路コストマップがプッシュ済みの場合のみスタックタイマーを再開する
-                        if(_is_pub_ori_plan_costmap)
-                        { // オリジナルの経路コストマップを送信の場合
-                            stuck_timer.start();
-                        }
-                    }
-
-                    _navi_cmd_costmap = msg.costmap; // メッセージのコストマップをコピー
-                }
-                else
-                {
-                    if(msg.costmap.cost_value.size() == 0)
-                    {
-                        ROS_WARN("The cost map data is empty"); // コストマップのデータが空です
-                    }
-                    if(!checkCostmapInfo(msg.costmap))
-                    {
-                        ROS_WARN("Map information doesn't match"); // 地図情報が一致しません
-                    }
-                    
-                    // コストマップが空になる為stuckのチェック処理は必要なし
-                    stuck_timer.stop();
-                    
-                    // 空のコストマップの送信
-                    emptyCostmapSend();
-                }
-
-                // 結果応答
-                commandAnswer( msg, RESULT_ACK, err_list);
-
-            }
-            else
-            { // 目的地が一致しない場合は無視
-                // コマンド無視
-                ROS_INFO("commandRecv ignore because the current destination does not match the msg destination");
-                ROS_INFO("commandRecv current destination x: (%fl), y: (%fl), msg destination x: (%fl), y: (%fl)", _current_destination.point.x, _current_destination.point.y, msg.destination.point.x,  msg.destination.point.y);
-                commandAnswer( msg, RESULT_IGNORE, err_list);
-            }
+        else if( (_mode_status == MODE_NAVI || _mode_status == MODE_SUSPEND) && cmd_status == CMD_REFRESH &&
+                 !checkNaviFeasibility(msg.costmap, stops, estimate, err_list) )
+        { // 移動中のRefresh受信（到達不可の停止地点を含むルートは走行中のルートを維持したまま応答）
+            routeAnswer( msg, RESULT_ERROR, err_list);
+            naviEstimateSend( msg.time, msg.cmd, msg.route_id, estimate);
         }
-        else if( (_mode_status == MODE_NAVI || _mode_status == MODE_SUSPEND) && cmd_status == CMD_REFRESH)
-        { // 移動中のRefresh受信
-            stuck_timer.stop();
+        else if( (_mode_status == MODE_NAVI || _mode_status == MODE_SUSPEND) && cmd_status == CMD_REFRESH )
+        { // 移動中のRefresh受信（ルートの差し替え）
+            stuckCheckStop();
             movebaseCancel();   // 走行中断
-            removeAllGoals();  // goal全削除
-            
-            // 目的地
-            _destinations.push_back( msg.destination);
+            removeAllGoals();   // goal全削除
+            if(!setRoute(msg))  // 停止地点の格納
+            { // WPリストへ格納できない場合は走行中断のまま待機に戻して応答
+                removeAllGoals();
+                clearRouteProgress();
+                emptyCostmapSend();
+                _mode_status = MODE_STANDBY;
+                _navi_flg = false;
+                err_list.push_back("route stops could not be stored");
+                routeAnswer( msg, RESULT_ERROR, err_list);
+                return;
+            }
 
             _mode_status = MODE_NAVI; // サスペンド中、NAVI状態に復帰させる
-            
+
             // コストマップ情報チェック
-            if( msg.costmap.cost_value.size() >= 1 && checkCostmapInfo(msg.costmap)) 
+            if( msg.costmap.cost_value.size() >= 1 && checkCostmapInfo(msg.costmap))
             { // コストマップのサイズ及びコストマップの情報が正常な場合
                 // コストマップの送信
                 costmapSend(msg.costmap);
@@ -1211,63 +2673,86 @@ public:
                 _navi_cmd_costmap = msg.costmap; // メッセージのコストマップをコピー
 
                 // コストマップ反映前にナビゲーション開始してしまう事象への対策
-                sleepFunc(ROS_TIME_5S);
-                
+                costmapSettleStart();
             }
             else
             {
-                if(msg.costmap.cost_value.size() == 0)
-                {
-                    ROS_WARN("The cost map data is empty"); // コストマップのデータが空です
-                }
-                if(!checkCostmapInfo(msg.costmap))
-                {
-                    ROS_WARN("Map information doesn't match"); // 地図情報が一致しません
-                }
+                ROS_WARN("The cost map data is empty or map information doesn't match"); // コストマップのデータが空か地図情報が一致しません
 
                 // 空のコストマップの送信
                 emptyCostmapSend();
             }
 
-            // navi継続
-            ROS_INFO("commandRecv destination point x: (%fl), y: (%fl)", msg.destination.point.x,  msg.destination.point.y);
-            commandAnswer( msg, RESULT_ACK, err_list);
+            routeAnswer( msg, RESULT_ACK, err_list);
+            naviEstimateSend( msg.time, msg.cmd, msg.route_id, estimate);
             goalSend();
-        
         }
-        else if( (_mode_status == MODE_NAVI || _mode_status == MODE_SUSPEND) && cmd_status == CMD_STANDBY)
+        else if( (_mode_status == MODE_NAVI || _mode_status == MODE_SUSPEND) && cmd_status == CMD_STANDBY )
         { // 移動中のstandby受信
-            stuck_timer.stop();
+            stuckCheckStop();
             movebaseCancel();   // 走行中断
-            removeAllGoals();  // goal全削除
-            
+            removeAllGoals();   // goal全削除
+
             // 空のコストマップの送信
             emptyCostmapSend();
 
             _mode_status = MODE_STANDBY;  // mode standbyセット
             _navi_flg = false;
-            commandAnswer( msg, RESULT_ACK, err_list);
+            routeAnswer( msg, RESULT_ACK, err_list);
         }
         else
         { // コマンド無視
-            ROS_INFO("commandRecv ignore MODE:%s CMD:%s", _mode_status.c_str(), cmd_status.c_str());
-            commandAnswer( msg, RESULT_IGNORE, err_list);
+            ROS_INFO("routeCommandRecv ignore MODE:%s CMD:%s", _mode_status.c_str(), cmd_status.c_str());
+            routeAnswer( msg, RESULT_IGNORE, err_list);
         }
 
         return;
     }
 
     //------------------------------------------------------------------------------
-    //  移動指示    結果応答
+    //  ルートの格納
     //------------------------------------------------------------------------------
     /**
-     * @brief       （上位）移動指示結果応答配信処理
-     * @param[in]   const uoa_poc3_msgs::r_navi_command& cmd_msg　ナビゲーションコマンド
+     * @brief       ルートの停止地点をWPリストへ格納する
+     * @param[in]   const delivery_robot::r_route_command& msg　ルートの移動指示コマンド
+     * @return      bool true:格納成功, false:WPリストが満杯（格納できた停止地点までで中断）
+     */
+    bool setRoute(const delivery_robot::r_route_command& msg)
+    {
+        delivery_robot::r_route_stop_state stop_state;
+
+        clearRouteProgress();
+        _route_id = msg.route_id;
+
+        for(size_t i = 0; i < msg.stops.size(); i++)
+        {
+            waypointCopy(msg.stops[i].destination, stop_state.destination);
+            stop_state.status = ROUTE_STOP_PENDING;
+            _route_progress.push_back(stop_state);
+
+            if(!pushDestination(msg.stops[i].destination, msg.stops[i].dwell_time, (int)i))
+            {
+                ROS_ERROR("route stop[%d] could not be stored (waypoint list is full)", (int)i);
+                return false;
+            }
+            ROS_INFO("route stop[%d] x: (%fl), y: (%fl), dwell: (%fl)", (int)i, msg.stops[i].destination.point.x, msg.stops[i].destination.point.y, msg.stops[i].dwell_time);
+        }
+
+        return true;
+    }
+
+    //------------------------------------------------------------------------------
+    //  複数目的地の移動指示    結果応答
+    //------------------------------------------------------------------------------
+    /**
+     * @brief       （上位）複数目的地の移動指示結果応答配信処理
+     * @param[in]   const delivery_robot::r_route_command& cmd_msg　ルートの移動指示コマンド
      * @param[in]   std::string result_kind　処理結果
      * @param[in]   std::vector<std::string>& err_list　エラーリスト
      * @return      void
+     * @details     応答は移動指示結果応答と同じ形式で行い、目標地点には最終停止地点を格納する
      */
-    void commandAnswer(const uoa_poc3_msgs::r_navi_command& cmd_msg, std::string result_kind, std::vector<std::string>& err_list)
+    void routeAnswer(const delivery_robot::r_route_command& cmd_msg, std::string result_kind, std::vector<std::string>& err_list)
     {
         uoa_poc3_msgs::r_navi_result ans_msg;
 
@@ -1278,8 +2763,11 @@ public:
         ans_msg.received_cmd = cmd_msg.cmd;
         ans_msg.received_revision = cmd_msg.revision;
 
-        // 目標地点のコピー
-        waypointCopy(cmd_msg.destination, ans_msg.received_destination);
+        // 最終停止地点のコピー
+        if(!cmd_msg.stops.empty())
+        {
+            waypointCopy(cmd_msg.stops.back().destination, ans_msg.received_destination);
+        }
 
         // コストマップをコピー
         ans_msg.received_costmap = cmd_msg.costmap;
@@ -1288,11 +2776,7 @@ public:
         ans_msg.result = result_kind;
 
         // エラーメッセージ
-        int err_cnt = err_list.size();
-        ans_msg.errors.resize(err_cnt);
-        for( int i=0; i<err_cnt; i++){
-            ans_msg.errors[i] = err_list[i];
-        }
+        ans_msg.errors = err_list;
 
         // パブ 
         pub_answer.publish(ans_msg);
@@ -1322,7 +2806,7 @@ public:
         pub_info.publish(info_msg);
 
         // ステータス配信開始
-        status_send_timer.start();
+        _timer_wheel.start(status_send_timer);
 
         return;
     }
@@ -1356,7 +2840,7 @@ public:
                 movebaseCancel();   // 走行中断
                 _driver->stopOdom();// いったん停止
                 removeAllGoals();   // goal全削除
-                stuck_timer.stop(); // スタックタイマー停止
+                stuckCheckStop(); // スタックタイマー停止
 
                 //navi中またはsuspend中に受け取った場合は空のコストマップを投げる
                 if(_mode_status == MODE_NAVI || _mode_status == MODE_SUSPEND)
@@ -1375,9 +2859,11 @@ public:
             {  // navi中
                 movebaseCancel();   // 走行中断
                 _driver->stopOdom();// いったん停止
-                _destinations.push_front(_current_destination); // 現在の目的値を保持
-                goal_timer.stop();
-                stuck_timer.stop();
+                suspendSnapshotSave(); // 再開用に走行状態を保持
+                _destinations.pushFront(_current_stop); // 現在の目的値を保持
+                _timer_wheel.stop(goal_timer);
+                _goal_approach.reset();
+                stuckCheckStop();
                 _mode_status = MODE_SUSPEND;
             }
             else
@@ -1391,7 +2877,14 @@ public:
             if(_mode_status == MODE_SUSPEND)
             {  // サスペンド中
                 _mode_status = MODE_NAVI;
-                goalSend();
+                _resume_time = ros::WallTime::now();
+                _is_resume_pending = true;
+                if(!warmResume())
+                { // 位置・向き・コストマップが変わった場合は目的地への旋回からやり直す
+                    _metrics.add("resume_cold");
+                    goalSend();
+                }
+                _metrics.set("resume_to_goal_time", (ros::WallTime::now() - _resume_time).toSec());
             }
             else
             { // サスペンド中ではない
@@ -1451,35 +2944,52 @@ public:
 
    
     //------------------------------------------------------------------------------
-    //  バッテリステータス受信  30Hz
+    //  バッテリステータス受信  Turtlebot3:30Hz, メガローバ:90Hz
     //------------------------------------------------------------------------------
     /**
-     * @brief       バッテリー電圧受信処理（Turtlebot3）
-     * @param[in]   const sensor_msgs::BatteryState msg　バッテリー情報
+     * @brief       バッテリー電圧受信処理
+     * @param[in]   const typename Platform::BatteryMsg& msg　バッテリー情報（機種毎のメッセージ型）
      * @return      void
      */
-    void batteryStateRecv(const sensor_msgs::BatteryState msg)
+    template<class Platform>
+    void batteryStateRecv(const typename Platform::BatteryMsg& msg)
     {
-        _volt_sts = msg.voltage;
+        float voltage;
+        if(Platform::decodeBattery(msg, voltage)){
+            _volt_sts = voltage;
+        }
         
         return;
     }
 
+    /**
+     * @brief       バッテリー情報受信の登録
+     * @param[in]   ros::NodeHandle &node ノードハンドル
+     * @return      void
+     */
+    template<class Platform>
+    void subscribeBattery(ros::NodeHandle &node)
+    {
+        sub_battery_state_recv = node.subscribe("/" + _entityId + "/" + Platform::batteryTopic(), ROS_QUEUE_SIZE_10,
+                                                &RobotNode::batteryStateRecv<Platform>, this);
+    }
+
     //------------------------------------------------------------------------------
-    //  バッテリステータス受信  メガローバ  90Hz
+    //  機種毎のポリシーの適用
     //------------------------------------------------------------------------------
     /**
-     * @brief       バッテリー電圧受信処理（メガローバー）
-     * @param[in]   const std_msgs::Int16MultiArray msg　バッテリー情報
+     * @brief       機種毎のポリシーの適用（RobotPlatformRegistryから呼び出す）
      * @return      void
+     * @details     バッテリー情報の受信処理をポリシーで展開したものに決め、フレーム名・footprint・速度制限の
+     *              デフォルト値を設定する
      */
-    void batteryStateRecvMr(const std_msgs::Int16MultiArray msg)
+    template<class Platform>
+    void bindPlatform()
     {
-        if(msg.data.size() >= 10){
-            _volt_sts = msg.data[9] / MR_VOLTAGE_FACTOR;
-        }
-        
-        return;
+        _subscribe_battery  = &RobotNode::subscribeBattery<Platform>;
+        _base_frame_id      = Platform::baseFrame();
+        _platform_footprint = Platform::footprint();
+        _platform_limits    = Platform::limits();
     }
 
     //------------------------------------------------------------------------------
@@ -1495,6 +3005,8 @@ public:
         try
         {
             memcpy( &_g_covariance, &msg.pose.covariance, sizeof(_g_covariance));//共分散
+            _pose_predictor.setAnchorVariance(std::max(msg.pose.covariance[0], msg.pose.covariance[7]), msg.pose.covariance[35]);
+            _amcl_pose_count++;
         }
         catch(const std::exception &e)
         {
@@ -1522,15 +3034,62 @@ public:
     }
 
 
+    //--------------------------------------------------------------------------
+    //  タイマーホイール
+    //--------------------------------------------------------------------------
+    /**
+     * @brief       タイマーホイールの駆動処理
+     * @param[in]   const ros::WallTimerEvent&　タイマーイベントのポインタ
+     * @return      void
+     */
+    void timerWheelTick(const ros::WallTimerEvent&)
+    {
+        _timer_wheel.advance(ros::WallTime::now().toSec());
+
+        return;
+    }
+
+    /**
+     * @brief       スタックチェックの開始処理
+     * @param[in]   void
+     * @return      void
+     * @details     開始済みの場合は何もしない。停止中からの開始時は位置の履歴を破棄する
+     */
+    void stuckCheckStart(void)
+    {
+        if(!_timer_wheel.isActive(stuck_timer))
+        {
+            _stuck_detector.reset();
+            _timer_wheel.start(stuck_timer);
+            _stuck_sampling = true;
+        }
+
+        return;
+    }
+
+    /**
+     * @brief       スタックチェックの停止処理
+     * @param[in]   void
+     * @return      void
+     * @details     判定のタイマーと位置の取得を止める
+     */
+    void stuckCheckStop(void)
+    {
+        _timer_wheel.stop(stuck_timer);
+        _stuck_sampling = false;
+
+        return;
+    }
+
     //--------------------------------------------------------------------------
     //  ロボットがスタックしていないかチェック
     //--------------------------------------------------------------------------
     /**
      * @brief       スタックチェックタイマー処理
-     * @param[in]   const ros::TimerEvent&　タイマーイベントのポインタ
+     * @param[in]   void
      * @return      void
      */
-    void robotStuckCheck(const ros::TimerEvent&)
+    void robotStuckCheck(void)
     {
         double current_x, current_y, current_yaw;
         double distance;
@@ -1547,14 +3106,13 @@ public:
             { // オリジナルの経路コストマップ反映時
                 // コストを低くしたコストマップを送信する
                 costmapSend(_navi_cmd_costmap, _replacing_cost);
-                stuck_timer.stop(); // 一度コストを投げたらチェック終了
-                // コストマップ反映前にナビゲーション開始してしまう事象への対策
-                sleepFunc(ROS_TIME_5S);
+                stuckCheckStop(); // 一度コストを投げたらチェック終了
+                // タイマーホイールのコールバック内のため反映は待たない（走行は継続中で、反映を待って開始する処理は無い）
                 ROS_INFO("Within the threshold distance. (%fl [m])", distance);
             }
             else
             { // オリジナルの経路コストマップ未反映時
-                stuck_timer.stop(); //コストマップ未反映時はチェック終了
+                stuckCheckStop(); //コストマップ未反映時はチェック終了
             }
             
         }
@@ -1572,35 +3130,115 @@ public:
         return;
     }
 
+    /**
+     * @brief       位置の履歴によるスタック判定タイマー処理
+     * @param[in]   void
+     * @return      void
+     * @details     判定後も判定を継続し、停滞が続く場合は再度判定する。
+     *              コストを下げたコストマップは、オリジナルの経路コストマップの反映中に判定した場合のみ送信する。
+     *              位置はuse_pose_predictorが有効な場合はオドメトリ専用のスレッドが取得周期毎に渡し、
+     *              無効な場合は本処理で取得する。目的地への接近中（goal_allowable_range以内）は判定しない
+     */
+    void robotStuckDetect(void)
+    {
+        double cur_x, cur_y, cur_yaw;
+        double now = ros::Time::now().toSec();
+
+        if(!_use_pose_predictor && currentPose(cur_x, cur_y, cur_yaw))
+        {
+            if(!_stuck_detector.push(stStuckSample(now, cur_x, cur_y, cur_yaw)))
+            {
+                _metrics.add("stuck_sample_dropped");
+            }
+        }
+
+        if(_goal_approach.isActive() || _timer_wheel.isActive(goal_timer) || _goal_allowable_flg)
+        { // 目的地への接近中は減速・微調整で前進量が小さくなるため判定しない（接近の打ち切り判定に任せる）
+            _stuck_detector.reset();
+            _metrics.set("stuck_confidence", 0.0);
+            return;
+        }
+
+        bool has_goal = _navi_flg && _move_base_sts == MOVE_BASE_ACTIVE;
+        bool is_stuck = _stuck_detector.update(now, has_goal, _current_destination.point.x, _current_destination.point.y);
+
+        const stStuckEvaluation& evaluation = _stuck_detector.evaluation();
+        _metrics.set("stuck_confidence",  evaluation.confidence);
+        _metrics.set("stuck_progress",    evaluation.progress);
+        _metrics.set("stuck_oscillation", evaluation.oscillation);
+
+        if(!is_stuck)
+        {
+            return;
+        }
+
+        _metrics.add("stuck_detected");
+        ROS_INFO("stuck detected. confidence(%f) progress(%f [m]) displacement(%f [m]) path_length(%f [m]) oscillation(%f)",
+                 evaluation.confidence, evaluation.progress, evaluation.displacement, evaluation.path_length, evaluation.oscillation);
+
+        if(_is_pub_ori_plan_costmap)
+        { // オリジナルの経路コストマップ反映時
+            // コストを低くしたコストマップを送信する
+            costmapSend(_navi_cmd_costmap, _replacing_cost);
+        }
+        else
+        { // コストを下げた経路コストマップ・空のコストマップの反映時
+            ROS_WARN("still stuck after the cost map was lowered");
+        }
+
+        return;
+    }
+
     //--------------------------------------------------------------------------
     //  ロボットステータス送信
     //--------------------------------------------------------------------------
     /**
      * @brief       （上位）ロボット状態配信処理
-     * @param[in]   const ros::TimerEvent&　タイマーイベントのポインタ
+     * @param[in]   void
      * @return      void
      */
-    void robotStatusSend(const ros::TimerEvent&)
+    void robotStatusSend(void)
     {
+        std::chrono::steady_clock::time_point send_start = std::chrono::steady_clock::now();
         double x, y, z, roll, pitch, yaw;
         std::vector<std::string> sts_err_list;
+        _status_pose_age = -1.0;
+        _status_pose_extrapolated = false;
+        _status_pose_sigma_xy = -1.0;
+        _status_pose_sigma_yaw = -1.0;
         try
         {
             // エラーチェック
             robotStatusErrCheck(sts_err_list);
             int err_cnt = sts_err_list.size();
-            // 座標取得
-            tf::StampedTransform trans;
-            ros::Time now = ros::Time::now();
-            tfl.waitForTransform(_global_map_frame_id, _entityId + "/base_footprint",
-                    now, ros::Duration(ROS_TIME_3S));
-            tfl.lookupTransform(_global_map_frame_id, _entityId + "/base_footprint",   // mapからbase_footprint、(world座標のロボットの位置)
-                    ros::Time(ROS_TIME_0S), trans);
-            x = trans.getOrigin().x();                // X座標
-            y = trans.getOrigin().y();                // Y座標
+            // 座標取得（キャッシュから読み出し、オドメトリで現在時刻まで予測する。待ち合わせなし、未受信の周期は送信しない）
+            stCachedPose pose;
+            stPredictedPose predicted;
+            if(!cachedPose(pose))  // mapからbase_footprint、(world座標のロボットの位置)
+            {
+                throw tf2::TransformException("robot pose is not available");
+            }
+            if(_use_pose_predictor && predictPose(pose, predicted))
+            {
+                pose.x   = predicted.x;
+                pose.y   = predicted.y;
+                pose.yaw = predicted.yaw;
+                _status_pose_extrapolated = true;
+                _status_pose_age       = predicted.odom_age;
+                _status_pose_sigma_xy  = predicted.sigma_xy;
+                _status_pose_sigma_yaw = predicted.sigma_yaw;
+            }
+            else
+            {   // オドメトリ未受信の間は最新のオドメトリの座標変換まで補間する
+                _status_pose_extrapolated = extrapolatePose(pose);
+                _status_pose_age = ros::Time::now().toSec() - pose.stamp;
+            }
+            x = pose.x;                               // X座標
+            y = pose.y;                               // Y座標
             z = 0.0;                                  // Z座標(※ 0固定)
-            tf::Matrix3x3 m = trans.getBasis();
-            m.getRPY(roll, pitch, yaw);
+            roll  = pose.roll;
+            pitch = pose.pitch;
+            yaw   = pose.yaw;
 
             // --- ロボットステータス ---
             uoa_poc3_msgs::r_state msg;
@@ -1640,13 +3278,183 @@ public:
             // パブリッシュ
             pub_robot_sts.publish(msg);
         }
-        catch(tf::TransformException &e)
+        catch(tf2::TransformException &e)
         {
             ROS_WARN("robot status send err[%s]", e.what());
         }
+
+        // 補足情報の配信
+        stateDetailSend();
+
+        // 処理時間（計測値の配信を除く）
+        _status_send_time.add(std::chrono::duration<double>(std::chrono::steady_clock::now() - send_start).count());
+
+        // 計測値の配信
+        metricsSend();
         
         return;
     }
+
+    /**
+     * @brief       位置・向きのオドメトリによる補間
+     * @param[in,out] stCachedPose& pose  位置・向き（mapから見たbase_footprint）
+     * @return      bool   true:補間した　false:オドメトリの座標変換が無いため補間していない
+     * @details     位置・向きの時刻から最新のオドメトリまでのロボットの移動量（odomを固定フレームとした
+     *              base_footprint間の座標変換）を加え、時刻を最新のオドメトリの時刻とする。座標変換は待たない
+     */
+    bool extrapolatePose( stCachedPose& pose )
+    {
+        const std::string base = _entityId + "/" + _base_frame_id;
+        const std::string odom = _entityId + "/odom";
+        const ros::Time stamp(pose.stamp);
+        const ros::Time latest(ROS_TIME_0S);
+        geometry_msgs::TransformStamped delta;
+
+        _tf_lookups++;
+        if(!_tf_buffer->canTransform(base, stamp, base, latest, odom))
+        {
+            return false;
+        }
+        try
+        {
+            delta = _tf_buffer->lookupTransform(base, stamp, base, latest, odom);
+        }
+        catch(tf2::TransformException &ex)
+        {
+            return false;
+        }
+
+        double dx = delta.transform.translation.x;
+        double dy = delta.transform.translation.y;
+        pose.x    += cos(pose.yaw) * dx - sin(pose.yaw) * dy;
+        pose.y    += sin(pose.yaw) * dx + cos(pose.yaw) * dy;
+        pose.yaw   = atan2(sin(pose.yaw + tf2::getYaw(delta.transform.rotation)), cos(pose.yaw + tf2::getYaw(delta.transform.rotation)));
+        if(delta.header.stamp.toSec() > pose.stamp)
+        {
+            pose.stamp = delta.header.stamp.toSec();
+        }
+
+        return true;
+    }
+
+    //--------------------------------------------------------------------------
+    //  計測値送信
+    //--------------------------------------------------------------------------
+    /**
+     * @brief       ノードの計測値の配信処理
+     * @param[in]   void
+     * @return      void
+     */
+    void metricsSend(void)
+    {
+        diagnostic_msgs::DiagnosticArray msg;
+        diagnostic_msgs::DiagnosticStatus status;
+
+        if(_use_native_follower)
+        { // 経路追従制御のCPU時間と追従誤差
+            double cpu_time, error_last, error_rms, error_max;
+            _path_follower.getStatistics(cpu_time, error_last, error_rms, error_max);
+            _metrics.set("follower_cpu_time_total", cpu_time);
+            _metrics.set("follower_tracking_error_last", error_last);
+            _metrics.set("follower_tracking_error_rms", error_rms);
+            _metrics.set("follower_tracking_error_max", error_max);
+        }
+
+        // タイマー毎の発火の遅れ
+        for(int id = 0; id < _timer_wheel.size(); id++)
+        {
+            const stTimerStatistics& stats = _timer_wheel.statistics(id);
+            const std::string& name = _timer_wheel.name(id);
+            _metrics.set("timer_" + name + "_fired",    stats.fired);
+            _metrics.set("timer_" + name + "_skipped",  stats.skipped);
+            _metrics.set("timer_" + name + "_late_max", stats.late_max);
+            _metrics.set("timer_" + name + "_late_avg", (stats.fired > 0) ? stats.late_sum / stats.fired : 0.0);
+        }
+
+        // RobotDriverの速度指令の定周期送信（ウォッチドッグによる停止・送信周期の遅れ）
+        stDriverCommandStatistics command = _driver->commandStatistics();
+        _metrics.set("driver_cmd_published",        command.published);
+        _metrics.set("driver_cmd_watchdog_trips",   command.watchdog_trips);
+        _metrics.set("driver_cmd_late_ticks",       command.late_ticks);
+        _metrics.set("driver_cmd_tick_late_max",    command.tick_late_max);
+        _metrics.set("driver_cmd_tick_late_p99",    command.tick_late_p99);
+        _metrics.set("driver_cmd_setpoint_age_max", command.setpoint_age_max);
+
+        // 座標変換の取得回数（毎秒）と位置・向きのキャッシュ
+        ros::WallTime now = ros::WallTime::now();
+        uint64_t tf_lookups = _tf_lookups;
+        if(!_tf_lookups_time.isZero())
+        {
+            double elapsed = (now - _tf_lookups_time).toSec();
+            if(elapsed > 0)
+            {
+                _metrics.set("tf_lookups_per_sec", (tf_lookups - _tf_lookups_prev) / elapsed);
+            }
+        }
+        _tf_lookups_prev = tf_lookups;
+        _tf_lookups_time = now;
+        uint64_t pose_lookups, pose_failures, pose_hits;
+        double pose_stamp;
+        _pose_cache.getStatistics(pose_lookups, pose_failures, pose_hits, pose_stamp);
+        _metrics.set("tf_lookups_total",        tf_lookups);
+        _metrics.set("pose_cache_lookups",      pose_lookups);
+        _metrics.set("pose_cache_failures",     pose_failures);
+        _metrics.set("pose_cache_hits",         pose_hits);
+        _metrics.set("pose_cache_age",          (pose_stamp > 0) ? ros::Time::now().toSec() - pose_stamp : -1.0);
+
+        // 状態報告の処理時間と報告した位置・向きの経過時間
+        _metrics.set("status_send_count",       _status_send_time.count());
+        _metrics.set("status_send_time_mean",   _status_send_time.mean());
+        _metrics.set("status_send_time_p50",    _status_send_time.percentile(0.50));
+        _metrics.set("status_send_time_p99",    _status_send_time.percentile(0.99));
+        _metrics.set("status_send_time_max",    _status_send_time.max());
+        _metrics.set("status_pose_age",         _status_pose_age);
+        _metrics.set("status_pose_extrapolated", _status_pose_extrapolated ? 1.0 : 0.0);
+        _metrics.set("status_pose_sigma_xy",    _status_pose_sigma_xy);
+        _metrics.set("status_pose_sigma_yaw",   _status_pose_sigma_yaw);
+        _metrics.set("predictor_odom_count",    _predictor_odom_count);
+
+        status.level        = diagnostic_msgs::DiagnosticStatus::OK;
+        status.name         = ros::this_node::getName();
+        status.hardware_id  = _entityId;
+        _metrics.toDiagnosticStatus(status);
+
+        msg.header.stamp = ros::Time::now();
+        msg.status.push_back(status);
+
+        pub_diagnostics.publish(msg);
+
+        return;
+    }
+
+    //--------------------------------------------------------------------------
+    //  ロボットステータスの補足情報送信
+    //--------------------------------------------------------------------------
+    /**
+     * @brief       （上位）ロボット状態の補足情報配信処理
+     * @param[in]   void
+     * @return      void
+     * @details     ルート走行中の各停止地点の進捗を通知する
+     */
+    void stateDetailSend(void)
+    {
+        delivery_robot::r_state_detail msg;
+
+        msg.id          = _entityId;
+        msg.type        = _entity_type;
+        msg.time        = iso8601ex();
+        msg.route_id    = _route_id;
+        msg.route_index = _navi_flg ? _current_stop.route_index : -1;
+        msg.route       = _route_progress;
+        msg.pose_age    = _status_pose_age;
+        msg.pose_extrapolated = _status_pose_extrapolated;
+        msg.pose_sigma_xy     = _status_pose_sigma_xy;
+        msg.pose_sigma_yaw    = _status_pose_sigma_yaw;
+
+        pub_state_detail.publish(msg);
+
+        return;
+    }
     
     //--------------------------------------------------------------------------
     //  初期位置送信
@@ -1670,6 +3478,8 @@ public:
         _initial_pose.pose.covariance[7] = 0.25;
         _initial_pose.pose.covariance[35] = 0.06853891945200942;
         pub_initial.publish(_initial_pose);
+        _pose_cache.invalidate();   // 初期位置の変更前の位置を返さない
+        _pose_predictor.resetAnchor();
 
         return;
     }
@@ -1684,12 +3494,83 @@ public:
      */
     void removeAllGoals(void)
     {
-        while ( _destinations.size() >= 1) _destinations.pop_front();
+        // 未到着の停止地点はキャンセル扱い
+        if(_current_stop.route_index >= 0 && _current_stop.route_index < (int)_route_progress.size() &&
+            _route_progress[_current_stop.route_index].status == ROUTE_STOP_ACTIVE)
+        {
+            setRouteStopStatus(_current_stop.route_index, ROUTE_STOP_CANCELLED);
+        }
+        for(size_t i = 0; i < _destinations.size(); i++)
+        {
+            setRouteStopStatus(_destinations.at(i).route_index, ROUTE_STOP_CANCELLED);
+        }
         _destinations.clear();
 
         return;
     }
 
+    //--------------------------------------------------------------------------
+    //  目的地追加
+    //--------------------------------------------------------------------------
+    /**
+     * @brief       WPリストへの目的地追加処理
+     * @param[in]   const uoa_poc3_msgs::r_pose_optional& destination 目的地
+     * @param[in]   double dwell_time 到着後の停止時間[s]（負の値はwp_sleep_timeに従う）
+     * @param[in]   int route_index ルート内のインデックス（単一目的地の場合は-1）
+     * @return      bool true:追加成功, false:WPリストが満杯
+     */
+    bool pushDestination(const uoa_poc3_msgs::r_pose_optional& destination, double dwell_time, int route_index)
+    {
+        stRouteStop stop;
+
+        stop.destination = destination;
+        if(dwell_time < 0)
+        { // 指定なしの場合は角度指定ありの地点でのみ停止する
+            dwell_time = (destination.angle_optional.valid == true) ? _wp_sleep_time : 0.0;
+        }
+        stop.dwell_time  = dwell_time;
+        stop.route_index = route_index;
+
+        return _destinations.pushBack(stop);
+    }
+
+    //--------------------------------------------------------------------------
+    //  ルートの進捗クリア
+    //--------------------------------------------------------------------------
+    /**
+     * @brief       ルートの進捗クリア処理
+     * @param[in]   void
+     * @return      void
+     */
+    void clearRouteProgress(void)
+    {
+        _route_id.clear();
+        _route_progress.clear();
+        _current_stop.route_index = -1;
+
+        return;
+    }
+
+    //--------------------------------------------------------------------------
+    //  ルートの停止地点の進捗更新
+    //--------------------------------------------------------------------------
+    /**
+     * @brief       ルートの停止地点の進捗更新処理
+     * @param[in]   int route_index ルート内のインデックス
+     * @param[in]   const std::string& status 進捗
+     * @return      void
+     */
+    void setRouteStopStatus(int route_index, const std::string& status)
+    {
+        if(route_index < 0 || route_index >= (int)_route_progress.size())
+        { // ルート外の目的地
+            return;
+        }
+        _route_progress[route_index].status = status;
+
+        return;
+    }
+
     //--------------------------------------------------------------------------
     //  movebase cancel 送信
     //--------------------------------------------------------------------------
@@ -1715,17 +3596,18 @@ public:
             return;
 
         }else{
+            if(_use_native_follower)
+            { // 内蔵の経路追従制御を停止
+                _path_follower.cancel();
+            }
+
             // 現在地点を目標地点とする
-            float x, y, z, yaw;
-            tf::StampedTransform trans;
-            tfl.waitForTransform(_global_map_frame_id, _entityId + "/base_footprint",
-                     ros::Time(ROS_TIME_0S), ros::Duration(ROS_TIME_3S));
-            tfl.lookupTransform(_global_map_frame_id, _entityId + "/base_footprint",   // mapからbase_footprint、(world座標のロボットの位置)
-                     ros::Time(ROS_TIME_0S), trans);
-            x = trans.getOrigin().x();                // X座標
-            y = trans.getOrigin().y();                // Y座標
-            z = trans.getOrigin().z();                // Z座標
-            yaw = tf::getYaw(trans.getRotation());    // 四元数からyaw角を取得
+            double x, y, yaw;
+            if(!currentPose(x, y, yaw))   // mapからbase_footprint、(world座標のロボットの位置)
+            {
+                ROS_WARN("movebaseCancel() robot pose is not available, stop goal is not sent");
+                return;
+            }
 
             geometry_msgs::PoseStamped stop_goal;
 
@@ -1790,7 +3672,7 @@ public:
                 movebaseCancel();   // 走行中断
                 removeAllGoals();  // goal全削除
 
-                stuck_timer.stop();
+                stuckCheckStop();
 
                 // 空のコストマップの送信
                 emptyCostmapSend();
@@ -1849,83 +3731,39 @@ public:
      * @brief       WP方向への向き変更処理
      * @param[in]   void
      * @return      double　ゴール方向の向き
+     * @details     経路の最初の区間の方向（_turn_target）へ旋回する。戻り値は従来通り目的地への直線の向きとする
      */
     double turnTowardsGoal(void)
     {
         double x, y, yaw;
-        try
+        // 現在のロボットの向きを取得
+        if(!currentPose(x, y, yaw))
         {
-            // 現在のロボットの向きを取得
-            tf::StampedTransform trans;
-            tfl.waitForTransform(_global_map_frame_id, _entityId + "/base_footprint", ros::Time(ROS_TIME_0S), ros::Duration(ROS_TIME_500MS));
-            tfl.lookupTransform(_global_map_frame_id, _entityId + "/base_footprint", ros::Time(ROS_TIME_0S), trans);// mapから見たbase_footprint、(world座標のロボットの位置)
-            x = trans.getOrigin().x();                // Ｘ座標
-            y = trans.getOrigin().y();                // Ｙ座標
-            yaw = tf::getYaw(trans.getRotation());    // 四元数からyaw角を取得
-        }
-        catch(tf::TransformException &e)
-        {
-            ROS_WARN("turnTowardsGoal() err(%s)", e.what());
+            ROS_WARN("turnTowardsGoal() robot pose is not available");
             return(0.0);
         }
 
-        // goalに向かう向きを取得    
+        // goalに向かう向きを取得（goalの向きとして返す）
         double yaw_way = atan2((double)(_current_destination.point.y - y), (double)(_current_destination.point.x - x));
 
-        // 旋回角度を取得
-        double turn_rad = 0; //旋回角度
-        bool turn_direction = getTurnAngle( yaw, yaw_way, turn_rad);
-
-        // 旋回させる
-        ros::Rate rate(ROS_RATE_30HZ);   // 30Hz処理
-
-        for(;;)
-        {
-            // 旋回させる
-            _driver->moveTurn(turn_direction, _navigation_turn_speed);  
- 
-            rate.sleep();
-            ros::spinOnce();
-
-            try
+        // 最新の自己位置から経路の注視点までの角度差を求めて旋回させる
+        profiledTurn(
+            [this](double& error)
             {
-                // 現在のロボットの向きを取得
-                tf::StampedTransform trans;
-                tfl.waitForTransform(_global_map_frame_id, _entityId + "/base_footprint", ros::Time(ROS_TIME_0S), ros::Duration(ROS_TIME_500MS));
-                tfl.lookupTransform(_global_map_frame_id, _entityId + "/base_footprint", ros::Time(ROS_TIME_0S), trans);// mapから見たbase_footprint、(world座標のロボットの位置)
-                x = trans.getOrigin().x();                // Ｘ座標
-                y = trans.getOrigin().y();                // Ｙ座標
-                yaw = tf::getYaw(trans.getRotation());    // 四元数からyaw角を取得
-            }
-            catch(tf::TransformException &e)
+                double cur_x, cur_y, cur_yaw;
+                if(!currentPose(cur_x, cur_y, cur_yaw))
+                {
+                    return false;
+                }
+                double yaw_target = atan2(_turn_target.y - cur_y, _turn_target.x - cur_x);
+                error = atan2(sin(yaw_target - cur_yaw), cos(yaw_target - cur_yaw));
+                return true;
+            },
+            [this]()
             {
-                ROS_WARN("turnTowardsGoal() err(%s)", e.what());
-                continue;
-            }
-
-            // goalに向かう向きを取得    
-            yaw_way = atan2((double)(_current_destination.point.y - y), (double)(_current_destination.point.x - x));
-
-            // 旋回角度を取得
-            turn_rad = ANGLE_OF_0_DEGREES; //旋回角度
-            bool turn_direction_now = getTurnAngle( yaw, yaw_way, turn_rad);
-
-            if(turn_direction_now != turn_direction){
-                ROS_INFO("turn_direction reverse");
-                turn_direction = turn_direction_now;
-            } 
-
-            // WP方向までの角度差が3度以下か判定する
-            if(RAD2DEG(turn_rad) <= ANGLE_OF_3_DEGREES){
-                break;
-            }
-
-            if(_navi_flg == false || _mode_status == MODE_SUSPEND){
-                break;
-            } 
-        } 
-
-        _driver->stopOdom();  // いったん停止
+                return _navi_flg == true && _mode_status != MODE_SUSPEND;
+            },
+            DEG2RAD(ANGLE_OF_3_DEGREES), "turnTowardsGoal");
 
         return( yaw_way );
     }
@@ -1942,24 +3780,177 @@ public:
      */
     bool currentCoordinates( double& cur_x, double& cur_y, double& cur_yaw )
     {
-        bool ret_sts = true;
+        // 現在のロボットの向きを取得（mapから見たbase_footprint、(world座標のロボットの位置)）
+        if(!currentPose(cur_x, cur_y, cur_yaw))
+        {
+            ROS_WARN("currentCoordinates() robot pose is not available");
+            return( false );
+        }
+
+        return( true );
+    }
+
+    //--------------------------------------------------------------------------
+    //  現在の座標,向きを取得する（待ち合わせなし）
+    //--------------------------------------------------------------------------
+    /**
+     * @brief       現在座標・向き取得処理（キャッシュから読み出す、経路追従制御スレッドからも呼び出す）
+     * @param[out]   double& cur_x　     現在のx座標
+     * @param[out]   double& cur_y       現在のy座標
+     * @param[out]   double& cur_yaw　   現在の向き
+     * @return       bool   true:取得成功　false:取得失敗
+     * @details     use_pose_predictorが有効でオドメトリを受信済みの場合は、キャッシュの値を基準に現在時刻まで予測した値を返す
+     */
+    bool currentPose( double& cur_x, double& cur_y, double& cur_yaw )
+    {
+        stCachedPose pose;
+        stPredictedPose predicted;
+        if(!cachedPose(pose))
+        {
+            return false;
+        }
+        if(_use_pose_predictor && predictPose(pose, predicted))
+        {
+            cur_x   = predicted.x;
+            cur_y   = predicted.y;
+            cur_yaw = predicted.yaw;
+            return true;
+        }
+        cur_x   = pose.x;
+        cur_y   = pose.y;
+        cur_yaw = pose.yaw;
+
+        return true;
+    }
+
+    /**
+     * @brief       現在時刻の位置・向きの予測
+     * @param[in]   const stCachedPose& anchor  キャッシュ済みの位置・向き（予測の基準）
+     * @param[out]  stPredictedPose& predicted  予測した位置・向きと不確かさ
+     * @return      bool   true:予測成功　false:オドメトリ未受信
+     */
+    bool predictPose( const stCachedPose& anchor, stPredictedPose& predicted )
+    {
+        _pose_predictor.setAnchor(anchor.x, anchor.y, anchor.yaw, anchor.stamp);
+        return _pose_predictor.predict(ros::Time::now().toSec(), predicted);
+    }
+
+    /**
+     * @brief       キャッシュ済みの位置・向きの取得
+     * @param[out]  stCachedPose& pose  位置・向き（mapから見たbase_footprint）
+     * @return      bool   true:取得成功　false:取得失敗
+     * @details     前回の取得から更新周期が経過している場合のみ座標変換を取得する
+     */
+    bool cachedPose( stCachedPose& pose )
+    {
+        return _pose_cache.get(ros::Time::now().toSec(), _pose_lookup, pose);
+    }
+
+    /**
+     * @brief       ロボットの位置・向きの座標変換の取得（キャッシュの更新用）
+     * @param[out]  stCachedPose& pose  位置・向き（mapから見たbase_footprint）
+     * @return      bool   true:取得成功　false:未受信
+     */
+    bool lookupRobotPose( stCachedPose& pose )
+    {
+        geometry_msgs::TransformStamped trans;
+        if(!lookupTransform(_global_map_frame_id, _entityId + "/" + _base_frame_id, trans))
+        {
+            return false;
+        }
+        pose.x     = trans.transform.translation.x;
+        pose.y     = trans.transform.translation.y;
+        pose.z     = trans.transform.translation.z;
+        pose.stamp = trans.header.stamp.toSec();
+        const geometry_msgs::Quaternion& q = trans.transform.rotation;
+        tf::Matrix3x3 m(tf::Quaternion(q.x, q.y, q.z, q.w));
+        m.getRPY(pose.roll, pose.pitch, pose.yaw);
+
+        return true;
+    }
+
+    //--------------------------------------------------------------------------
+    //  座標変換の取得（待ち合わせなし）
+    //--------------------------------------------------------------------------
+    /**
+     * @brief       共有の座標変換バッファからの最新の座標変換の取得
+     * @param[in]   const std::string& target   変換先のフレーム
+     * @param[in]   const std::string& source   変換元のフレーム
+     * @param[out]  geometry_msgs::TransformStamped& trans  座標変換
+     * @return      bool   true:取得成功　false:未受信
+     * @details     canTransformで確認してから取得し、受信を待たない（経路追従制御スレッドからも呼び出す）
+     */
+    bool lookupTransform( const std::string& target, const std::string& source, geometry_msgs::TransformStamped& trans )
+    {
+        std::string error;
+        _tf_lookups++;
+        if(!_tf_buffer->canTransform(target, source, ros::Time(ROS_TIME_0S), &error))
+        {
+            _metrics.add("tf_unavailable");
+            ROS_WARN_THROTTLE(ROS_TIME_1S, "transform %s -> %s is not available(%s)", source.c_str(), target.c_str(), error.c_str());
+            return false;
+        }
+
         try
         {
-            // 現在のロボットの向きを取得
-            tf::StampedTransform trans;
-            tfl.waitForTransform(_global_map_frame_id, _entityId + "/base_footprint", ros::Time(ROS_TIME_0S), ros::Duration(ROS_TIME_500MS));
-            tfl.lookupTransform(_global_map_frame_id, _entityId + "/base_footprint", ros::Time(ROS_TIME_0S), trans);// mapから見たbase_footprint、(world座標のロボットの位置)
-            cur_x = trans.getOrigin().x();                // Ｘ座標
-            cur_y = trans.getOrigin().y();                // Ｙ座標
-            cur_yaw = tf::getYaw(trans.getRotation());    // 四元数からyaw角を取得
+            trans = _tf_buffer->lookupTransform(target, source, ros::Time(ROS_TIME_0S));
         }
-        catch(tf::TransformException &ex)
+        catch(tf2::TransformException &ex)
         {
-            ROS_WARN("currentCoordinates() err(%s)", ex.what());
-            ret_sts = true;
+            _metrics.add("tf_unavailable");
+            ROS_WARN_THROTTLE(ROS_TIME_1S, "lookupTransform() err(%s)", ex.what());
+            return false;
         }
 
-        return( ret_sts );
+        return true;
+    }
+
+    /**
+     * @brief       最新の座標変換（平面上の位置・向き）の取得
+     * @param[in]   const std::string& target   変換先のフレーム
+     * @param[in]   const std::string& source   変換元のフレーム
+     * @param[out]  double& x, y, yaw   位置・向き
+     * @return      bool   true:取得成功　false:未受信
+     */
+    bool lookupPose2D( const std::string& target, const std::string& source, double& x, double& y, double& yaw )
+    {
+        geometry_msgs::TransformStamped trans;
+        if(!lookupTransform(target, source, trans))
+        {
+            return false;
+        }
+        x   = trans.transform.translation.x;        // Ｘ座標
+        y   = trans.transform.translation.y;        // Ｙ座標
+        yaw = tf2::getYaw(trans.transform.rotation); // 四元数からyaw角を取得
+
+        return true;
+    }
+
+    /**
+     * @brief       座標変換の受信待ち
+     * @param[in]   const std::string& target   変換先のフレーム
+     * @param[in]   const std::string& source   変換元のフレーム
+     * @param[in]   double timeout  タイムアウト[s]
+     * @return      bool   true:受信済み　false:タイムアウト
+     * @details     canTransformを周期的に確認し、待つ間もコールバックを処理する
+     */
+    bool waitTransform( const std::string& target, const std::string& source, double timeout )
+    {
+        ros::WallTime deadline = ros::WallTime::now() + ros::WallDuration(timeout);
+        while(ros::ok())
+        {
+            if(_tf_buffer->canTransform(target, source, ros::Time(ROS_TIME_0S)))
+            {
+                return true;
+            }
+            if((deadline - ros::WallTime::now()).toSec() <= 0)
+            {
+                break;
+            }
+            sleepFunc(ROS_TIME_50MS);
+        }
+
+        return false;
     }
 
     //--------------------------------------------------------------------------
@@ -1973,39 +3964,104 @@ public:
      */
     bool turnAngle( double angle_yaw, double allowable_angle )
     {
-        double cur_x, cur_y, cur_yaw;
-        double turn_rad = 0; //旋回角度
+        return profiledTurn(
+            [this, angle_yaw](double& error)
+            {
+                double cur_x, cur_y, cur_yaw;
+                if(!currentPose(cur_x, cur_y, cur_yaw))
+                {
+                    return false;
+                }
+                error = atan2(sin(angle_yaw - cur_yaw), cos(angle_yaw - cur_yaw));
+                return true;
+            },
+            nullptr, allowable_angle, "turnAngle");
+    }
+
+    //--------------------------------------------------------------------------
+    //  台形速度プロファイルによるその場旋回
+    //--------------------------------------------------------------------------
+    /**
+     * @brief       その場旋回処理（turnTowardsGoal, turnAngle共通）
+     * @param[in]   std::function<bool(double&)> get_error　角度差（目標 - 現在、-π~π）の取得関数（取得失敗時はfalse）
+     * @param[in]   std::function<bool()> is_continue　旋回を継続するかの判定関数（nullptrの場合は常に継続）
+     * @param[in]   double tolerance　旋回完了とみなす角度差[rad]
+     * @param[in]   const char* tag　ログ出力用の呼び出し元名
+     * @return      bool   true:旋回成功　false:旋回失敗（角度差の取得に10回連続で失敗）
+     * @details     角度差は周期毎に最新の自己位置から求め、旋回毎に所要時間と行き過ぎ量をログ・計測値に出力する
+     */
+    bool profiledTurn(std::function<bool(double&)> get_error, std::function<bool()> is_continue, double tolerance, const char* tag)
+    {
+        TurnController controller;
+        stTurnControllerConfig config = _turn_config;
+        double error = 0.0;
         int err_cnt = 0;
         bool ret_sts = true;
-        bool loop_end = false;
+
+        config.tolerance = tolerance;
+        controller.configure(config);
 
         ros::Rate rate(ROS_RATE_30HZ);   // 30Hz処理
 
-        while(!loop_end)
+        // 旋回開始時の角度差
+        while(!get_error(error))
+        {
+            if(++err_cnt >= 10)
+            {
+                return false;
+            }
+            rate.sleep();
+            ros::spinOnce();
+        }
+        err_cnt = 0;
+        controller.start(error);
+
+        ros::WallTime last = ros::WallTime::now();
+        while(ros::ok())
         {
+            if(controller.isDone(error))
+            {
+                break;
+            }
+            if(is_continue && !is_continue())
+            {
+                break;
+            }
+
+            ros::WallTime now = ros::WallTime::now();
+            _driver->moveVelocity(0.0, controller.update(error, (now - last).toSec()));
+            last = now;
+
             rate.sleep();
             ros::spinOnce();
 
-            if( true == currentCoordinates( cur_x, cur_y, cur_yaw )){   // 現在の向きを取得
-                bool turn_direction = getTurnAngle( cur_yaw, angle_yaw, turn_rad ); // 角度のずれを取得
-                ROS_INFO( "turn_rad(%f) allowable_angle(%f)", turn_rad, allowable_angle);
-                if( turn_rad > allowable_angle ){   // 許容範囲よりずれているか
-                    // 旋回させる
-                    _driver->moveTurn(turn_direction, _navigation_turn_speed);
-                }else{
-                    loop_end = true;
-                }
-            }else{
-                err_cnt++;
-                if( err_cnt >= 10 ){
+            if(!get_error(error))
+            {
+                if(++err_cnt >= 10)
+                {
                     ret_sts = false;
-                    loop_end = true;
+                    break;
                 }
+                continue;
             }
+            err_cnt = 0;
         }
 
         _driver->stopOdom();  // いったん停止
 
+        // 停止時の惰性による行き過ぎを含めて記録
+        if(get_error(error))
+        {
+            controller.finish(error);
+        }
+        ROS_INFO("%s turn finished. initial(%f deg) time(%f s) overshoot(%f deg) residual(%f deg)",
+                 tag, RAD2DEG(controller.initialError()), controller.elapsed(), RAD2DEG(controller.overshoot()), RAD2DEG(error));
+        _metrics.add("turn_count");
+        _metrics.add("turn_time_total", controller.elapsed());
+        _metrics.set("turn_time_last", controller.elapsed());
+        _metrics.set("turn_overshoot_last", RAD2DEG(controller.overshoot()));
+        _metrics.max("turn_overshoot_max", RAD2DEG(controller.overshoot()));
+
         return( ret_sts );
     }
 
@@ -2014,15 +4070,71 @@ public:
     //------------------------------------------------------------------------------
     /**
      * @brief       ゴール地点到達時T.O.処理
-     * @param[in]   const ros::WallTimerEvent&　タイマーイベントのポインタ
-     * @return      bool   true:旋回成功　false:旋回失敗
+     * @param[in]   void
+     * @return      void
      */
-    void goal_allowable_time(const ros::WallTimerEvent&) 
+    void goal_allowable_time(void)
     {
         ROS_INFO("!!!!goal_allowable_time Out!!!!");
         _goal_allowable_flg = true;
         movebaseCancel();//停止させる
-        
+        
+        return;
+    }
+
+    /**
+     * @brief       目的地への接近の打ち切り判定処理
+     * @param[in]   double x, y, yaw 現在位置・向き
+     * @return      void
+     * @details     goal_allowable_range以内に入ってから周期毎に呼び出し、到達・距離の収束・到達見込みなしの
+     *              いずれかで接近を打ち切る（goal_allowable_time経過と同じ扱い）。
+     *              ゴールの向きへのその場旋回中は距離の収束による打ち切りを行わない
+     */
+    void goalApproachCheck(double x, double y, double yaw)
+    {
+        double now = ros::WallTime::now().toSec();
+        double distance = hypot(x - _current_destination.point.x, y - _current_destination.point.y);
+
+        if(_navi_flg == false || _goal_allowable_flg == true)
+        {
+            _goal_approach_prev_time = now;
+            _goal_approach_prev_distance = distance;
+            return;
+        }
+
+        if(!_goal_approach.isActive())
+        {
+            if(distance <= _goal_allowable_range)
+            {
+                // 範囲外からの直前の距離の変化を開始時の接近速度とする
+                double dt = now - _goal_approach_prev_time;
+                double speed = (dt > 0 && dt < 1.0) ? (_goal_approach_prev_distance - distance) / dt : 0.0;
+                _goal_approach.start(now, distance, yaw, speed);
+                ROS_INFO("goal approach start. distance(%f [m]) speed(%f [m/s]) expected(%f [s])",
+                         distance, _goal_approach.speed(), _goal_approach.expectedArrival());
+            }
+            _goal_approach_prev_time = now;
+            _goal_approach_prev_distance = distance;
+            return;
+        }
+
+        int result = _goal_approach.update(now, distance, yaw);
+        if(result == GOAL_APPROACH_CONTINUE)
+        {
+            return;
+        }
+
+        ROS_INFO("goal approach finished (%s). distance(%f [m]) best(%f [m]) speed(%f [m/s]) elapsed(%f [s]) expected(%f [s])",
+                 GoalApproachMonitor::resultName(result), distance, _goal_approach.bestDistance(),
+                 _goal_approach.speed(), _goal_approach.elapsed(now), _goal_approach.expectedArrival());
+        _metrics.add(std::string("goal_approach_") + GoalApproachMonitor::resultName(result));
+        _metrics.set("goal_approach_time", _goal_approach.elapsed(now));
+        _metrics.set("goal_approach_error", distance);
+
+        _goal_approach.reset();
+        _goal_allowable_flg = true;
+        movebaseCancel();//停止させる
+
         return;
     }
 
@@ -2053,6 +4165,61 @@ public:
         return;
     } 
 
+    //--------------------------------------------------------------------------
+    //  走行開始時のコストマップ反映待ちの開始
+    //--------------------------------------------------------------------------
+    /**
+     * @brief       走行開始時のコストマップ反映待ちの開始
+     * @param[in]   void
+     * @return      void
+     * @details     並行時は反映完了見込み時刻のみ記録して戻り、残りの待ちはgoalSend()で旋回後に行う
+     */
+    void costmapSettleStart(void)
+    {
+        if(!_use_pipelined_start)
+        {
+            sleepFunc(_costmap_settle_time);
+            _costmap_settle_until = ros::WallTime();
+            return;
+        }
+
+        _costmap_settle_start = ros::WallTime::now();
+        _costmap_settle_until = _costmap_settle_start + ros::WallDuration(_costmap_settle_time);
+    }
+
+    //--------------------------------------------------------------------------
+    //  走行開始時のコストマップ反映待ちの完了
+    //--------------------------------------------------------------------------
+    /**
+     * @brief       コストマップ反映完了見込み時刻までの残りの待ち
+     * @param[in]   double turn_time 移動前の旋回に要した時間[s]
+     * @return      void
+     * @details     直列の場合（反映待ち→旋回）との差（旋回と重なった反映待ちの時間）を短縮時間として計測値に出力する
+     */
+    void costmapSettleWait(double turn_time)
+    {
+        if(_costmap_settle_until.isZero())
+        {
+            return;
+        }
+
+        double remain = (_costmap_settle_until - ros::WallTime::now()).toSec();
+        if(remain > 0)
+        {
+            sleepFunc(remain);
+        }
+
+        // 旋回開始時点の反映待ちの残りのうち、旋回と重なった分
+        double saved = std::max(0.0, std::min(turn_time, remain + turn_time));
+        _metrics.set("navi_start_settle_wait_last",  std::max(0.0, remain));
+        _metrics.set("navi_start_overlap_saved_last", saved);
+        _metrics.add("navi_start_overlap_saved_total", saved);
+        _metrics.set("navi_start_latency_last",      (ros::WallTime::now() - _costmap_settle_start).toSec());
+        ROS_INFO("Costmap settle overlapped with turning: saved %.2f[s], waited %.2f[s]", saved, std::max(0.0, remain));
+
+        _costmap_settle_until = ros::WallTime();
+    }
+
     //--------------------------------------------------------------------------
     //  PoseStampedメッセージ作成
     //--------------------------------------------------------------------------
@@ -2128,6 +4295,265 @@ public:
 
     }
 
+    //--------------------------------------------------------------------------
+    //  サスペンドからの再開
+    //--------------------------------------------------------------------------
+    /**
+     * @brief       サスペンド時の走行状態の保持処理
+     * @param[in]   void
+     * @return      void
+     */
+    void suspendSnapshotSave(void)
+    {
+        _suspend_snapshot.valid = currentPose(_suspend_snapshot.x, _suspend_snapshot.y, _suspend_snapshot.yaw);
+        _suspend_snapshot.stop               = _current_stop;
+        _suspend_snapshot.goal               = _current_goal;
+        _suspend_snapshot.follow_path        = _follow_path;
+        _suspend_snapshot.costmap_generation = _costmap_generation;
+        _is_resume_pending = false;
+
+        return;
+    }
+
+    /**
+     * @brief       走行中だった経路での再開処理
+     * @param[in]   void
+     * @return      bool true:再開した, false:再開条件を満たさない（goalSend()で再開する）
+     * @details     サスペンド後に位置・向きがずれておらず、目的地・経路コストマップが変わっていない場合、
+     *              移動前の旋回・待機を行わずにサスペンド時のゴールを再送信する。
+     *              内蔵の経路追従制御の場合は追従中だった経路で直ちに走行を再開する
+     */
+    bool warmResume(void)
+    {
+        double cur_x, cur_y, cur_yaw;
+        const stSuspendSnapshot& snapshot = _suspend_snapshot;
+
+        if(!snapshot.valid || snapshot.goal.header.frame_id.empty() || _destinations.size() == 0 ||
+           _turn_busy_flg ||    // 移動前の旋回中（goalSend()の処理中）は再開しない
+           !currentPose(cur_x, cur_y, cur_yaw))
+        {
+            return false;
+        }
+
+        const stRouteStop& front = _destinations.front();
+        double moved = hypot(cur_x - snapshot.x, cur_y - snapshot.y);
+        double turned = fabs(atan2(sin(cur_yaw - snapshot.yaw), cos(cur_yaw - snapshot.yaw)));
+        bool same_stop = front.route_index == snapshot.stop.route_index &&
+                         fabs(front.destination.point.x - snapshot.stop.destination.point.x) < DBL_EPSILON &&
+                         fabs(front.destination.point.y - snapshot.stop.destination.point.y) < DBL_EPSILON &&
+                         // 保持したゴールがその停止地点のものか
+                         fabs(snapshot.goal.pose.position.x - snapshot.stop.destination.point.x) < DBL_EPSILON &&
+                         fabs(snapshot.goal.pose.position.y - snapshot.stop.destination.point.y) < DBL_EPSILON;
+
+        if(!same_stop || moved > _resume_position_tolerance || turned > _resume_angle_tolerance ||
+           snapshot.costmap_generation != _costmap_generation)
+        {
+            ROS_INFO("cold resume. same stop(%d) moved(%f [m]) turned(%f [rad]) costmap changed(%d)",
+                     same_stop, moved, turned, snapshot.costmap_generation != _costmap_generation);
+            return false;
+        }
+
+        // goalSend()の旋回・待機以外の処理と同じ
+        _timer_wheel.stop(goal_timer);
+        _goal_approach.reset();
+        _goal_allowable_flg = false;
+        _current_stop = front;
+        _current_destination = _current_stop.destination;
+        _update_current_destination = true;
+        _destinations.popFront();
+        setRouteStopStatus(_current_stop.route_index, ROUTE_STOP_ACTIVE);
+
+        if(_use_native_follower && !snapshot.follow_path.empty())
+        { // 追従中だった経路で走行を再開（新しい経路を受信したら置き換える）
+            _path_follower.setPath(snapshot.follow_path);
+            _follow_path = snapshot.follow_path;
+        }
+        else if(_use_native_follower)
+        {
+            _path_follower.cancel();
+        }
+
+        _current_goal = snapshot.goal;
+        _current_goal.header.stamp = ros::Time::now();
+        pub_goal.publish(_current_goal);
+        if(_is_pub_ori_plan_costmap)
+        { //コストマップが反映済みの場合はスタック監視スタート
+            stuckCheckStart();
+        }
+
+        _metrics.add("resume_warm");
+        ROS_INFO("warm resume. goal x:%0.3f y:%0.3f moved(%f [m]) turned(%f [rad])",
+                 _current_goal.pose.position.x, _current_goal.pose.position.y, moved, turned);
+
+        return true;
+    }
+
+    //--------------------------------------------------------------------------
+    //  移動前の旋回で向く地点
+    //--------------------------------------------------------------------------
+    /**
+     * @brief       移動前の旋回で向く地点の更新処理
+     * @param[in]   void
+     * @return      void
+     * @details     現在地から目的地までの経路を求め、経路上で現在地からturn_heading_lookahead[m]進んだ点を向く地点とする。
+     *              move_baseの経路が得られない場合は内蔵の経路探索、それも得られない場合は目的地とする
+     */
+    void updateTurnTarget(void)
+    {
+        double cur_x, cur_y, cur_yaw;
+        std::vector<Vector2d> path;
+        const char* source = TURN_HEADING_STRAIGHT;
+
+        _turn_target = Vector2d(_current_destination.point.x, _current_destination.point.y);
+
+        if(_turn_heading_source == TURN_HEADING_STRAIGHT || !currentPose(cur_x, cur_y, cur_yaw))
+        {
+            return;
+        }
+
+        ros::WallTime begin = ros::WallTime::now();
+        if(_turn_heading_source == TURN_HEADING_MOVE_BASE && makePlanPath(cur_x, cur_y, path))
+        {
+            source = TURN_HEADING_MOVE_BASE;
+        }
+        else if(_grid_planner.isReady())
+        {
+            double length;
+            int result = _grid_planner.plan(cur_x, cur_y, _turn_target.x, _turn_target.y, _planner_use_jps, path, length);
+            if(result == PLAN_SUCCEEDED)
+            {
+                source = TURN_HEADING_GRID;
+            }
+            else
+            {
+                path.clear();
+            }
+        }
+
+        Vector2d target;
+        if(!path.empty() && pathLookaheadPoint(path, Vector2d(cur_x, cur_y), _turn_heading_lookahead, target))
+        {
+            _turn_target = target;
+        }
+        else
+        {
+            source = TURN_HEADING_STRAIGHT;
+        }
+        double plan_time = (ros::WallTime::now() - begin).toSec();
+
+        double yaw_straight = atan2(_current_destination.point.y - cur_y, _current_destination.point.x - cur_x);
+        double yaw_target   = atan2(_turn_target.y - cur_y, _turn_target.x - cur_x);
+        double offset       = fabs(atan2(sin(yaw_target - yaw_straight), cos(yaw_target - yaw_straight)));
+        ROS_INFO("turn target (%f, %f) source(%s) offset from the straight line(%f [rad]) time(%f)",
+                 _turn_target.x, _turn_target.y, source, offset, plan_time);
+        _metrics.add(std::string("turn_heading_") + source);
+        _metrics.set("turn_heading_offset_last", offset);
+        _metrics.set("turn_heading_time_last", plan_time);
+
+        return;
+    }
+
+    /**
+     * @brief       move_baseの経路探索処理
+     * @param[in]   double cur_x, cur_y　現在位置
+     * @param[out]  std::vector<Vector2d>& path　経路
+     * @return      bool true:経路あり
+     */
+    bool makePlanPath(double cur_x, double cur_y, std::vector<Vector2d>& path)
+    {
+        nav_msgs::GetPlan srv;
+        srv.request.start = makePoseStamped(cur_x, cur_y, 0.0);
+        srv.request.goal  = makePoseStamped(_current_destination.point.x, _current_destination.point.y, 0.0);
+        srv.request.tolerance = _goal_tolerance_range;
+
+        if(!make_plan_client.call(srv) || srv.response.plan.poses.empty())
+        {
+            ROS_WARN("make_plan failed");
+            return false;
+        }
+
+        path.clear();
+        path.reserve(srv.response.plan.poses.size());
+        for(size_t i = 0; i < srv.response.plan.poses.size(); i++)
+        {
+            const geometry_msgs::Point& point = srv.response.plan.poses[i].pose.position;
+            path.push_back(Vector2d(point.x, point.y));
+        }
+
+        return true;
+    }
+
+    /**
+     * @brief       経路上の注視点の算出処理
+     * @param[in]   const std::vector<Vector2d>& path　経路（折れ線）
+     * @param[in]   const Vector2d& position　現在位置
+     * @param[in]   double lookahead　現在位置に最も近い経路上の点から注視点までの経路に沿った距離[m]
+     * @param[out]  Vector2d& target　注視点（経路が短い場合は終点）
+     * @return      bool true:算出成功, false:注視点が現在位置に近すぎる（向きが定まらない）
+     */
+    bool pathLookaheadPoint(const std::vector<Vector2d>& path, const Vector2d& position, double lookahead, Vector2d& target)
+    {
+        // 現在位置に最も近い区間
+        double nearest_t;
+        size_t nearest = nearestSegment(path, position, nearest_t);
+
+        // 経路に沿ってlookahead進んだ点
+        target = path.back();
+        double remain = lookahead;
+        for(size_t i = nearest; i + 1 < path.size(); i++)
+        {
+            Vector2d from = (i == nearest) ? path[i] + (path[i + 1] - path[i]) * nearest_t : path[i];
+            double length = path[i + 1].distanceFrom(from);
+            if(length >= remain)
+            {
+                target = from + (path[i + 1] - from) * (remain / length);
+                break;
+            }
+            remain -= length;
+        }
+
+        return target.distanceFrom(position) > _goal_tolerance_range;
+    }
+
+    //--------------------------------------------------------------------------
+    //  旋回可否判定
+    //--------------------------------------------------------------------------
+    /**
+     * @brief       移動方向（_turn_target）へのその場旋回の可否判定処理
+     * @param[in]   void
+     * @return      bool   true:旋回制御対象　false:旋回制御対象外
+     * @details     旋回で通過する角度のfootprintマスクをソシオ地図と照合し、障害物と重ならなければ旋回する。
+     *              マスク・地図が未準備、または自己位置が取得できない場合は旋回除外範囲による判定とする
+     */
+    bool isTurnAllowed(void)
+    {
+        // 走行開始位置の記録と旋回除外範囲による判定
+        bool is_turn_control = checkCurrentPosition();
+
+        double cur_x, cur_y, cur_yaw;
+        if(!_use_footprint_turn_check || !_turn_stencil.isReady() || !currentPose(cur_x, cur_y, cur_yaw))
+        {
+            return( is_turn_control );
+        }
+
+        double yaw_way = atan2(_turn_target.y - cur_y, _turn_target.x - cur_x);
+
+        ros::WallTime begin = ros::WallTime::now();
+        bool is_free = _turn_stencil.isTurnFree(cur_x, cur_y, cur_yaw, yaw_way);
+        double check_time = (ros::WallTime::now() - begin).toSec();
+
+        ROS_INFO("footprint turn check free(%d) yaw(%f -> %f) exclusion range(%d) time(%f us)",
+                 is_free, cur_yaw, yaw_way, !is_turn_control, check_time * 1e6);
+        _metrics.set("turn_check_time_last", check_time);
+        _metrics.max("turn_check_time_max", check_time);
+        if(!is_free)
+        {
+            _metrics.add("turn_check_blocked");
+        }
+
+        return( is_free );
+    }
+
     //--------------------------------------------------------------------------
     //  wayポイント送信
     //--------------------------------------------------------------------------
@@ -2142,36 +4568,53 @@ public:
 
         bool retSts = false;
 
-        goal_timer.stop();
+        _timer_wheel.stop(goal_timer);
+        _goal_approach.reset();
         _goal_allowable_flg = false;
 
         if(_destinations.size() == 0) return false;
 
         //現在の目的地更新
-        _current_destination = _destinations.front();
+        _current_stop = _destinations.front();
+        _current_destination = _current_stop.destination;
         //目的地更新フラグON
         _update_current_destination = true;
-        _destinations.pop_front();
+        _destinations.popFront();
+        setRouteStopStatus(_current_stop.route_index, ROUTE_STOP_ACTIVE);
+
+        // 前の目的地のゴール・経路を破棄（旋回・反映待ちの間のサスペンドで前の目的地のゴールを保持しない）
+        _current_goal = geometry_msgs::PoseStamped();
+        _follow_path.clear();
+        _global_plan.clear();
 
         if(_turn_busy_flg == false)
         {
 
             _turn_busy_flg = true; 
 
+            // 移動前の旋回で向く地点（経路の最初の区間）
+            updateTurnTarget();
+
             // 現在位置が移動前の旋回制御対象かチェック
-            if(checkCurrentPosition())
+            ros::WallTime turn_start = ros::WallTime::now();
+            if(isTurnAllowed())
             { // 旋回制御対象の場合
                 ROS_INFO("Enable turning control");
-                // ロボットの姿勢をgoalの方向へ向ける
+                // ロボットの姿勢をgoalの方向へ向ける（コストマップの反映待ちと並行）
                 yaw = turnTowardsGoal();
             }
             else
             {
-                // スリープ（コストマップ反映前に経路を取らないようにする為）
-                sleepFunc(ROS_TIME_1S);
+                if(_costmap_settle_until.isZero())
+                { // スリープ（コストマップ反映前に経路を取らないようにする為）
+                    sleepFunc(ROS_TIME_1S);
+                }
 
                 ROS_INFO("Disable turning control");
             }
+
+            // コストマップの反映待ちの残り
+            costmapSettleWait((ros::WallTime::now() - turn_start).toSec());
             
 
             // wayポイント到着時の向き指定ありか
@@ -2185,14 +4628,19 @@ public:
             // パブリッシュ
             if(_navi_flg == true && _mode_status == MODE_NAVI)
             {
+                if(_use_native_follower)
+                { // 前の目的地の追従経路を破棄して新しい経路を待つ
+                    _path_follower.cancel();
+                }
                 pub_goal.publish(way_goal);
+                _current_goal = way_goal;
                 ROS_INFO("Applying goal x:%0.3f y:%0.3f yaw:%0.3f",
                     way_goal.pose.position.x,
                     way_goal.pose.position.y,
                     tf::getYaw(way_goal.pose.orientation));
                 if(_is_pub_ori_plan_costmap)
                 { //コストマップが反映済みの場合はスタック監視スタート
-                    stuck_timer.start();
+                    stuckCheckStart();
                 }
                 ROS_INFO("!!! stuck_timer start !!!");
                 retSts = true;
@@ -2255,20 +4703,15 @@ public:
      */
     void turn360(double turn_speed) 
     {
-        double yaw;
+        double x, y, yaw;
+        int pose_failure = 0;
 
-        try
-        {
-            // 現在のロボットの向きを取得
-            tf::StampedTransform trans;
-            // Durationは実機:0.5, シミュレータ:5.0
-            tfl.waitForTransform(_entityId + "/base_footprint", _entityId + "/odom", ros::Time(ROS_TIME_0S), ros::Duration(ROS_TIME_5S));
-            tfl.lookupTransform(_entityId + "/base_footprint", _entityId + "/odom", ros::Time(ROS_TIME_0S), trans);// base_footprintから見たodom、(ロボットの向き)
-            yaw = tf::getYaw(trans.getRotation());    // 四元数からyaw角を取得
-        }
-        catch(tf::TransformException &e)
+        // 現在のロボットの向きを取得（base_footprintから見たodom、(ロボットの向き)）
+        // 待ち時間は実機:0.5, シミュレータ:5.0
+        if(!waitTransform(_entityId + "/" + _base_frame_id, _entityId + "/odom", ROS_TIME_5S) ||
+           !lookupPose2D(_entityId + "/" + _base_frame_id, _entityId + "/odom", x, y, yaw))
         {
-            ROS_ERROR("turn360() err(%s)", e.what());
+            ROS_ERROR("turn360() odometry transform is not available");
             _calibration_flg = false;
             return;
         }
@@ -2279,6 +4722,9 @@ public:
         double yaw_current = yaw;
         double yaw_total = 0;
         double turn_val;
+        bool converged = false;
+        unsigned long amcl_count = _amcl_pose_count;
+        ros::WallTime turn_start = ros::WallTime::now();
 
         ROS_INFO("turn360 (%f rad/s) start ---------->",turn_speed);
 
@@ -2291,20 +4737,18 @@ public:
             rate.sleep();
             ros::spinOnce();
  
-            try
-            {
-                // 現在のロボットの向きを取得
-                tf::StampedTransform trans;
-                ros::Time now = ros::Time::now();
-                tfl.waitForTransform(_entityId + "/base_footprint", _entityId + "/odom", now, ros::Duration(ROS_TIME_1S));
-                tfl.lookupTransform(_entityId + "/base_footprint", _entityId + "/odom", now, trans);// base_footprintodom見たbase_footprint、(ロボットの向き)
-                yaw_current = tf::getYaw(trans.getRotation());    // 四元数からyaw角を取得
-            }
-            catch(tf::TransformException &e)
-            {
-                ROS_ERROR("turn360() err(%s)", e.what());
-                return;
+            // 現在のロボットの向きを取得（base_footprintから見たodom、(ロボットの向き)）
+            if(!lookupPose2D(_entityId + "/" + _base_frame_id, _entityId + "/odom", x, y, yaw_current))
+            { // 取得できない状態が1秒続いた場合は中止
+                if(++pose_failure >= ROS_RATE_10HZ)
+                {
+                    ROS_ERROR("turn360() odometry transform is not available");
+                    _driver->stopOdom();  // いったん停止
+                    return;
+                }
+                continue;
             }
+            pose_failure = 0;
 
             if ( fabs(yaw_current-yaw_before) < 1.0e-2) continue;// 小さすぎる値はスルー // fabs=絶対値
 
@@ -2325,7 +4769,14 @@ public:
 
             yaw_before = yaw_current; // 前回値保持
 
-            if (yaw_total >= DEG2RAD(ANGLE_OF_360_DEGREES)){
+            if (yaw_total >= _calibration_max_rotation){
+                break;
+            }
+
+            // 位置推定が収束していれば打ち切る（旋回開始後に更新された推定のみで判定する）
+            if (_calibration_early_exit && yaw_total >= _calibration_min_rotation &&
+                _amcl_pose_count - amcl_count >= (unsigned long)_calibration_min_updates && localizationConverged()){
+                converged = true;
                 break;
             }
         }
@@ -2333,11 +4784,68 @@ public:
         _driver->stopOdom();  // いったん停止
         _calibration_flg = false;
 
-        ROS_INFO("turn360 end <-------------");
+        // 全周旋回・最長の待ちに対して短縮できた時間
+        double turn_time = (ros::WallTime::now() - turn_start).toSec();
+        double full_time = DEG2RAD(ANGLE_OF_360_DEGREES) / turn_speed;
+        double saved = std::max(0.0, full_time - turn_time) + std::max(0.0, _calibration_settle_time - _calibration_settle_wait);
+        _metrics.set("calibration_settle_wait",  _calibration_settle_wait);
+        _metrics.set("calibration_turn_time",    turn_time);
+        _metrics.set("calibration_rotation",     RAD2DEG(yaw_total));
+        _metrics.set("calibration_converged",    converged ? 1.0 : 0.0);
+        _metrics.set("calibration_time_saved",   saved);
+
+        ROS_INFO("turn360 end <------------- rotation %.0f deg, %s, variance xy(%f, %f) yaw(%f), saved %.1f s",
+                 RAD2DEG(yaw_total), converged ? "converged" : "not converged",
+                 _g_covariance[0], _g_covariance[7], _g_covariance[35], saved);
         
         return;
     }
 
+    //--------------------------------------------------------------------------
+    //  キャリブレーション前の待ち
+    //--------------------------------------------------------------------------
+    /**
+     * @brief       キャリブレーションの旋回前の待ち（地図・初期位置の反映待ち）
+     * @param[in]   void
+     * @return      void
+     * @details     打ち切りが有効な場合は、最短時間の経過後にamcl_poseを受信した時点（初期位置が位置推定に
+     *              反映された時点）で待ちを終える。最長時間を過ぎた場合も終える
+     */
+    void calibrationSettle(void)
+    {
+        ros::WallTime start = ros::WallTime::now();
+
+        if(!_calibration_early_exit)
+        {
+            sleepFunc(_calibration_settle_time);
+        }
+        else
+        {
+            unsigned long amcl_count = _amcl_pose_count;
+            sleepFunc(std::min(_calibration_min_settle_time, _calibration_settle_time));
+            while(ros::ok() && _amcl_pose_count == amcl_count &&
+                  (ros::WallTime::now() - start).toSec() < _calibration_settle_time)
+            {
+                sleepFunc(ROS_TIME_50MS);
+            }
+        }
+
+        _calibration_settle_wait = (ros::WallTime::now() - start).toSec();
+        ROS_INFO("calibration settle %.1f s", _calibration_settle_wait);
+    }
+
+    /**
+     * @brief       位置推定の収束判定
+     * @param[in]   void
+     * @return      bool true:x・y・yawの分散が全て閾値以下
+     */
+    bool localizationConverged(void)
+    {
+        return(_g_covariance[0]  <= _calibration_xy_variance &&
+               _g_covariance[7]  <= _calibration_xy_variance &&
+               _g_covariance[35] <= _calibration_yaw_variance);
+    }
+
     //--------------------------------------------------------------------------
     //  メインループ
     //--------------------------------------------------------------------------
@@ -2374,21 +4882,9 @@ public:
                 rate.sleep();
                 ros::spinOnce();
 
-                float x, y, yaw;
-                try
-                {
-                    tf::StampedTransform trans;
-                    tfl.waitForTransform(_global_map_frame_id, _entityId + "/base_footprint",
-                            ros::Time(ROS_TIME_0S), ros::Duration(ROS_TIME_50MS));
-                    tfl.lookupTransform(_global_map_frame_id, _entityId + "/base_footprint",   // mapから見たbase_footprint、(world座標のロボットの位置)
-                            ros::Time(ROS_TIME_0S), trans);
-                    x = trans.getOrigin().x();                // Ｘ座標
-                    y = trans.getOrigin().y();                // Ｙ座標
-                    yaw = tf::getYaw(trans.getRotation());    // 四元数からyaw角を取得
-                }
-                catch(tf::TransformException &e)
+                double x, y, yaw;
+                if(!currentPose(x, y, yaw))   // mapから見たbase_footprint、(world座標のロボットの位置)
                 {
-                    ROS_WARN("%s", e.what());
                     continue;
                 }
 
@@ -2399,10 +4895,26 @@ public:
                     continue;
                 }
 
-                if(hypotf(x - _current_destination.point.x, y - _current_destination.point.y) <= _goal_allowable_range){  //  目的値まで近づいたらタイマー開始する
+                if(_is_resume_pending && hypot(x - _suspend_snapshot.x, y - _suspend_snapshot.y) > RESUME_MOTION_DISTANCE)
+                { // サスペンドからの再開後、走行を開始するまでの時間
+                    _is_resume_pending = false;
+                    _metrics.set("resume_to_motion_time", (ros::WallTime::now() - _resume_time).toSec());
+                    ROS_INFO("resumed motion in %f [s]", (ros::WallTime::now() - _resume_time).toSec());
+                }
+
+                if(_use_native_follower)
+                { // 内蔵の経路追従制御の状態をmove_baseのステータスとして扱う
+                    _move_base_sts = _path_follower.status();
+                }
+
+                if(_use_adaptive_goal_timeout)
+                { // 接近速度と距離の収束で打ち切る
+                    goalApproachCheck(x, y, yaw);
+                }
+                else if(hypotf(x - _current_destination.point.x, y - _current_destination.point.y) <= _goal_allowable_range){  //  目的値まで近づいたらタイマー開始する
                     if(_navi_flg == true){
                         ROS_INFO("Goal Timer Start");
-                        goal_timer.start(); //タイマースタート
+                        _timer_wheel.start(goal_timer); //タイマースタート
                     }
                 }
 
@@ -2411,8 +4923,8 @@ public:
                 || _goal_allowable_flg == true ) {  // ゴール到達時タイムアウト
 
                     ROS_INFO("Goal Timer Stop");
-                    goal_timer.stop();
-                    stuck_timer.stop();
+                    _timer_wheel.stop(goal_timer);
+                    stuckCheckStop();
                     ROS_INFO("_move_base_sts(%d)",_move_base_sts);
 
                     // 角度判定
@@ -2425,10 +4937,11 @@ public:
                     
                     // 目的地到達のため、更新フラグをオフ
                     _update_current_destination = false;
+                    setRouteStopStatus(_current_stop.route_index, ROUTE_STOP_ARRIVED);
 
-                    if( _current_destination.angle_optional.valid == true && _destinations.size() >= 1 ){
+                    if( _current_stop.dwell_time > 0 && _destinations.size() >= 1 ){
                         // ちょっと止まる
-                        sleepFunc(_wp_sleep_time);
+                        sleepFunc(_current_stop.dwell_time);
                     }
 
                     bool goal_snd_sts = goalSend();
@@ -2521,6 +5034,8 @@ public:
      * @param[in]   uoa_poc5_msgs::r_get_mapdata pub_msg 取得する地図の情報
      * @param[in]   bool use_env_map_rev 環境地図のリビジョン番号を使った取得の実施フラグ
      * @return      bool データの受信の成功の可否
+     * @details     3つのレイヤ地図の取得要求をまとめて送信し、レイヤ毎に受信完了を待つ。
+     *              layer_map_timeout以内に受信できなかったレイヤのみ取得要求を送り直す
      */
     bool getLayerMap(uoa_poc5_msgs::r_get_mapdata pub_msg, bool use_env_map_rev)
     {
@@ -2535,84 +5050,76 @@ public:
         ros::Rate rate(ROS_RATE_10HZ);   // 10Hz処理
 
         // 地図読み込みのタイムアウト時間
-        ros::Time loop_timeout = ros::Time::now();
-	    ros::Time t_start = ros::Time::now();
-        // 初回フラグ
-        bool is_first_time_for_static_layer  = true;
-        bool is_first_time_for_qstatic_layer  = true;
-        bool is_first_time_for_ex_zone_layer  = true;
+        ros::WallTime t_start = ros::WallTime::now();
+
+        // レイヤ毎の取得状況
+        stLayerMapFetch fetch[] = {
+            { DEF_STATIC_LAYER_TOPIC_NAME,          &_is_recv_static_map,           0, ros::WallTime(), -1.0 },
+            { DEF_SEMI_STATIC_LAYER_TOPIC_NAME,     &_is_recv_quasi_static_map,     0, ros::WallTime(), -1.0 },
+            { DEF_EXCLUSION_ZONE_LAYER_TOPIC_NAME,  &_is_recv_exclusion_zone_map,   0, ros::WallTime(), -1.0 },
+        };
+        const size_t layer_num = sizeof(fetch) / sizeof(fetch[0]);
+
+        // 地図の取得先の接続を待つ（接続前に送信した要求はラッチされた最後の1件しか届かないため、最長でリトライ間隔）
+        while(ros::ok() &&
+        (pub_get_map.getNumSubscribers() == 0 || (use_env_map_rev && pub_get_layer_map.getNumSubscribers() == 0)) &&
+        (ros::WallTime::now() - t_start).toSec() < _retry_time)
+        {
+            ros::spinOnce();
+            rate.sleep();
+        }
 
+        size_t remaining = layer_num;
         while(ros::ok() && 
-        !_is_recv_exclusion_zone_map &&   // 侵入禁止レイヤ地図まで受信完了したら終了
-        (ros::Time::now() - loop_timeout).toSec() <= _get_map_timeout) // タイムアウト時間以内
-        { // 初期位置を読み込むまで待機(約10秒経過でタイムアウト)
-
+        remaining > 0 &&   // すべてのレイヤ地図を受信完了したら終了
+        (ros::WallTime::now() - t_start).toSec() <= _get_map_timeout) // タイムアウト時間以内
+        {
             ros::spinOnce();
 
-            if( !_is_recv_static_map && // 静的レイヤ地図を受信していない場合
-                is_first_time_for_static_layer && // 初回
-                (ros::Time::now() - t_start).toSec() >= _retry_time// リトライ間隔秒以上経過                        // 地図を受信できていない場合
-                )
-            { // 静的レイヤ地図が読み込めていない場合
-                is_first_time_for_static_layer = false;
-                pub_msg.map_layer = "static_layer";
-	            t_start = ros::Time::now(); // timerリセット
-                if(use_env_map_rev)
-                { //  環境地図のリビジョンを使用する場合
-                    pub_get_layer_map.publish(pub_msg);
-                }
-                else
-                {
-                    pub_msg.space = "virtual";
-                    pub_get_map.publish(pub_msg);
-                }
-            }
-            else if(_is_recv_static_map &&              // 準静的レイヤ地図は受信済み
-                    !_is_recv_quasi_static_map &&       // 準静的レイヤ地図を受信できていない
-                    is_first_time_for_qstatic_layer &&  // 初回のみ
-                    (ros::Time::now() - t_start).toSec() >= _retry_time // リトライ間隔時間以上
-            )
-            { // 準静的レイヤ地図が読み込めていない場合
-                is_first_time_for_qstatic_layer = false;
-                pub_msg.map_layer = "semi_static_layer";
-	            t_start = ros::Time::now(); // timerリセット
-                if(use_env_map_rev)
-                { //  環境地図のリビジョンを使用する場合
-                    pub_get_layer_map.publish(pub_msg);
+            ros::WallTime now = ros::WallTime::now();
+            remaining = 0;
+            for(size_t i = 0; i < layer_num; i++)
+            {
+                stLayerMapFetch& layer = fetch[i];
+                if(*layer.received)
+                { // 受信完了
+                    if(layer.fetch_time < 0)
+                    {
+                        layer.fetch_time = (now - t_start).toSec();
+                    }
+                    continue;
                 }
-                else
+
+                remaining++;
+                if(layer.requests == 0 ||   // 未要求
+                   (now - layer.requested).toSec() >= _layer_map_timeout)  // レイヤ毎の応答待ち時間を超過
                 {
-                    pub_msg.space = "virtual";
-                    pub_get_map.publish(pub_msg);
+                    if(layer.requests > 0)
+                    {
+                        ROS_WARN("layer map %s was not received in %.1f s, requesting again", layer.layer, _layer_map_timeout);
+                    }
+                    layerMapRequest(pub_msg, layer.layer, use_env_map_rev);
+                    layer.requests++;
+                    layer.requested = now;
                 }
             }
-            else if(_is_recv_quasi_static_map &&  // 準静的レイヤ地図を受信済み
-                    !_is_recv_exclusion_zone_map && // 侵入禁止レイヤ地図は未受信
-                    (is_first_time_for_ex_zone_layer && //　初回のみ
-                    (ros::Time::now() - t_start).toSec() >= _retry_time) // リトライ間隔時間以上            
-            )
-            { // 侵入禁止レイヤ地図が読み込めていない場合
-                is_first_time_for_ex_zone_layer = false;
-                pub_msg.map_layer = "exclusion_zone_layer";
-	            t_start = ros::Time::now(); // timerリセット
-                if(use_env_map_rev)
-                { //  環境地図のリビジョンを使用する場合
-                    // pub_get_layer_map.publish(pub_msg); // 進入禁止レイヤに紐づく環境地図はRDR側で更新するため、現状環境地図のリビジョン番号で検索不可
-                    pub_msg.latest = true;
-                    pub_msg.location = "lictia_1f";
-                    pub_msg.space   = "real";
-                    pub_msg.revision = "";
-                    // pub_msg.time    = "2023-12-12T15:35:40.930+0900";
-                    pub_get_map.publish(pub_msg);
-                }
-                else
-                {
-                    pub_msg.space = "real";
-                    pub_get_map.publish(pub_msg);
-                }            
+
+            if(remaining > 0)
+            {
+                rate.sleep();
             }
-            
-            rate.sleep();
+        }
+
+        // 取得時間の報告
+        double fetch_time = (ros::WallTime::now() - t_start).toSec();
+        ROS_INFO("GET LAYERMAP %s in %.2f s (%s %.2f s, %s %.2f s, %s %.2f s)",
+                 (remaining == 0) ? "COMPLETE" : "TIMEOUT", fetch_time,
+                 fetch[0].layer, fetch[0].fetch_time, fetch[1].layer, fetch[1].fetch_time, fetch[2].layer, fetch[2].fetch_time);
+        _metrics.set("layer_map_fetch_time", fetch_time);
+        for(size_t i = 0; i < layer_num; i++)
+        {
+            _metrics.set(std::string("layer_map_fetch_time_") + fetch[i].layer,     fetch[i].fetch_time);
+            _metrics.set(std::string("layer_map_fetch_requests_") + fetch[i].layer, fetch[i].requests);
         }
 
         // 進入禁止レイヤ地図の補正値取得
@@ -2642,6 +5149,48 @@ public:
         return is_success;
     }
 
+    /**
+     * @brief       レイヤ地図の取得要求の送信
+     * @param[in]   uoa_poc5_msgs::r_get_mapdata pub_msg 取得する地図の情報
+     * @param[in]   const std::string& layer レイヤ名
+     * @param[in]   bool use_env_map_rev 環境地図のリビジョン番号を使った取得の実施フラグ
+     * @return      void
+     */
+    void layerMapRequest(uoa_poc5_msgs::r_get_mapdata pub_msg, const std::string& layer, bool use_env_map_rev)
+    {
+        pub_msg.map_layer = layer;
+
+        if(layer == DEF_EXCLUSION_ZONE_LAYER_TOPIC_NAME)
+        { // 侵入禁止レイヤ地図
+            if(use_env_map_rev)
+            { //  環境地図のリビジョンを使用する場合
+                // pub_get_layer_map.publish(pub_msg); // 進入禁止レイヤに紐づく環境地図はRDR側で更新するため、現状環境地図のリビジョン番号で検索不可
+                pub_msg.latest = true;
+                pub_msg.location = "lictia_1f";
+                pub_msg.space   = "real";
+                pub_msg.revision = "";
+                // pub_msg.time    = "2023-12-12T15:35:40.930+0900";
+                pub_get_map.publish(pub_msg);
+            }
+            else
+            {
+                pub_msg.space = "real";
+                pub_get_map.publish(pub_msg);
+            }
+        }
+        else if(use_env_map_rev)
+        { //  環境地図のリビジョンを使用する場合
+            pub_get_layer_map.publish(pub_msg);
+        }
+        else
+        {
+            pub_msg.space = "virtual";
+            pub_get_map.publish(pub_msg);
+        }
+
+        return;
+    }
+
     //--------------------------------------------------------------------------
     //  地図の補正値の取得
     //--------------------------------------------------------------------------
@@ -2779,9 +5328,37 @@ int main(int argc, char *argv[])
     std::string init_map_source;
     getParam(privateNode, "initial_map_source", init_map_source, std::string("internal"));
 
+    // リアルタイム実行（制御スレッドの開始前にメモリをロックし、ヒープを確保しておく）
+    bool realtime_mode;
+    int realtime_heap_prefault_mb;
+    getParam(privateNode, "realtime_mode",              realtime_mode,              false);
+    getParam(privateNode, "realtime_heap_prefault_mb",  realtime_heap_prefault_mb,  DEF_REALTIME_HEAP_PREFAULT_MB);
+    if(realtime_mode)
+    {
+        std::string error;
+        if(!lockProcessMemory((size_t)std::max(0, realtime_heap_prefault_mb) * 1024 * 1024, error))
+        {
+            ROS_WARN("realtime mode: memory lock failed (%s)", error.c_str());
+        }
+    }
+
     RobotDriver driver(node, privateNode);
 
-    RobotNode robot_node(driver);
+    // 動特性の計測（計測結果のYAMLを出力して終了する）
+    bool characterize_dynamics;
+    getParam(privateNode, "characterize_dynamics", characterize_dynamics, false);
+    if(characterize_dynamics)
+    {
+        std::string dynamics_output;
+        getParam(privateNode, "dynamics_output", dynamics_output, std::string(""));
+        return(driver.characterizeDynamics(dynamics_output) ? 0 : -1);
+    }
+
+    // 座標変換バッファ（/tfの購読・保持はノード内でこの1つのみとし、RobotNodeと共有する）
+    tf2_ros::Buffer tf_buffer;
+    tf2_ros::TransformListener tf_listener(tf_buffer);
+
+    RobotNode robot_node(driver, tf_buffer);
     robot_node.setup(node, privateNode);
 
     // キャリブレーション 回転速度
@@ -2823,7 +5400,7 @@ int main(int argc, char *argv[])
     }
     
     // スリープ（地図、初期位置を受信後すぐにはキャリブレーション出来ないため）
-    robot_node.sleepFunc(ROS_TIME_10S);
+    robot_node.calibrationSettle();
     
     //1回転
     robot_node.turn360(turn_speed);
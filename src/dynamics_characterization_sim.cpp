@@ -0,0 +1,138 @@
+/**
+* @file     dynamics_characterization_sim.cpp
+* @brief    動特性の計測（characterize_dynamics）の運動学モデルによる動作確認ツールのソースファイル
+* @author   S.Kumada
+* @date     2026/10/18
+* @note     ROSに依存せず、むだ時間・一次遅れ・加速度制限・ゲインを持つ速度応答のモデルに
+*           RobotDriverと同じ台本の指令を与え、推定結果をモデルの値と比較する。作成したYAMLを標準出力に出す
+*
+*   使い方:
+*     dynamics_characterization_sim [--rate Hz] [--latency s] [--tau s] [--gain k] [--accel a] [--angular-accel a] [--noise sd]
+*   例:
+*     dynamics_characterization_sim --latency 0.12 --tau 0.15 --gain 0.95 --accel 0.6
+*/
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <random>
+#include <string>
+
+#include "dynamics_identifier.h"
+
+#define SIM_DEFAULT_RATE    50.0    // 既定のオドメトリの周期[Hz]
+
+// 1軸の速度応答モデル
+typedef struct AxisModelConfig
+{
+    double latency;     // むだ時間[s]
+    double tau;         // 時定数[s]
+    double gain;        // 定常ゲイン
+    double accel;       // 最大加速度[/s]
+    double limit;       // 最大速度
+
+}stAxisModelConfig;
+
+/**
+ * @brief 1軸の速度応答モデル（むだ時間→ゲイン→一次遅れ→加速度制限）
+ */
+class AxisModel
+{
+private:
+    stAxisModelConfig _config;  // モデルのパラメータ
+    std::deque<double> _delay;  // むだ時間分の指令
+    double _velocity;           // 速度
+
+public:
+    AxisModel(const stAxisModelConfig& config, double dt)
+        : _config(config)
+        , _delay((size_t)(config.latency / dt + 0.5), 0.0)
+        , _velocity(0.0) {}
+
+    double step(double command, double dt)
+    {
+        _delay.push_back(command);
+        double delayed = _delay.front();
+        _delay.pop_front();
+
+        // 一次遅れは周期内の厳密解で進め、周期内の変化量を加速度制限で抑える
+        double target = std::max(-_config.limit, std::min(_config.limit, delayed * _config.gain));
+        double change = (_config.tau > 0) ? (target - _velocity) * (1.0 - std::exp(-dt / _config.tau)) : (target - _velocity);
+        change = std::max(-_config.accel * dt, std::min(_config.accel * dt, change));
+        _velocity += change;
+        return _velocity;
+    }
+};
+
+static void printEstimate(const char* axis, const stDynamicsEstimate& estimate, const stAxisModelConfig& truth)
+{
+    printf("# %-8s latency %.3f (model %.3f)  tau %.3f (model %.3f)  gain %.3f (model %.3f)  accel %.3f (model %.3f)  lag %.3f  tracked %.2f\n",
+           axis, estimate.latency, truth.latency, estimate.time_constant, truth.tau, estimate.gain, truth.gain,
+           estimate.max_accel, truth.accel, estimate.tracking_lag, estimate.max_tracked);
+}
+
+int main(int argc, char *argv[])
+{
+    double rate = SIM_DEFAULT_RATE;
+    double noise = 0.0;
+    stAxisModelConfig linear  = { 0.10, 0.15, 1.0, 0.5, 0.25 };
+    stAxisModelConfig angular = { 0.10, 0.10, 1.0, 1.5, 0.7 };
+
+    for(int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        bool has_value = (i + 1 < argc);
+        if(arg == "--rate" && has_value)                rate = atof(argv[++i]);
+        else if(arg == "--latency" && has_value)        linear.latency = angular.latency = atof(argv[++i]);
+        else if(arg == "--tau" && has_value)            linear.tau = angular.tau = atof(argv[++i]);
+        else if(arg == "--gain" && has_value)           linear.gain = angular.gain = atof(argv[++i]);
+        else if(arg == "--accel" && has_value)          linear.accel = atof(argv[++i]);
+        else if(arg == "--angular-accel" && has_value)  angular.accel = atof(argv[++i]);
+        else if(arg == "--noise" && has_value)          noise = atof(argv[++i]);
+        else
+        {
+            fprintf(stderr, "usage: %s [--rate Hz] [--latency s] [--tau s] [--gain k] [--accel a] [--angular-accel a] [--noise sd]\n", argv[0]);
+            return(1);
+        }
+    }
+    if(rate <= 0)
+    {
+        fprintf(stderr, "rate must be positive\n");
+        return(1);
+    }
+
+    const double dt = 1.0 / rate;
+    AxisModel linear_model(linear, dt);
+    AxisModel angular_model(angular, dt);
+    std::mt19937 engine(1);
+    std::normal_distribution<double> distribution(0.0, noise > 0 ? noise : 1.0);
+
+    DynamicsIdentifier identifier;
+    identifier.configure(stDynamicsConfig());
+
+    double linear_vel = 0.0, angular_vel = 0.0;
+    double linear_cmd = 0.0, angular_cmd = 0.0;
+    for(double now = 0.0; ; now += dt)
+    {
+        double measured_linear  = linear_vel  + (noise > 0 ? distribution(engine) : 0.0);
+        double measured_angular = angular_vel + (noise > 0 ? distribution(engine) : 0.0);
+        if(!identifier.update(now, measured_linear, measured_angular, linear_cmd, angular_cmd))
+        {
+            break;
+        }
+        linear_vel  = linear_model.step(linear_cmd, dt);
+        angular_vel = angular_model.step(angular_cmd, dt);
+    }
+
+    stDynamicsEstimate linear_estimate  = identifier.estimate(DYNAMICS_AXIS_LINEAR);
+    stDynamicsEstimate angular_estimate = identifier.estimate(DYNAMICS_AXIS_ANGULAR);
+
+    printf("# samples %lu (dropped %lu), duration %.1f s\n",
+           (unsigned long)identifier.samples(), (unsigned long)identifier.dropped(), identifier.duration());
+    printEstimate("linear", linear_estimate, linear);
+    printEstimate("angular", angular_estimate, angular);
+    printf("%s", identifier.toYaml("simulation", linear_estimate, angular_estimate).c_str());
+
+    return(0);
+}
@@ -0,0 +1,127 @@
+/**
+* @file     map_repository_stub.cpp
+* @brief    地図リポジトリ（robot_bridge経由のレイヤ地図取得）の代替ノードのソースファイル
+* @author   S.Kumada
+* @date     2026/10/18
+* @note     delivery_robotのレイヤ地図の取得要求を受け、レイヤ毎に設定した応答時間の後に取得完了通知
+*           （/layer_map_update_notify）を返す。地図データ自体は配信しない。取得要求は並行して処理するため、
+*           getLayerMapの取得時間はレイヤ毎の応答時間の最大値に近くなる。
+*           drop_first_requestに指定したレイヤは初回の要求に応答せず、レイヤ毎の再要求を確認できる
+*
+*   使い方:
+*     rosrun delivery_robot map_repository_stub _entity_id:=megarover_01 _static_layer_delay:=2.0 _drop_first_request:=semi_static_layer
+*/
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <ros/ros.h>
+
+#include "utilities.h"
+#include "uoa_poc5_msgs/r_get_mapdata.h"
+#include "uoa_poc5_msgs/r_recv_map_info.h"
+
+#define DEF_ENTITY_ID       "turtlebot_01"  // 既定のロボットのユニークID
+#define DEF_LAYER_DELAY     1.0             // 既定のレイヤ毎の応答時間[s]
+#define DEF_MAP_REVISION    "stub"          // 取得完了通知のリビジョン番号（要求に指定が無い場合）
+
+/**
+ * @brief 地図リポジトリの代替クラス
+ */
+class MapRepositoryStub
+{
+private:
+    ros::Subscriber _sub_get_layer_map;         // リビジョン番号指定の取得要求のサブスクライバ
+    ros::Subscriber _sub_get_map;               // 取得要求のサブスクライバ
+    ros::Publisher _pub_notify;                 // 取得完了通知のパブリッシャ
+    std::vector<ros::Timer> _timers;            // 応答用のタイマー（破棄すると停止するため保持する）
+    std::map<std::string, double> _delay;       // レイヤ毎の応答時間[s]
+    std::map<std::string, int> _requests;       // レイヤ毎の要求の受信数
+    std::string _drop_first_request;            // 初回の要求に応答しないレイヤ
+    ros::WallTime _first_request;               // 最初の要求の受信時刻
+
+public:
+    /**
+    * @brief        初期設定処理
+    * @param[in]    ros::NodeHandle &node           ノードハンドル
+    * @param[in]    ros::NodeHandle &privateNode    パラメータ読み込み用ノードハンドル
+    * @return       void
+    */
+    void setup(ros::NodeHandle &node, ros::NodeHandle &privateNode)
+    {
+        std::string entity_id;
+        getParam(privateNode, "entity_id", entity_id, std::string(DEF_ENTITY_ID));
+        getParam(privateNode, "static_layer_delay",         _delay["static_layer"],         DEF_LAYER_DELAY);
+        getParam(privateNode, "semi_static_layer_delay",    _delay["semi_static_layer"],    DEF_LAYER_DELAY);
+        getParam(privateNode, "exclusion_zone_layer_delay", _delay["exclusion_zone_layer"], DEF_LAYER_DELAY);
+        getParam(privateNode, "drop_first_request",         _drop_first_request,            std::string(""));
+
+        _pub_notify = node.advertise<uoa_poc5_msgs::r_recv_map_info>("/layer_map_update_notify", ROS_QUEUE_SIZE_10, false);
+        _sub_get_layer_map = node.subscribe("/robot_bridge/" + entity_id + "/get_layer_map_data", ROS_QUEUE_SIZE_10, &MapRepositoryStub::requestRecv, this);
+        _sub_get_map       = node.subscribe("/robot_bridge/" + entity_id + "/get_map_data",       ROS_QUEUE_SIZE_10, &MapRepositoryStub::requestRecv, this);
+
+        ROS_INFO("map repository stub for %s (static %.2f s, semi static %.2f s, exclusion zone %.2f s)",
+                 entity_id.c_str(), _delay["static_layer"], _delay["semi_static_layer"], _delay["exclusion_zone_layer"]);
+    }
+
+private:
+    /**
+    * @brief        取得要求の受信処理
+    * @param[in]    const uoa_poc5_msgs::r_get_mapdata& msg 取得要求
+    * @return       void
+    */
+    void requestRecv(const uoa_poc5_msgs::r_get_mapdata& msg)
+    {
+        if(_first_request.isZero())
+        {
+            _first_request = ros::WallTime::now();
+        }
+        int count = ++_requests[msg.map_layer];
+        ROS_INFO("request %s #%d (revision \"%s\", space \"%s\") at %.2f s",
+                 msg.map_layer.c_str(), count, msg.revision.c_str(), msg.space.c_str(), (ros::WallTime::now() - _first_request).toSec());
+
+        if(count == 1 && msg.map_layer == _drop_first_request)
+        {
+            ROS_WARN("dropping first request of %s", msg.map_layer.c_str());
+            return;
+        }
+
+        std::map<std::string, double>::const_iterator it = _delay.find(msg.map_layer);
+        double delay = (it != _delay.end()) ? it->second : DEF_LAYER_DELAY;
+
+        uoa_poc5_msgs::r_recv_map_info notify;
+        notify.map_layer = msg.map_layer;
+        notify.revision  = msg.revision.empty() ? std::string(DEF_MAP_REVISION) : msg.revision;
+
+        // 要求毎にワンショットのタイマーで応答する（他のレイヤの応答を待たない）
+        _timers.push_back(ros::NodeHandle().createTimer(ros::Duration(delay),
+            [this, notify](const ros::TimerEvent&)
+            {
+                _pub_notify.publish(notify);
+                ROS_INFO("notify %s at %.2f s", notify.map_layer.c_str(), (ros::WallTime::now() - _first_request).toSec());
+            },
+            true));
+    }
+};
+
+/******************************************************************************/
+/* main                                                                       */
+/******************************************************************************/
+/**
+ * @brief   地図リポジトリの代替ノードメイン関数
+ */
+int main(int argc, char *argv[])
+{
+    ros::init(argc, argv, "map_repository_stub");
+
+    ros::NodeHandle node;
+    ros::NodeHandle privateNode("~");
+
+    MapRepositoryStub stub;
+    stub.setup(node, privateNode);
+
+    ros::spin();
+
+    return(0);
+}
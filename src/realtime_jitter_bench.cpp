@@ -0,0 +1,145 @@
+/**
+* @file     realtime_jitter_bench.cpp
+* @brief    制御周期の遅れ（ジッタ）計測ツールのソースファイル
+* @author   S.Kumada
+* @date     2026/10/18
+* @note     ROSに依存せず、開発機上で通常実行とリアルタイム実行（SCHED_FIFO・CPU固定・メモリロック）の
+*           周期処理の起床遅れを比較する。負荷スレッドでコストマップ受信相当のメモリ確保・書き込みを模擬する
+*
+*   使い方:
+*     realtime_jitter_bench [--rate Hz] [--duration s] [--load threads] [--rt] [--priority 1-99] [--cpu n] [--prefault MB]
+*   例:
+*     realtime_jitter_bench --rate 50 --duration 20 --load 4
+*     sudo realtime_jitter_bench --rate 50 --duration 20 --load 4 --rt --cpu 2
+*/
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "realtime_thread.h"
+
+#define BENCH_DEFAULT_RATE      50.0    // 既定の周期[Hz]
+#define BENCH_DEFAULT_DURATION  10.0    // 既定の計測時間[s]
+#define BENCH_LOAD_BLOCK        (4 * 1024 * 1024)   // 負荷スレッドが1回に確保する領域[byte]
+
+static std::atomic<bool> g_running(true);
+
+/**
+* @brief        負荷スレッド（大きな領域の確保・書き込み・解放を繰り返す）
+* @return       void
+*/
+static void loadLoop()
+{
+    while(g_running)
+    {
+        std::vector<unsigned char> block(BENCH_LOAD_BLOCK);
+        for(size_t i = 0; i < block.size(); i += 64)
+        {
+            block[i] = (unsigned char)i;
+        }
+    }
+}
+
+/**
+* @brief        周期処理の計測
+* @param[in]    const stRealtimeConfig& config リアルタイム実行設定
+* @param[in]    double rate 周期[Hz]
+* @param[in]    double duration 計測時間[s]
+* @param[out]   JitterHistogram& histogram 起床遅れの集計
+* @return       void
+*/
+static void controlLoop(const stRealtimeConfig& config, double rate, double duration, JitterHistogram& histogram)
+{
+    std::string error;
+    if(!applyRealtimeThread(config, error))
+    {
+        fprintf(stderr, "realtime setting failed: %s (continue with normal priority)\n", error.c_str());
+    }
+
+    const std::chrono::steady_clock::duration period =
+        std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1.0 / rate));
+    std::chrono::steady_clock::time_point next = std::chrono::steady_clock::now();
+    std::chrono::steady_clock::time_point end = next + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                                    std::chrono::duration<double>(duration));
+
+    while(next < end)
+    {
+        next += period;
+        std::this_thread::sleep_until(next);
+        histogram.add(std::chrono::duration<double>(std::chrono::steady_clock::now() - next).count());
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    stRealtimeConfig config;
+    double rate = BENCH_DEFAULT_RATE;
+    double duration = BENCH_DEFAULT_DURATION;
+    int load = 0;
+    int prefault_mb = 64;
+
+    for(int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        bool has_value = (i + 1 < argc);
+        if(arg == "--rt")                          config.enable = true;
+        else if(arg == "--rate" && has_value)      rate = atof(argv[++i]);
+        else if(arg == "--duration" && has_value)  duration = atof(argv[++i]);
+        else if(arg == "--load" && has_value)      load = atoi(argv[++i]);
+        else if(arg == "--priority" && has_value)  config.priority = atoi(argv[++i]);
+        else if(arg == "--cpu" && has_value)       config.cpu = atoi(argv[++i]);
+        else if(arg == "--prefault" && has_value)  prefault_mb = atoi(argv[++i]);
+        else
+        {
+            fprintf(stderr, "usage: %s [--rate Hz] [--duration s] [--load threads] [--rt] [--priority 1-99] [--cpu n] [--prefault MB]\n", argv[0]);
+            return(1);
+        }
+    }
+    if(rate <= 0 || duration <= 0)
+    {
+        fprintf(stderr, "rate and duration must be positive\n");
+        return(1);
+    }
+
+    if(config.enable)
+    {
+        std::string error;
+        if(!lockProcessMemory((size_t)prefault_mb * 1024 * 1024, error))
+        {
+            fprintf(stderr, "memory lock failed: %s\n", error.c_str());
+        }
+    }
+
+    std::vector<std::thread> loads;
+    for(int i = 0; i < load; i++)
+    {
+        loads.push_back(std::thread(loadLoop));
+    }
+
+    JitterHistogram histogram;
+    std::thread control(controlLoop, config, rate, duration, std::ref(histogram));
+    control.join();
+
+    g_running = false;
+    for(size_t i = 0; i < loads.size(); i++)
+    {
+        loads[i].join();
+    }
+
+    printf("mode      : %s (priority %d, cpu %d)\n", config.enable ? "realtime" : "normal", config.priority, config.cpu);
+    printf("rate      : %.1f Hz, duration %.1f s, load threads %d\n", rate, duration, load);
+    printf("cycles    : %llu\n", (unsigned long long)histogram.count());
+    printf("late mean : %8.1f us\n", histogram.mean() * 1e6);
+    printf("late p50  : %8.1f us\n", histogram.percentile(0.50) * 1e6);
+    printf("late p99  : %8.1f us\n", histogram.percentile(0.99) * 1e6);
+    printf("late p999 : %8.1f us\n", histogram.percentile(0.999) * 1e6);
+    printf("late max  : %8.1f us\n", histogram.max() * 1e6);
+
+    return(0);
+}